@@ -0,0 +1,101 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericArea class that computes the area and
+ * gradient of a stadium.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AREA_HH
+# define ROBOPTIM_CAPSULE_AREA_HH
+
+# include <roboptim/core/twice-differentiable-function.hh>
+
+# include "roboptim/capsule/config.hh"
+# include "roboptim/capsule/types.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Stadium area function.
+    ///
+    /// This class computes the area \f$2 r L + \pi r^2\f$ of a stadium
+    /// (planar capsule) defined by a segment of length \f$L\f$ and a
+    /// radius \f$r\f$, as well as its gradient and Hessian. It is the
+    /// planar counterpart of GenericVolume, over 5 parameters.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericArea
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericTwiceDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      GenericArea (std::string name = "stadium area");
+
+      ~GenericArea ();
+
+    protected:
+      /// \brief Compute the area of the stadium.
+      ///
+      /// \param argument vector containing the stadium parameters. It
+      /// contains in this order: the segment first end point
+      /// coordinates, the segment second end point coordinates, the
+      /// stadium radius.
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      /// \brief Compute gradient of the stadium area with respect to
+      /// the argument vector.
+      ///
+      /// The gradient with respect to the end points is not defined
+      /// for zero-length segments, and the null subgradient is used.
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      /// \brief Compute Hessian of the stadium area with respect to
+      /// the argument vector.
+      ///
+      /// With \f$d = e_1 - e_2\f$, \f$L = \|d\|\f$ and
+      /// \f$u = d / L\f$, the non-zero blocks are
+      /// \f$\pm \frac{2 r}{L} (I - u u^T)\f$ for the end points,
+      /// \f$\pm 2 u\f$ for the end points and the radius, and
+      /// \f$2 \pi\f$ for the radius.
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+    };
+
+    /// \brief Stadium area function using dense matrices.
+    typedef GenericArea<EigenMatrixDense> Area;
+
+    /// \brief Stadium area function using sparse matrices.
+    typedef GenericArea<EigenMatrixSparse> SparseArea;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AREA_HH
@@ -0,0 +1,242 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of Arena class that provides temporary memory
+ * released in bulk.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_ARENA_HH
+# define ROBOPTIM_CAPSULE_ARENA_HH
+
+# include <cstddef>
+# include <limits>
+# include <new>
+# include <vector>
+
+# include <boost/noncopyable.hpp>
+# include <boost/type_traits/alignment_of.hpp>
+
+# include <roboptim/capsule/config.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Memory arena for temporary data.
+    ///
+    /// Memory is taken from large blocks by bumping an offset, and is
+    /// only given back in bulk by rewinding to a previous position (see
+    /// ArenaScope). Blocks are kept when rewinding, so that repeated
+    /// fits with similar sizes do not use the global allocator once the
+    /// arena has grown.
+    ///
+    /// An arena is not thread-safe: each thread uses its own (see
+    /// threadArena).
+    class ROBOPTIM_CAPSULE_DLLAPI Arena : private boost::noncopyable
+    {
+    public:
+      /// \brief Position in the arena.
+      struct Marker
+      {
+	/// \brief Index of the current block.
+	size_t block;
+
+	/// \brief Offset in the current block.
+	size_t offset;
+      };
+
+      /// \brief Constructor.
+      ///
+      /// \param blockSize default size of the blocks, in bytes.
+      explicit Arena (size_t blockSize = 64 * 1024);
+
+      ~Arena ();
+
+      /// \brief Allocate memory.
+      ///
+      /// \param size size in bytes.
+      /// \param alignment alignment in bytes (power of 2).
+      void* allocate (size_t size, size_t alignment);
+
+      /// \brief Get the current position.
+      Marker mark () const;
+
+      /// \brief Give back the memory allocated since a position.
+      void rewind (const Marker& marker);
+
+      /// \brief Give back all the memory, blocks are kept.
+      void reset ();
+
+      /// \brief Free all the blocks.
+      void release ();
+
+      /// \brief Total size of the blocks, in bytes.
+      size_t capacity () const;
+
+    private:
+      /// \brief Memory block.
+      struct Block
+      {
+	char* data;
+	size_t size;
+      };
+
+      /// \brief Default size of the blocks.
+      size_t blockSize_;
+
+      /// \brief Allocated blocks.
+      std::vector<Block> blocks_;
+
+      /// \brief Current position.
+      Marker current_;
+    };
+
+    /// \brief Get the arena of the calling thread.
+    ///
+    /// It is created on first use and destroyed when the thread exits.
+    ROBOPTIM_CAPSULE_DLLAPI Arena& threadArena ();
+
+    /// \brief Give back the memory of an arena allocated during the
+    /// lifetime of the scope.
+    ///
+    /// Scopes must be nested, and containers using the arena must be
+    /// destroyed before their scope, i.e. declared after it.
+    class ROBOPTIM_CAPSULE_DLLAPI ArenaScope : private boost::noncopyable
+    {
+    public:
+      /// \brief Constructor.
+      ///
+      /// \param arena arena, the thread arena by default.
+      explicit ArenaScope (Arena& arena = threadArena ())
+	: arena_ (arena),
+	  marker_ (arena.mark ())
+      {
+      }
+
+      ~ArenaScope ()
+      {
+	arena_.rewind (marker_);
+      }
+
+      /// \brief Get the arena.
+      Arena& arena () const
+      {
+	return arena_;
+      }
+
+    private:
+      Arena& arena_;
+      Arena::Marker marker_;
+    };
+
+    /// \brief Standard allocator drawing from an arena.
+    ///
+    /// Deallocation does nothing: memory is given back when the
+    /// enclosing ArenaScope ends.
+    ///
+    /// \tparam T value type.
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+      typedef T value_type;
+      typedef T* pointer;
+      typedef const T* const_pointer;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef std::size_t size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      template <typename U>
+      struct rebind
+      {
+	typedef ArenaAllocator<U> other;
+      };
+
+      explicit ArenaAllocator (Arena& arena = threadArena ())
+	: arena_ (&arena)
+      {
+      }
+
+      template <typename U>
+      ArenaAllocator (const ArenaAllocator<U>& other)
+	: arena_ (&other.arena ())
+      {
+      }
+
+      Arena& arena () const
+      {
+	return *arena_;
+      }
+
+      pointer address (reference x) const
+      {
+	return &x;
+      }
+
+      const_pointer address (const_reference x) const
+      {
+	return &x;
+      }
+
+      pointer allocate (size_type n, const void* = 0)
+      {
+	return static_cast<pointer>
+	  (arena_->allocate (n * sizeof (T), boost::alignment_of<T>::value));
+      }
+
+      void deallocate (pointer, size_type)
+      {
+      }
+
+      size_type max_size () const
+      {
+	return std::numeric_limits<size_type>::max () / sizeof (T);
+      }
+
+      void construct (pointer p, const T& value)
+      {
+	new (p) T (value);
+      }
+
+      void destroy (pointer p)
+      {
+	p->~T ();
+      }
+
+      template <typename U>
+      bool operator== (const ArenaAllocator<U>& other) const
+      {
+	return arena_ == &other.arena ();
+      }
+
+      template <typename U>
+      bool operator!= (const ArenaAllocator<U>& other) const
+      {
+	return arena_ != &other.arena ();
+      }
+
+    private:
+      Arena* arena_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_ARENA_HH
@@ -0,0 +1,97 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of AxisParameterization class that maps the
+ * axis parameterization of a capsule to its end points.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_HH
+# define ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_HH
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Axis parameterization of a capsule.
+    ///
+    /// The parameters vector contains in this order: the center
+    /// \f$c\f$ of the segment, two angles \f$(\alpha, \beta)\f$ giving
+    /// the unit direction of the segment, the segment half-length
+    /// \f$h\f$ and the radius \f$r\f$. The direction is:
+    ///
+    /// \f$u = F (\cos\alpha \cos\beta, \sin\alpha \cos\beta,
+    /// \sin\beta)^T\f$
+    ///
+    /// where \f$F\f$ is a rotation whose first column is a reference
+    /// direction. The chart is singular at \f$\beta = \pm \pi/2\f$,
+    /// i.e. 90 degrees away from the reference direction, which should
+    /// thus be close to the expected capsule axis.
+    ///
+    /// The end points are \f$e_1 = c - h u\f$ and \f$e_2 = c + h u\f$.
+    /// Compared to end points, position and orientation are decoupled
+    /// and the two end points cannot be swapped (\f$h \geq 0\f$).
+    class ROBOPTIM_CAPSULE_DLLAPI AxisParameterization
+    {
+    public:
+      /// \brief Jacobian of the end point parameters with respect to
+      /// the axis parameters.
+      typedef Eigen::Matrix<value_type, 7, 7> jacobian_t;
+
+      /// \brief Constructor.
+      ///
+      /// \param referenceDirection direction obtained for null angles.
+      /// If it is null, the x axis is used.
+      explicit AxisParameterization (const vector3_t& referenceDirection);
+
+      /// \brief Get reference frame.
+      const Eigen::Matrix3d& frame () const;
+
+      /// \brief Compute the unit direction of the segment.
+      vector3_t direction (value_type alpha, value_type beta) const;
+
+      /// \brief Convert axis parameters to end point parameters.
+      ///
+      /// \param dst end point parameters (see
+      /// convertCapsuleToSolverParam).
+      /// \param src axis parameters.
+      void toEndPoints (argument_ref dst, const_argument_ref src) const;
+
+      /// \brief Convert end point parameters to axis parameters.
+      ///
+      /// \param dst axis parameters.
+      /// \param src end point parameters (see
+      /// convertCapsuleToSolverParam).
+      void fromEndPoints (argument_ref dst, const_argument_ref src) const;
+
+      /// \brief Compute the Jacobian of the end point parameters with
+      /// respect to the axis parameters.
+      void jacobian (jacobian_t& jacobian, const_argument_ref src) const;
+
+    private:
+      /// \brief Reference frame.
+      Eigen::Matrix3d frame_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_HH
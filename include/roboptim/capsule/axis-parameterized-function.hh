@@ -0,0 +1,112 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericAxisParameterizedFunction class that
+ * evaluates a capsule function with axis parameters.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_HH
+# define ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_HH
+
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/core/differentiable-function.hh>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/axis-parameterization.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Capsule function expressed with axis parameters.
+    ///
+    /// Wraps a function whose first 7 arguments are the end point
+    /// parameters of a capsule (e.g. GenericDistanceCapsulePoints),
+    /// so that its first 7 arguments become the axis parameters of
+    /// AxisParameterization. Other arguments (e.g. the projection
+    /// parameters of GenericSquaredDistanceCapsulePoints) are passed
+    /// through. Gradients are computed with the chain rule.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericAxisParameterizedFunction
+      : public roboptim::GenericDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      typedef GenericDifferentiableFunction<T> function_t;
+
+      /// \brief Constructor.
+      ///
+      /// \param function function of the end point parameters.
+      /// \param parameterization axis parameterization.
+      GenericAxisParameterizedFunction
+      (boost::shared_ptr<const function_t> function,
+       const AxisParameterization& parameterization);
+
+      ~GenericAxisParameterizedFunction ();
+
+      /// \brief Get wrapped function.
+      const function_t& function () const;
+
+      /// \brief Get parameterization.
+      const AxisParameterization& parameterization () const;
+
+    protected:
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      virtual void
+      impl_jacobian (jacobian_ref jacobian,
+		     const_argument_ref argument) const;
+
+    private:
+      /// \brief Convert the argument to end point parameters.
+      void endPointArgument (argument_ref dst,
+			     const_argument_ref argument) const;
+
+      /// \brief Wrapped function.
+      boost::shared_ptr<const function_t> function_;
+
+      /// \brief Axis parameterization.
+      AxisParameterization parameterization_;
+    };
+
+    /// \brief Axis-parameterized function using dense matrices.
+    typedef GenericAxisParameterizedFunction<EigenMatrixDense>
+    AxisParameterizedFunction;
+
+    /// \brief Axis-parameterized function using sparse matrices.
+    typedef GenericAxisParameterizedFunction<EigenMatrixSparse>
+    SparseAxisParameterizedFunction;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_HH
@@ -0,0 +1,85 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericAxisVolume class that computes the
+ * volume of a capsule given by its axis parameters.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_VOLUME_HH
+# define ROBOPTIM_CAPSULE_AXIS_VOLUME_HH
+
+# include <roboptim/core/twice-differentiable-function.hh>
+
+# include "roboptim/capsule/config.hh"
+# include "roboptim/capsule/types.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Capsule volume function for the axis parameterization.
+    ///
+    /// The argument contains the axis parameters (see
+    /// AxisParameterization), possibly followed by auxiliary
+    /// variables. The volume is \f$2 h \pi r^2 + \frac{4}{3}\pi r^3\f$,
+    /// which is polynomial, even for zero-length segments.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericAxisVolume
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericTwiceDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      ///
+      /// \param inputSize size of the optimization vector (at least 7).
+      GenericAxisVolume (size_type inputSize = 7,
+			 std::string name = "capsule volume (axis)");
+
+      ~GenericAxisVolume ();
+
+    protected:
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+    };
+
+    /// \brief Axis volume function using dense matrices.
+    typedef GenericAxisVolume<EigenMatrixDense> AxisVolume;
+
+    /// \brief Axis volume function using sparse matrices.
+    typedef GenericAxisVolume<EigenMatrixSparse> SparseAxisVolume;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_VOLUME_HH
@@ -24,10 +24,16 @@
 #ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINT_HH
 # define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINT_HH
 
+# include <iosfwd>
+# include <string>
+
+# include <boost/optional.hpp>
+
 # include <roboptim/core/differentiable-function.hh>
 
 # include <roboptim/capsule/config.hh>
 # include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/util.hh>
 
 namespace roboptim
 {
@@ -46,11 +52,29 @@ namespace roboptim
 			    std::string name
 			    = "distance to point");
 
+      /// \brief Constructor for a point of a polyhedron vector.
+      ///
+      /// The function name is left empty, and the name of the point
+      /// (see constraintName) is only built when the function is
+      /// printed: constraints of large problems do not allocate names.
+      ///
+      /// \param point point that will be used in computing distance
+      /// between the capsule and the point.
+      /// \param id identity of the point.
+      DistanceCapsulePoint (const point_t& point, const PointId& id);
+
       ~DistanceCapsulePoint ();
 
       /// \brief Get point attribute.
       virtual const point_t& point () const;
 
+      /// \brief Get the name of the function, built from the point
+      /// identity if there is one.
+      std::string name () const;
+
+      /// \brief Print the function, with its name.
+      virtual std::ostream& print (std::ostream& o) const;
+
     protected:
       /// \brief Computes the distance from capsule to a point.
       ///
@@ -80,6 +104,9 @@ namespace roboptim
     private:
       /// \brief Point attribute.
       point_t point_;
+
+      /// \brief Identity of the point, if the name is built on demand.
+      boost::optional<PointId> id_;
     };
 
   } // end of namespace capsule.
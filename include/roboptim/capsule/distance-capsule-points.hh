@@ -0,0 +1,110 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericDistanceCapsulePoints class that
+ * computes the distances between a capsule and a set of points.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
+# define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
+
+# include <roboptim/core/differentiable-function.hh>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Stacked distance to points RobOptim function.
+    ///
+    /// Output i is the distance between the capsule and the i-th
+    /// point, minus the capsule radius. All the points of the
+    /// polyhedron vector are stacked in a single constraint, so that
+    /// the solver only deals with one function whatever the number
+    /// of points.
+    ///
+    /// The Jacobian structure is constant: each row always holds 7
+    /// entries, even when some of them are zero (e.g. when the point
+    /// projects on an end point of the segment). This lets sparse
+    /// solvers compute the symbolic structure once.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericDistanceCapsulePoints
+      : public roboptim::GenericDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      ///
+      /// \param polyhedrons polyhedron vector containing the points
+      /// that will be used in computing distances.
+      GenericDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+				    std::string name
+				    = "distance to points");
+
+      ~GenericDistanceCapsulePoints ();
+
+      /// \brief Get points attribute.
+      const polyhedron_t& points () const;
+
+    protected:
+      /// \brief Computes the distances from capsule to the points.
+      ///
+      /// \param argument vector containing the capsule parameters. It
+      /// contains in this order: the segment first end point
+      /// coordinates, the segment second end point coordinates, the
+      /// capsule radius.
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      /// \brief Compute the gradient of one distance with respect to
+      /// the capsule parameters.
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      /// \brief Compute the Jacobian of all distances at once.
+      virtual void
+      impl_jacobian (jacobian_ref jacobian,
+		     const_argument_ref argument) const;
+
+    private:
+      /// \brief Union of all the points of the polyhedrons.
+      polyhedron_t points_;
+    };
+
+    /// \brief Stacked distance function using dense matrices.
+    typedef GenericDistanceCapsulePoints<EigenMatrixDense>
+    DistanceCapsulePoints;
+
+    /// \brief Stacked distance function using sparse matrices.
+    typedef GenericDistanceCapsulePoints<EigenMatrixSparse>
+    SparseDistanceCapsulePoints;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_HH
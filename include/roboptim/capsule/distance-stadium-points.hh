@@ -0,0 +1,100 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericDistanceStadiumPoints class that
+ * computes the distances between a stadium and a set of planar points.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_HH
+# define ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_HH
+
+# include <roboptim/core/differentiable-function.hh>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Stacked distance to planar points RobOptim function.
+    ///
+    /// Planar counterpart of GenericDistanceCapsulePoints: output i is
+    /// the distance between the stadium segment and the i-th point,
+    /// minus the stadium radius. The argument holds the 5 stadium
+    /// parameters (see convertStadiumToSolverParam), and each row of
+    /// the Jacobian always holds 5 entries.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericDistanceStadiumPoints
+      : public roboptim::GenericDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      ///
+      /// \param polygons polygon vector containing the points that will
+      /// be used in computing distances.
+      GenericDistanceStadiumPoints (const polygons_t& polygons,
+				    std::string name
+				    = "distance to planar points");
+
+      ~GenericDistanceStadiumPoints ();
+
+      /// \brief Get points attribute.
+      const polygon_t& points () const;
+
+    protected:
+      /// \brief Computes the distances from stadium to the points.
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      /// \brief Compute the gradient of one distance with respect to
+      /// the stadium parameters.
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      /// \brief Compute the Jacobian of all distances at once.
+      virtual void
+      impl_jacobian (jacobian_ref jacobian,
+		     const_argument_ref argument) const;
+
+    private:
+      /// \brief Union of all the points of the polygons.
+      polygon_t points_;
+    };
+
+    /// \brief Stacked planar distance function using dense matrices.
+    typedef GenericDistanceStadiumPoints<EigenMatrixDense>
+    DistanceStadiumPoints;
+
+    /// \brief Stacked planar distance function using sparse matrices.
+    typedef GenericDistanceStadiumPoints<EigenMatrixSparse>
+    SparseDistanceStadiumPoints;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_HH
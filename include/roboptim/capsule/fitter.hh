@@ -24,7 +24,12 @@
 #ifndef ROBOPTIM_CAPSULE_FITTER_HH
 # define ROBOPTIM_CAPSULE_FITTER_HH
 
+# include <iostream>
+# include <vector>
+
 # include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/mutex.hpp>
 
 # include <roboptim/core/solver-factory.hh>
 
@@ -32,6 +37,9 @@
 # include <roboptim/capsule/types.hh>
 # include <roboptim/capsule/volume.hh>
 # include <roboptim/capsule/distance-capsule-point.hh>
+# include <roboptim/capsule/distance-capsule-points.hh>
+# include <roboptim/capsule/squared-distance-capsule-points.hh>
+# include <roboptim/capsule/util.hh>
 
 namespace roboptim
 {
@@ -44,6 +52,101 @@ namespace roboptim
     class ROBOPTIM_CAPSULE_DLLAPI Fitter
     {
     public:
+      /// \brief Formulation of the point-in-capsule constraints.
+      enum ConstraintType
+	{
+	  /// \brief Distance between the point and the segment, minus
+	  /// the radius (default). Not differentiable everywhere.
+	  DISTANCE,
+	  /// \brief Squared distance between the point and a point of
+	  /// the segment given by an auxiliary variable, minus the
+	  /// squared radius. Smooth, but adds one variable per point.
+	  SQUARED_DISTANCE
+	};
+
+      /// \brief Parameterization of the capsule in the optimization
+      /// problem.
+      enum Parameterization
+	{
+	  /// \brief End points and radius (default).
+	  ENDPOINTS,
+	  /// \brief Center, direction angles, half-length and radius
+	  /// (see AxisParameterization).
+	  AXIS
+	};
+
+      /// \brief Outcome of the last optimization.
+      enum SolverStatus
+	{
+	  /// \brief No optimization was run.
+	  NOT_SOLVED,
+	  /// \brief A solution was found.
+	  SOLUTION_FOUND,
+	  /// \brief A solution was found, with warnings (e.g. only an
+	  /// acceptable point was reached).
+	  SOLUTION_WITH_WARNINGS,
+	  /// \brief No solution was found, the solution is the initial
+	  /// guess.
+	  NO_SOLUTION,
+	  /// \brief The solver failed, the solution is the initial
+	  /// guess.
+	  SOLVER_FAILED,
+	  /// \brief The solver failed, the solution was computed by the
+	  /// HEURISTIC fallback.
+	  HEURISTIC_SOLUTION
+	};
+
+      /// \brief Steps of a capsule fitting.
+      enum FitStep
+	{
+	  /// \brief Optimization from the initial parameters.
+	  INITIAL_SOLVE,
+	  /// \brief Optimization from perturbed initial parameters: the
+	  /// radius is increased so that the start is strictly feasible,
+	  /// and the end points are moved.
+	  PERTURBED_START,
+	  /// \brief Optimization with the other parameterization
+	  /// (ENDPOINTS or AXIS).
+	  OTHER_PARAMETERIZATION,
+	  /// \brief Optimization with the fallback solver, skipped if it
+	  /// is empty.
+	  OTHER_SOLVER,
+	  /// \brief No optimization: shortest capsule containing the
+	  /// points along the initial axis (see fitCapsuleAlongAxis), or
+	  /// the initial capsule if it is smaller.
+	  HEURISTIC
+	};
+
+      /// \brief Attempt of a capsule fitting.
+      struct Attempt
+      {
+	/// \brief Fitting step.
+	FitStep step;
+
+	/// \brief Outcome of the step.
+	SolverStatus status;
+      };
+
+      /// \brief Sequence of attempts.
+      typedef std::vector<Attempt> attempts_t;
+
+      /// \brief Point on the surface of the solution capsule.
+      struct SupportPoint
+      {
+	/// \brief Identity of the point in the fitted polyhedrons.
+	PointId id;
+
+	/// \brief Lagrange multiplier of its constraint (0 if the
+	/// solver did not provide multipliers).
+	value_type multiplier;
+
+	/// \brief Distance from the point to the capsule segment.
+	value_type distance;
+      };
+
+      /// \brief Support points, by increasing point index.
+      typedef std::vector<SupportPoint> supportPoints_t;
+
       /// \brief Constructor.
       Fitter (const polyhedrons_t& polyhedrons,
               std::string solver = "ipopt");
@@ -72,6 +175,147 @@ namespace roboptim
       boost::optional<std::string>& logDirectory ();
       const boost::optional<std::string>& logDirectory () const;
 
+      /// \brief Get the file where the solver writes its log.
+      ///
+      /// Default is "fitter-ipopt.log". If empty, no file is written,
+      /// e.g. when several fitters run in parallel.
+      std::string& solverLogFile ();
+      const std::string& solverLogFile () const;
+
+      /// \brief Whether the solver prints its progress.
+      ///
+      /// If false, nothing is printed on the standard output (errors
+      /// are still printed on the standard error), e.g. when it is used
+      /// for machine-readable results. Default is true.
+      bool& verbose ();
+      bool verbose () const;
+
+      /// \brief Get the outcome of the last optimization.
+      SolverStatus solverStatus () const;
+
+      /// \brief Steps tried, in order, when the optimization fails
+      /// (NO_SOLUTION or SOLVER_FAILED).
+      ///
+      /// The chain stops at the first step that finds a solution.
+      /// Default is PERTURBED_START, OTHER_PARAMETERIZATION,
+      /// OTHER_SOLVER and HEURISTIC. If empty, the solution is the
+      /// initial guess when the optimization fails.
+      std::vector<FitStep>& fallbacks ();
+      const std::vector<FitStep>& fallbacks () const;
+
+      /// \brief Solver of the OTHER_SOLVER fallback. Default is empty,
+      /// i.e. the fallback is skipped.
+      std::string& fallbackSolver ();
+      const std::string& fallbackSolver () const;
+
+      /// \brief Get the steps of the last fitting, starting with
+      /// INITIAL_SOLVE. The last one gave the solution, unless all of
+      /// them failed. Skipped steps are recorded as NOT_SOLVED.
+      const attempts_t& attempts () const;
+
+      /// \brief Maximum number of solver iterations of each
+      /// optimization. Default is 0, i.e. the solver default.
+      size_t& maxIterations ();
+      size_t maxIterations () const;
+
+      /// \brief Maximum CPU time of each optimization, in seconds.
+      ///
+      /// Together with maxIterations, it bounds the latency of a
+      /// fitting (fallback steps run their own optimizations). Default
+      /// is 0, i.e. no limit.
+      value_type& maxCpuTime ();
+      value_type maxCpuTime () const;
+
+      /// \brief Get the Lagrange multipliers of the point-in-capsule
+      /// constraints of the last optimization.
+      ///
+      /// Element i is the multiplier of point i of the fitted
+      /// polyhedrons (see pointIdFromIndex), for the constraint of the
+      /// chosen formulation (distance or squared distance). Empty if no
+      /// optimization gave the solution (e.g. HEURISTIC) or if the
+      /// solver does not provide multipliers.
+      const vector_t& multipliers () const;
+
+      /// \brief Relative tolerance of the support points: a point
+      /// supports the solution if its distance to the segment is larger
+      /// than (1 - activeTolerance) times the radius. Default is 1e-4.
+      value_type& activeTolerance ();
+      value_type activeTolerance () const;
+
+      /// \brief Get the points supporting the solution capsule.
+      ///
+      /// They are the active constraints: the capsule fitted over
+      /// these points only is the same. Use matchPoints to map them
+      /// back to the points given to computeConvexPolyhedron.
+      const supportPoints_t& supportPoints () const;
+
+      /// \brief Whether the solution is verified to contain the points.
+      ///
+      /// The solver tolerances (constraint violation, bound relaxation)
+      /// allow points slightly outside the solution capsule. If true,
+      /// the distances of all the points are evaluated after the
+      /// optimization, and the radius is increased by the largest
+      /// violation (see inflateToContain), so that the solution is
+      /// guaranteed to contain the polyhedrons. Default is true.
+      bool& verifyContainment ();
+      bool verifyContainment () const;
+
+      /// \brief Get the radius increase of the last containment
+      /// verification (0 if the solution contained all the points).
+      value_type radiusInflation () const;
+
+      /// \brief Whether the problem is built with sparse matrices.
+      ///
+      /// If true, the distance constraints are stacked in a single
+      /// SparseDistanceCapsulePoints function, and a sparse solver is
+      /// used ("ipopt" is then replaced by "ipopt-sparse"). This scales
+      /// better with the number of points. Sparse matrices are always
+      /// used with SQUARED_DISTANCE constraints. Default is false.
+      bool& useSparseMatrices ();
+      bool useSparseMatrices () const;
+
+      /// \brief Formulation of the point-in-capsule constraints.
+      ///
+      /// SQUARED_DISTANCE gives a problem with continuous second
+      /// derivatives. It adds one variable per point, and each
+      /// constraint only depends on 8 variables: the problem is then
+      /// always built with sparse matrices, whatever
+      /// useSparseMatrices says.
+      ConstraintType& constraintType ();
+      ConstraintType constraintType () const;
+
+      /// \brief Whether the solver uses exact Hessians.
+      ///
+      /// Closed-form Hessians are only available for the
+      /// SQUARED_DISTANCE formulation; otherwise a quasi-Newton
+      /// approximation is used. Default is false.
+      bool& useExactHessian ();
+      bool useExactHessian () const;
+
+      /// \brief Smoothing parameter of the segment length in the
+      /// optimized volume.
+      ///
+      /// The volume gradient is not defined for zero-length segments,
+      /// which are common for compact parts. With a positive value, the
+      /// smooth length of GenericVolume is used instead, e.g. 1e-3
+      /// times the part size. Reported volumes are always exact.
+      /// Default is 0 (exact volume).
+      value_type& lengthSmoothing ();
+      value_type lengthSmoothing () const;
+
+      /// \brief Parameterization of the capsule in the optimization
+      /// problem.
+      ///
+      /// With AXIS, position, orientation, length and radius are
+      /// decoupled, the end points cannot be swapped and the volume is
+      /// polynomial even for zero-length segments. The reference
+      /// direction of the angles is the axis of the initial capsule.
+      /// Initial and solution parameters are always given as end
+      /// points. Exact Hessians are not available with AXIS.
+      /// Default is ENDPOINTS.
+      Parameterization& parameterization ();
+      Parameterization parameterization () const;
+
       /// \brief Compute best fitting capsule over polyhedron.
       ///
       /// Polyhedron vector attribute is used to compute capsule and set
@@ -119,6 +363,33 @@ namespace roboptim
 					    const_argument_ref initParam,
 					    argument_ref solutionParam);
 
+      /// \brief Run one optimization with the current options.
+      ///
+      /// The solver and the parameterization are given explicitly, so
+      /// that fallback steps do not modify the fitter.
+      ///
+      /// \param polyhedrons Polyhedron vector over which the capsule is
+      /// fitted
+      /// \param solver name of the solver plugin
+      /// \param parameterization parameterization of the problem
+      /// \param startParam starting capsule parameters
+      /// \return solutionParam solution capsule parameters
+      /// \return solver status
+      SolverStatus solve (const polyhedrons_t& polyhedrons,
+			  const std::string& solver,
+			  Parameterization parameterization,
+			  const_argument_ref startParam,
+			  argument_ref solutionParam);
+
+      /// \brief Compute the support points of the solution.
+      void computeSupportPoints (const polyhedrons_t& polyhedrons);
+
+      /// \brief Run a fitting step.
+      ///
+      /// \return solver status, NOT_SOLVED if the step was skipped.
+      SolverStatus runStep (FitStep step, const polyhedrons_t& polyhedrons,
+			    argument_ref solutionParam);
+
     private:
       /// \brief Polyhedron vector attribute.
       polyhedrons_t polyhedrons_;
@@ -140,6 +411,60 @@ namespace roboptim
 
       /// \brief Optional optimization log directory.
       boost::optional<std::string> logDir_;
+
+      /// \brief Solver log file.
+      std::string solverLogFile_;
+
+      /// \brief Whether the solver prints its progress.
+      bool verbose_;
+
+      /// \brief Outcome of the last optimization.
+      SolverStatus solverStatus_;
+
+      /// \brief Steps tried when the optimization fails.
+      std::vector<FitStep> fallbacks_;
+
+      /// \brief Solver of the OTHER_SOLVER fallback.
+      std::string fallbackSolver_;
+
+      /// \brief Steps of the last fitting.
+      attempts_t attempts_;
+
+      /// \brief Maximum number of solver iterations.
+      size_t maxIterations_;
+
+      /// \brief Maximum CPU time of each optimization.
+      value_type maxCpuTime_;
+
+      /// \brief Multipliers of the last optimization.
+      vector_t multipliers_;
+
+      /// \brief Relative tolerance of the support points.
+      value_type activeTolerance_;
+
+      /// \brief Support points of the solution.
+      supportPoints_t supportPoints_;
+
+      /// \brief Whether the solution is verified to contain the points.
+      bool verifyContainment_;
+
+      /// \brief Radius increase of the last containment verification.
+      value_type radiusInflation_;
+
+      /// \brief Whether sparse matrices are used.
+      bool useSparseMatrices_;
+
+      /// \brief Formulation of the point-in-capsule constraints.
+      ConstraintType constraintType_;
+
+      /// \brief Whether exact Hessians are used.
+      bool useExactHessian_;
+
+      /// \brief Length smoothing parameter of the optimized volume.
+      value_type lengthSmoothing_;
+
+      /// \brief Parameterization of the capsule.
+      Parameterization parameterization_;
     };
 
     /// \brief Print fitter after optimal capsule has been computed.
@@ -161,6 +486,173 @@ namespace roboptim
       return os;
     }
 
+    /// \brief Set the Ipopt parameters shared by the fitters.
+    ///
+    /// The Hessian approximation is left to the caller, since it
+    /// depends on the formulation of the problem.
+    ///
+    /// \param parameters solver parameters, updated.
+    /// \param logFile file where the solver writes its log, none if
+    /// empty.
+    /// \param verbose whether the solver prints its progress.
+    /// \param maxIterations maximum number of iterations, 0 for the
+    /// solver default.
+    /// \param maxCpuTime maximum CPU time in seconds, 0 for no limit.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void setIpoptParameters (solver_t::parameters_t& parameters,
+			     const std::string& logFile,
+			     bool verbose,
+			     size_t maxIterations,
+			     value_type maxCpuTime);
+
+    /// \brief Mutex of the solver plugins, which are loaded with
+    /// libltdl, which is not thread-safe.
+    ROBOPTIM_CAPSULE_DLLAPI boost::mutex& solverPluginMutex ();
+
+    /// \brief Mutex of the optimizations.
+    ///
+    /// Ipopt is set up with MUMPS (see setIpoptParameters), whose
+    /// sequential build is not thread-safe: parallel fitters hold this
+    /// mutex while the solver runs, and only prepare their problems
+    /// (point loading, convex hulls, initial capsules) in parallel.
+    ROBOPTIM_CAPSULE_DLLAPI boost::mutex& solverMutex ();
+
+    /// \brief Solver factory whose plugin is loaded and unloaded
+    /// under solverPluginMutex, so that fitters can run in parallel.
+    ///
+    /// \tparam S solver type.
+    template <typename S>
+    class LockedSolverFactory
+    {
+    public:
+      LockedSolverFactory (const std::string& solverName,
+			   typename S::problem_t& problem)
+      {
+	boost::mutex::scoped_lock lock (solverPluginMutex ());
+	factory_.reset (new SolverFactory<S> (solverName, problem));
+      }
+
+      ~LockedSolverFactory ()
+      {
+	boost::mutex::scoped_lock lock (solverPluginMutex ());
+	factory_.reset ();
+      }
+
+      S& operator() ()
+      {
+	return (*factory_) ();
+      }
+
+    private:
+      boost::shared_ptr<SolverFactory<S> > factory_;
+    };
+
+    /// \brief Solver of a fitting problem, shared by the fitters.
+    ///
+    /// The solver is created by a LockedSolverFactory, and set up by
+    /// setIpoptParameters from the options of a fitter (Fitter or
+    /// StadiumFitter). Its parameters may be changed before solve.
+    ///
+    /// \tparam S solver type.
+    template <typename S>
+    class FitterSolver
+    {
+    public:
+      template <typename F>
+      FitterSolver (const std::string& solverName,
+		    typename S::problem_t& problem,
+		    const F& fitter)
+	: factory_ (solverName, problem),
+	  verbose_ (fitter.verbose ()),
+	  result_ (0)
+      {
+	setIpoptParameters (solver ().parameters (), fitter.solverLogFile (),
+			    fitter.verbose (), fitter.maxIterations (),
+			    fitter.maxCpuTime ());
+      }
+
+      S& solver ()
+      {
+	return factory_ ();
+      }
+
+      /// \brief Solve the problem, under solverMutex.
+      ///
+      /// If no solution is found, the solution falls back to the
+      /// initial parameters. Failures are only displayed by verbose
+      /// fitters: the status is returned, e.g. recorded in
+      /// Fitter::attempts.
+      ///
+      /// \return solver status.
+      Fitter::SolverStatus solve (const_argument_ref initParam,
+				  argument_ref solutionParam)
+      {
+	S& solver = this->solver ();
+	result_ = 0;
+
+	{
+	  boost::mutex::scoped_lock lock (solverMutex ());
+	  solver.minimum ();
+	}
+
+	switch (solver.minimumType ())
+	  {
+	  case S::SOLVER_NO_SOLUTION:
+	    {
+	      if (verbose_)
+		std::cerr << "No solution." << std::endl;
+	      solutionParam = initParam;
+	      return Fitter::NO_SOLUTION;
+	    }
+	  case S::SOLVER_ERROR:
+	    {
+	      // Display error and fall back gracefully to initial
+	      // guess.
+	      if (verbose_)
+		std::cerr << "An error happened: " << std::endl
+			  << solver.template getMinimum<SolverError> ().what ()
+			  << std::endl;
+	      solutionParam = initParam;
+	      return Fitter::SOLVER_FAILED;
+	    }
+	  case S::SOLVER_VALUE_WARNINGS:
+	    {
+	      const ResultWithWarnings& result
+		= solver.template getMinimum<ResultWithWarnings> ();
+	      if (verbose_)
+		std::cout << "A solution has been found (with warnings)"
+			  << std::endl << result << std::endl;
+	      result_ = &result;
+	      solutionParam = result.x;
+	      return Fitter::SOLUTION_WITH_WARNINGS;
+	    }
+	  case S::SOLVER_VALUE:
+	    {
+	      const Result& result = solver.template getMinimum<Result> ();
+	      if (verbose_)
+		std::cout << "A solution has been found" << std::endl;
+	      result_ = &result;
+	      solutionParam = result.x;
+	      return Fitter::SOLUTION_FOUND;
+	    }
+	  }
+
+	return Fitter::NOT_SOLVED;
+      }
+
+      /// \brief Result of the last solve, null if no solution was
+      /// found.
+      const Result* result () const
+      {
+	return result_;
+      }
+
+    private:
+      LockedSolverFactory<S> factory_;
+      bool verbose_;
+      const Result* result_;
+    };
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
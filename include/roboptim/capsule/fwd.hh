@@ -22,12 +22,36 @@
 #ifndef KCD_ROBOPTIM_FWD_HH
 # define KCD_ROBOPTIM_FWD_HH
 
+# include <roboptim/core/fwd.hh>
+
 namespace roboptim
 {
   namespace capsule
   {
-    class Volume;
+    template <typename T> class GenericVolume;
+    typedef GenericVolume<EigenMatrixDense> Volume;
+    typedef GenericVolume<EigenMatrixSparse> SparseVolume;
+
     class DistanceCapsulePoint;
+
+    template <typename T> class GenericDistanceCapsulePoints;
+    typedef GenericDistanceCapsulePoints<EigenMatrixDense>
+    DistanceCapsulePoints;
+    typedef GenericDistanceCapsulePoints<EigenMatrixSparse>
+    SparseDistanceCapsulePoints;
+
+    class AxisParameterization;
+
+    template <typename T> class GenericAxisVolume;
+    typedef GenericAxisVolume<EigenMatrixDense> AxisVolume;
+    typedef GenericAxisVolume<EigenMatrixSparse> SparseAxisVolume;
+
+    template <typename T> class GenericAxisParameterizedFunction;
+    typedef GenericAxisParameterizedFunction<EigenMatrixDense>
+    AxisParameterizedFunction;
+    typedef GenericAxisParameterizedFunction<EigenMatrixSparse>
+    SparseAxisParameterizedFunction;
+
     class Fitter;
   } // end of namespace capsule.
 } // end of namespace kcd.
@@ -0,0 +1,177 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Inline geometry core: point-segment and point-capsule queries
+ * for any scalar type.
+ *
+ * Only Eigen is required: this header does not depend on RobOptim.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_GEOMETRY_HH
+# define ROBOPTIM_CAPSULE_GEOMETRY_HH
+
+# include <algorithm>
+# include <cassert>
+# include <cmath>
+
+# include <Eigen/Core>
+# include <Eigen/Geometry>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Structure containing Capsule data (start point, end point and
+    // radius).
+    ///
+    /// \tparam S scalar type (float or double).
+    template <typename S>
+    struct GenericCapsule
+    {
+      Eigen::Matrix<S,3,1> P0, P1;
+      S radius;
+
+      GenericCapsule ()
+	: P0 (Eigen::Matrix<S,3,1>::Zero ()),
+	  P1 (Eigen::Matrix<S,3,1>::Zero ()),
+	  radius (0)
+      {}
+
+      /// \brief Get the capsule with another scalar type.
+      template <typename T>
+      GenericCapsule<T> cast () const
+      {
+	GenericCapsule<T> capsule;
+	capsule.P0 = P0.template cast<T> ();
+	capsule.P1 = P1.template cast<T> ();
+	capsule.radius = static_cast<T> (radius);
+	return capsule;
+      }
+    };
+
+    // The functions below are defined inline so that client loops can
+    // inline and vectorize them. The library also exports their float
+    // and double instantiations, and the double overloads of util.hh.
+
+    /// \brief Compute the projection of point p on segment [a,b].
+    template <typename S>
+    inline Eigen::Matrix<S,3,1>
+    projectionOnSegment (const Eigen::Matrix<S,3,1>& p,
+			 const Eigen::Matrix<S,3,1>& a,
+			 const Eigen::Matrix<S,3,1>& b)
+    {
+      S d_ab = (b-a).norm ();
+
+      // If the segment is a point, i.e. a = b
+      if (d_ab < S (1e-6)) return a;
+
+      // We note q the projection of p on the line (a,b)
+      S d_aq = (p-a).dot (b-a)/d_ab;
+      if (d_aq > d_ab) return b;
+      else if (d_aq < S (0)) return a;
+      else return a + d_aq * (b-a).normalized ();
+    }
+
+    /// \brief Compute the distance from point p to segment [a,b].
+    template <typename S>
+    inline S distancePointToSegment (const Eigen::Matrix<S,3,1>& p,
+				     const Eigen::Matrix<S,3,1>& a,
+				     const Eigen::Matrix<S,3,1>& b)
+    {
+      S d_ab = (b-a).norm ();
+
+      // If the segment is a point, i.e. a = b
+      if (d_ab < S (1e-6)) return (a-p).norm ();
+
+      return (p - projectionOnSegment<S> (p, a, b)).norm ();
+    }
+
+    /// \brief Compute the parameter of the projection of point p on
+    /// segment [a,b].
+    ///
+    /// \return t in [0,1] such that the projection is a + t (b - a).
+    template <typename S>
+    inline S projectionParameterOnSegment (const Eigen::Matrix<S,3,1>& p,
+					   const Eigen::Matrix<S,3,1>& a,
+					   const Eigen::Matrix<S,3,1>& b)
+    {
+      S d_ab = (b-a).norm ();
+
+      // If the segment is a point, i.e. a = b
+      if (d_ab < S (1e-6)) return S (0);
+
+      S t = (p-a).dot (b-a)/(d_ab * d_ab);
+      if (t > S (1)) return S (1);
+      else if (t < S (0)) return S (0);
+      else return t;
+    }
+
+    /// \brief Distance from a point to a line described as a point and
+    /// a direction.
+    template <typename S>
+    inline S distancePointToLine (const Eigen::Matrix<S,3,1>& point,
+				  const Eigen::Matrix<S,3,1>& linePoint,
+				  const Eigen::Matrix<S,3,1>& dir)
+    {
+      assert (dir.norm () > S (0));
+      return (dir.cross (linePoint - point)).norm () / dir.norm ();
+    }
+
+    /// \brief Signed distance from a point to the surface of a capsule,
+    /// negative inside.
+    template <typename S>
+    inline S distancePointToCapsule (const GenericCapsule<S>& capsule,
+				     const Eigen::Matrix<S,3,1>& p)
+    {
+      return distancePointToSegment<S> (p, capsule.P0, capsule.P1)
+	- capsule.radius;
+    }
+
+    /// \brief Whether a capsule contains a point (boundary included).
+    ///
+    /// Squared distances are compared: no square root is computed.
+    template <typename S>
+    inline bool capsuleContainsPoint (const GenericCapsule<S>& capsule,
+				      const Eigen::Matrix<S,3,1>& p)
+    {
+      Eigen::Matrix<S,3,1> axis = capsule.P1 - capsule.P0;
+      S squaredLength = axis.squaredNorm ();
+      Eigen::Matrix<S,3,1> w = p - capsule.P0;
+      S t = (squaredLength > S (0)) ? w.dot (axis) / squaredLength : S (0);
+      t = std::min (S (1), std::max (S (0), t));
+      return (w - t * axis).squaredNorm () <= capsule.radius * capsule.radius;
+    }
+
+    /// \brief Compute the volume of a capsule.
+    template <typename S>
+    inline S capsuleVolume (const GenericCapsule<S>& capsule)
+    {
+      // M_PI is not standard.
+      const S pi = S (3.14159265358979323846);
+
+      S length = (capsule.P1 - capsule.P0).norm ();
+      S radius = capsule.radius;
+
+      return pi * radius * radius * (S (4) / S (3) * radius + length);
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_GEOMETRY_HH
@@ -0,0 +1,184 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of IncrementalFitter class that updates a
+ * capsule when points are edited.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_HH
+# define ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_HH
+
+# include <string>
+# include <vector>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Capsule fitter for edited point sets.
+    ///
+    /// Points are added, removed or moved, and update () refits the
+    /// capsule only when its optimality may have changed:
+    ///
+    /// - a point added inside the capsule keeps it feasible, hence
+    ///   optimal;
+    /// - a point removed from the interior of the capsule was not
+    ///   active, so the optimality conditions still hold.
+    ///
+    /// Otherwise, the convex hull is updated (the hull of the previous
+    /// hull vertices and the added points, unless a hull vertex was
+    /// removed) and the problem is solved again, starting from the
+    /// previous capsule inflated to contain the new hull.
+    ///
+    /// Points are identified by the index returned when they were
+    /// added; indices of removed points are not reused.
+    class ROBOPTIM_CAPSULE_DLLAPI IncrementalFitter
+    {
+    public:
+      /// \brief Constructor.
+      ///
+      /// The capsule is fitted by the first call to update ().
+      ///
+      /// \param points initial points (indices 0 to N-1).
+      /// \param solver nonlinear solver.
+      explicit IncrementalFitter (const polyhedron_t& points,
+				  std::string solver = "ipopt");
+
+      /// \brief Constructor from a known optimal capsule.
+      ///
+      /// \param points initial points (indices 0 to N-1).
+      /// \param capsuleParam optimal capsule parameters over the
+      /// points (see convertCapsuleToSolverParam).
+      /// \param solver nonlinear solver.
+      IncrementalFitter (const polyhedron_t& points,
+			 const_argument_ref capsuleParam,
+			 std::string solver = "ipopt");
+
+      ~IncrementalFitter ();
+
+      /// \brief Fitter used for the refits, e.g. to set its options.
+      Fitter& fitter ();
+      const Fitter& fitter () const;
+
+      /// \brief Relative distance to the surface under which a point is
+      /// active: a point is active if its distance to the segment is
+      /// larger than (1 - activeTolerance) times the radius.
+      ///
+      /// Larger values trigger more refits. Default is 1e-3.
+      value_type& activeTolerance ();
+      value_type activeTolerance () const;
+
+      /// \brief Add a point.
+      ///
+      /// \return index of the point.
+      size_t addPoint (const point_t& point);
+
+      /// \brief Remove a point.
+      void removePoint (size_t id);
+
+      /// \brief Move a point, i.e. remove it and add it again with the
+      /// same index.
+      void movePoint (size_t id, const point_t& point);
+
+      /// \brief Whether a point was added and not removed.
+      bool contains (size_t id) const;
+
+      /// \brief Get a point.
+      const point_t& point (size_t id) const;
+
+      /// \brief Number of points that are not removed.
+      size_t size () const;
+
+      /// \brief Apply the edits since the last update.
+      ///
+      /// \return true if the problem was solved again.
+      bool update ();
+
+      /// \brief Whether the next update will solve the problem again.
+      bool needsRefit () const;
+
+      /// \brief Get the capsule parameters of the last update.
+      const argument_t& capsule () const;
+
+      /// \brief Get the vertices of the convex hull of the last refit.
+      const polyhedron_t& hull () const;
+
+      /// \brief Get the hull vertices that are active for the current
+      /// capsule.
+      polyhedron_t activePoints () const;
+
+      /// \brief Number of refits since construction.
+      size_t refitCount () const;
+
+    private:
+      /// \brief Record an added point.
+      void notifyAdded (size_t id);
+
+      /// \brief Whether a point is active for the current capsule.
+      bool isActive (const point_t& point) const;
+
+      /// \brief Whether a point is a vertex of the current hull.
+      bool isHullVertex (const point_t& point) const;
+
+      /// \brief Update the convex hull with the edited points.
+      void updateHull ();
+
+      /// \brief Points, including removed ones.
+      polyhedron_t points_;
+
+      /// \brief Whether each point was removed.
+      std::vector<bool> removed_;
+
+      /// \brief Number of points that are not removed.
+      size_t size_;
+
+      /// \brief Vertices of the convex hull.
+      polyhedron_t hull_;
+
+      /// \brief Indices of the points added since the last hull update.
+      std::vector<size_t> added_;
+
+      /// \brief Whether a hull vertex was removed since the last hull
+      /// update.
+      bool hullVertexRemoved_;
+
+      /// \brief Whether the capsule must be fitted again.
+      bool needsRefit_;
+
+      /// \brief Current capsule parameters.
+      argument_t capsule_;
+
+      /// \brief Fitter used for the refits.
+      Fitter fitter_;
+
+      /// \brief Relative tolerance of the active points.
+      value_type activeTolerance_;
+
+      /// \brief Number of refits.
+      size_t refitCount_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_HH
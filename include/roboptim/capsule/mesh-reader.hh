@@ -0,0 +1,116 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Streaming readers for the vertices of mesh files.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MESH_READER_HH
+# define ROBOPTIM_CAPSULE_MESH_READER_HH
+
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Supported mesh file formats.
+    enum MeshFormat
+      {
+	/// \brief Unknown format.
+	MESH_UNKNOWN,
+	/// \brief ASCII or binary STL.
+	MESH_STL,
+	/// \brief Wavefront OBJ (only "v" lines are read).
+	MESH_OBJ,
+	/// \brief ASCII or binary PLY (only the vertex element is read).
+	MESH_PLY,
+	/// \brief Raw little-endian float64 coordinates, x y z per point.
+	MESH_XYZ,
+	/// \brief Point cloud (see point-cloud.hh). Parts are merged.
+	MESH_POINT_CLOUD
+      };
+
+    /// \brief Get the mesh format from a file extension.
+    ///
+    /// \param name file name (e.g. "part.stl") or format name (e.g.
+    /// "stl"), case-insensitive.
+    ///
+    /// \return format, MESH_UNKNOWN if not supported.
+    ROBOPTIM_CAPSULE_DLLAPI
+    MeshFormat meshFormatFromName (const std::string& name);
+
+    /// \brief Read the vertices of a mesh from a stream.
+    ///
+    /// Vertices are parsed one at a time and appended to the points,
+    /// the whole file is never kept in memory. Only the vertices are
+    /// read: duplicated vertices (e.g. STL facets) are kept, and they
+    /// do not change the convex hull. The stream must be opened in
+    /// binary mode for binary formats.
+    ///
+    /// Throws std::runtime_error on malformed input.
+    ///
+    /// \param is input stream.
+    /// \param format mesh format.
+    /// \return points vector to which the vertices are appended.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void readMeshPoints (std::istream& is, MeshFormat format,
+			 polyhedron_t& points);
+
+    /// \brief Read the vertices of a mesh file.
+    ///
+    /// \param fileName file name, "-" for the standard input.
+    /// \param format mesh format. If MESH_UNKNOWN, it is deduced from
+    /// the file extension.
+    /// \return points vector to which the vertices are appended.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void readMeshPoints (const std::string& fileName, MeshFormat format,
+			 polyhedron_t& points);
+
+    /// \brief Read a manifest of mesh files.
+    ///
+    /// The manifest lists one input per line, empty lines and lines
+    /// starting with # are ignored. Relative paths are relative to the
+    /// manifest directory.
+    ///
+    /// Throws std::runtime_error if the manifest cannot be opened.
+    ///
+    /// \param fileName manifest file name.
+    /// \return input files, in the manifest order.
+    ROBOPTIM_CAPSULE_DLLAPI
+    std::vector<std::string> readManifest (const std::string& fileName);
+
+    /// \brief List the files of a directory with a supported format
+    /// (see meshFormatFromName).
+    ///
+    /// Throws std::runtime_error if it is not a directory.
+    ///
+    /// \param directory directory, not searched recursively.
+    /// \return files, sorted by name.
+    ROBOPTIM_CAPSULE_DLLAPI
+    std::vector<std::string> listMeshFiles (const std::string& directory);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MESH_READER_HH
@@ -0,0 +1,217 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Decomposition of a set of points into several capsules, and
+ * level-of-detail hierarchies of such decompositions.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MULTI_CAPSULE_HH
+# define ROBOPTIM_CAPSULE_MULTI_CAPSULE_HH
+
+# include <iosfwd>
+# include <string>
+# include <utility>
+# include <vector>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Options of the multi-capsule decomposition.
+    struct ROBOPTIM_CAPSULE_DLLAPI MultiCapsuleOptions
+    {
+      MultiCapsuleOptions ();
+
+      /// \brief Maximum number of capsules. Default is 8.
+      size_t maxCapsules;
+
+      /// \brief A capsule is split if the total volume of the two
+      /// capsules of its halves is less than this ratio times its
+      /// volume. Default is 0.8.
+      value_type volumeRatio;
+
+      /// \brief Width of the slab around each split plane whose
+      /// points belong to both halves, so that the capsules overlap.
+      /// Default is 0.
+      value_type overlap;
+
+      /// \brief Clusters with less points are not split. Default is 8.
+      size_t minPoints;
+
+      /// \brief Whether capsules are optimized with Fitter. Otherwise,
+      /// the bounding capsules of computeBoundingCapsulePolyhedron are
+      /// used. Default is true.
+      bool optimize;
+
+      /// \brief Nonlinear solver used by Fitter. Default is "ipopt".
+      std::string solver;
+
+      /// \brief Number of clusters split and fitted in parallel.
+      /// Default is 1.
+      ///
+      /// Splitting, bounding capsules and containment inflation run
+      /// concurrently. Convex hulls and optimizations are serialized
+      /// (see solverMutex), and only overlap each other: with optimize,
+      /// the speed-up is bounded by the share of the other steps.
+      size_t jobs;
+    };
+
+    /// \brief Fit several capsules to a set of points.
+    ///
+    /// The points are split recursively in two halves by the plane
+    /// orthogonal to their principal axis going through their
+    /// centroid, and a capsule is fitted to each half. A split is kept
+    /// if it reduces the volume enough (see volumeRatio), so the
+    /// number of capsules is chosen automatically. The capsule with
+    /// the largest volume is split first.
+    ///
+    /// Each capsule contains all the points of its cluster, and every
+    /// point belongs to a cluster: the capsules cover all the points.
+    /// Mesh faces that cross a split plane are only covered if their
+    /// vertices lie in the overlap slab, i.e. the overlap should be
+    /// larger than the mesh edges.
+    ///
+    /// \param polyhedrons polyhedrons containing the points.
+    /// \param options decomposition options.
+    /// \return capsules parameters (see convertCapsuleToSolverParam),
+    /// sorted by decreasing volume.
+    ROBOPTIM_CAPSULE_DLLAPI
+    std::vector<argument_t>
+    fitCapsules (const polyhedrons_t& polyhedrons,
+		 const MultiCapsuleOptions& options = MultiCapsuleOptions ());
+
+    /// \brief Node of a capsule hierarchy.
+    struct ROBOPTIM_CAPSULE_DLLAPI CapsuleHierarchyNode
+    {
+      /// \brief Capsule parameters (see convertCapsuleToSolverParam).
+      argument_t capsule;
+
+      /// \brief Index of the parent node, -1 for the root.
+      size_type parent;
+
+      /// \brief Depth of the node, 0 for the root.
+      size_t depth;
+
+      /// \brief Indices of the children nodes (none or two).
+      std::vector<size_t> children;
+    };
+
+    /// \brief Level-of-detail hierarchy of capsules covering a set of
+    /// points.
+    ///
+    /// The root (level 0) is the single capsule fit. The children of a
+    /// node are the capsules of the two halves of its points (see
+    /// fitCapsules), so that each level is a tighter cover of the
+    /// points than the previous one. Since the points of a node are
+    /// covered by its capsule, a query that misses a node can skip its
+    /// whole subtree.
+    ///
+    /// The root is node 0, and parents come before their children (a
+    /// hierarchy built from points is in breadth-first order).
+    class ROBOPTIM_CAPSULE_DLLAPI CapsuleHierarchy
+    {
+    public:
+      /// \brief Named hierarchies, e.g. one per link of a robot.
+      typedef std::vector<std::pair<std::string, CapsuleHierarchy> >
+      hierarchies_t;
+
+      /// \brief Empty hierarchy.
+      CapsuleHierarchy ();
+
+      /// \brief Build the hierarchy of a set of points.
+      ///
+      /// A node is split if its points can be split (see minPoints) and
+      /// the volume of its children is small enough (see volumeRatio).
+      /// The maximum number of capsules is not used.
+      ///
+      /// \param polyhedrons polyhedrons containing the points.
+      /// \param maxDepth depth of the deepest nodes.
+      /// \param options decomposition options.
+      CapsuleHierarchy (const polyhedrons_t& polyhedrons, size_t maxDepth,
+			const MultiCapsuleOptions& options
+			= MultiCapsuleOptions ());
+
+      /// \brief Get the number of nodes.
+      size_t size () const;
+
+      /// \brief Get whether the hierarchy has no node.
+      bool empty () const;
+
+      /// \brief Get a node.
+      const CapsuleHierarchyNode& node (size_t i) const;
+
+      /// \brief Get the depth of the deepest nodes.
+      size_t depth () const;
+
+      /// \brief Get the capsules covering the points at a level of
+      /// detail: the nodes of this depth, and the leaves above it.
+      ///
+      /// \param level level of detail, 0 for the single capsule.
+      std::vector<argument_t> level (size_t level) const;
+
+      /// \brief Add a node.
+      ///
+      /// \param capsule capsule parameters.
+      /// \param parent parent node (already added), -1 for the root.
+      /// \return index of the new node.
+      size_t addNode (const_argument_ref capsule, size_type parent);
+
+    private:
+      /// \brief Nodes, in breadth-first order.
+      std::vector<CapsuleHierarchyNode> nodes_;
+    };
+
+    /// \brief Write named capsule hierarchies.
+    ///
+    /// A hierarchy file (extension .rclod) contains, in little-endian
+    /// order:
+    ///   - 8 bytes: magic "RCLODCAP",
+    ///   - uint32: version (1),
+    ///   - uint32: number of hierarchies,
+    ///
+    /// then for each hierarchy:
+    ///   - uint32: name length, followed by the name,
+    ///   - uint32: number of nodes,
+    ///   - for each node, in order: int32 parent index (-1 for the
+    ///     root) and 7 float64 capsule parameters.
+    ///
+    /// \param os output stream, opened in binary mode.
+    /// \param hierarchies named hierarchies.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void writeCapsuleHierarchies
+    (std::ostream& os, const CapsuleHierarchy::hierarchies_t& hierarchies);
+
+    /// \brief Read named capsule hierarchies (see
+    /// writeCapsuleHierarchies).
+    ///
+    /// Throws std::runtime_error on malformed input.
+    ///
+    /// \param is input stream, opened in binary mode.
+    /// \return hierarchies named hierarchies, appended.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void readCapsuleHierarchies (std::istream& is,
+				 CapsuleHierarchy::hierarchies_t& hierarchies);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MULTI_CAPSULE_HH
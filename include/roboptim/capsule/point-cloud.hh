@@ -0,0 +1,215 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Binary point cloud format, read through a memory mapping.
+ *
+ * A point cloud file (extension .rcpc) contains, in little-endian
+ * order:
+ *
+ * | offset | type        | content                                     |
+ * |--------|-------------|---------------------------------------------|
+ * | 0      | char[8]     | magic number "RCPCLOUD"                     |
+ * | 8      | uint32      | version (1)                                 |
+ * | 12     | uint32      | scalar size: 4 (float32) or 8 (float64)     |
+ * | 16     | uint64      | number of points N                          |
+ * | 24     | uint64      | number of parts P (0: a single part)        |
+ * | 32     | uint64[P+1] | if P > 0, index of the first point of each  |
+ * |        |             | part, followed by N                         |
+ * | ...    | scalar[3N]  | packed x y z coordinates                    |
+ *
+ * Coordinates start at an offset multiple of 8, so that they can be
+ * used in place once the file is mapped. Parts map onto the
+ * polyhedrons of polyhedrons_t.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_POINT_CLOUD_HH
+# define ROBOPTIM_CAPSULE_POINT_CLOUD_HH
+
+# include <iosfwd>
+# include <string>
+# include <vector>
+
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace boost
+{
+  namespace interprocess
+  {
+    class mapped_region;
+  } // end of namespace interprocess.
+} // end of namespace boost.
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Read-only view of packed x y z coordinates.
+    ///
+    /// The coordinates are not copied: points are converted to
+    /// point_t when accessed.
+    ///
+    /// \tparam S scalar type of the coordinates (float or double).
+    template <typename S>
+    class PointsView
+    {
+    public:
+      typedef S scalar_t;
+
+      PointsView ()
+	: data_ (0),
+	  size_ (0)
+      {
+      }
+
+      /// \brief Constructor.
+      ///
+      /// \param data packed coordinates (3 * size scalars).
+      /// \param size number of points.
+      PointsView (const S* data, size_t size)
+	: data_ (data),
+	  size_ (size)
+      {
+      }
+
+      /// \brief Number of points.
+      size_t size () const
+      {
+	return size_;
+      }
+
+      /// \brief Whether the view is empty.
+      bool empty () const
+      {
+	return size_ == 0;
+      }
+
+      /// \brief Get i-th point.
+      point_t operator[] (size_t i) const
+      {
+	const S* p = data_ + 3 * i;
+	return point_t (static_cast<value_type> (p[0]),
+			static_cast<value_type> (p[1]),
+			static_cast<value_type> (p[2]));
+      }
+
+      /// \brief Packed coordinates.
+      const S* data () const
+      {
+	return data_;
+      }
+
+    private:
+      const S* data_;
+      size_t size_;
+    };
+
+    /// \brief Point cloud file mapped in memory.
+    ///
+    /// Only the pages that are accessed are read, and coordinates are
+    /// exposed through views on the mapping. The mapping is released
+    /// with the last copy of the object, views must not outlive it.
+    ///
+    /// Throws std::runtime_error if the file cannot be mapped or is
+    /// not a valid point cloud.
+    class ROBOPTIM_CAPSULE_DLLAPI PointCloudFile
+    {
+    public:
+      /// \brief Map a point cloud file.
+      ///
+      /// \param fileName file name.
+      explicit PointCloudFile (const std::string& fileName);
+
+      ~PointCloudFile ();
+
+      /// \brief Scalar size in bytes (4 or 8).
+      size_t scalarSize () const;
+
+      /// \brief Number of points.
+      size_t size () const;
+
+      /// \brief Number of parts (at least 1).
+      size_t nbParts () const;
+
+      /// \brief Index of the first point of a part.
+      size_t partBegin (size_t part) const;
+
+      /// \brief Number of points of a part.
+      size_t partSize (size_t part) const;
+
+      /// \brief View of float32 coordinates.
+      ///
+      /// Only valid if scalarSize () is 4.
+      PointsView<float> floatPoints () const;
+      PointsView<float> floatPoints (size_t part) const;
+
+      /// \brief View of float64 coordinates.
+      ///
+      /// Only valid if scalarSize () is 8.
+      PointsView<double> doublePoints () const;
+      PointsView<double> doublePoints (size_t part) const;
+
+      /// \brief Copy the points to a polyhedron vector, one polyhedron
+      /// per part.
+      void polyhedrons (polyhedrons_t& polyhedrons) const;
+
+    private:
+      /// \brief Memory mapping of the file.
+      boost::shared_ptr<boost::interprocess::mapped_region> region_;
+
+      /// \brief Start of the coordinates.
+      const char* data_;
+
+      /// \brief Scalar size in bytes.
+      size_t scalarSize_;
+
+      /// \brief Number of points.
+      size_t size_;
+
+      /// \brief Index of the first point of each part, followed by
+      /// the number of points.
+      std::vector<size_t> offsets_;
+    };
+
+    /// \brief Read a point cloud from a stream.
+    ///
+    /// Unlike PointCloudFile, this works with any stream (e.g. the
+    /// standard input), but the points are copied.
+    ///
+    /// \param is input stream, opened in binary mode.
+    /// \return polyhedrons vector to which the parts are appended.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void readPointCloud (std::istream& is, polyhedrons_t& polyhedrons);
+
+    /// \brief Write a point cloud file.
+    ///
+    /// \param os output stream, opened in binary mode.
+    /// \param polyhedrons polyhedrons, written as parts.
+    /// \param singlePrecision whether coordinates are stored as
+    /// float32 instead of float64.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void writePointCloud (std::ostream& os, const polyhedrons_t& polyhedrons,
+			  bool singlePrecision = false);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_POINT_CLOUD_HH
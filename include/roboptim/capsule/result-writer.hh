@@ -0,0 +1,156 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Machine-readable output of capsule fitting results.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_RESULT_WRITER_HH
+# define ROBOPTIM_CAPSULE_RESULT_WRITER_HH
+
+# include <iosfwd>
+# include <string>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Result of the fitting of one input.
+    struct ROBOPTIM_CAPSULE_DLLAPI FitResult
+    {
+      FitResult ();
+
+      /// \brief Input name (e.g. file name), may be empty.
+      std::string name;
+
+      /// \brief Initial capsule parameters (see
+      /// convertCapsuleToSolverParam), empty if the fitting failed
+      /// before.
+      argument_t initParam;
+
+      /// \brief Optimized capsule parameters, empty if the fitting
+      /// failed before.
+      argument_t solutionParam;
+
+      /// \brief Outcome of the optimization.
+      Fitter::SolverStatus status;
+
+      /// \brief Steps of the fitting, i.e. the fallbacks used (see
+      /// Fitter::attempts).
+      Fitter::attempts_t attempts;
+
+      /// \brief Time spent reading the input and computing its convex
+      /// hull, in seconds.
+      double loadTime;
+
+      /// \brief Time spent in the optimization, in seconds.
+      double solveTime;
+
+      /// \brief Number of points of the convex hull.
+      size_t nbHullPoints;
+
+      /// \brief Error message, empty on success.
+      std::string error;
+    };
+
+    /// \brief Get the name of a solver status, e.g. "solution_found".
+    ROBOPTIM_CAPSULE_DLLAPI
+    const char* solverStatusName (Fitter::SolverStatus status);
+
+    /// \brief Get the name of a fitting step, e.g. "perturbed_start".
+    ROBOPTIM_CAPSULE_DLLAPI
+    const char* fitStepName (Fitter::FitStep step);
+
+    /// \brief Writer of fitting results, one record per input.
+    ///
+    /// Supported formats:
+    ///   - TEXT: the human-readable "Initial:" and "Solution:" lines,
+    ///     and a "Fallbacks:" line if fallbacks were used,
+    ///   - JSON: JSON Lines, i.e. one JSON object per line, so that
+    ///     results can be streamed. Fields are "name", "status",
+    ///     "attempts" (array of objects with "step" and "status"),
+    ///     "initial" and "solution" (objects with "p0", "p1", "radius"
+    ///     and "volume"), "load_time", "solve_time", "hull_points" and
+    ///     "error". Non-finite numbers are written as null,
+    ///   - CSV: a header line followed by one line per input. Attempts
+    ///     are written as step:status pairs separated by semicolons,
+    ///   - BINARY: little-endian records after an 8-byte "RCRESULT"
+    ///     magic and a uint32 version (2). Each record contains:
+    ///     uint32 status, uint32 name length, name, 7 float64 initial
+    ///     parameters, 7 float64 solution parameters, float64 initial
+    ///     and solution volumes, float64 load and solve times, uint64
+    ///     hull points, uint32 error length and error, uint32 number of
+    ///     attempts and, for each attempt, uint32 step and uint32
+    ///     status. Parameters and volumes are NaN when missing.
+    ///
+    /// Numbers are written with full precision. The writer does not
+    /// lock: concurrent writes must be serialized by the caller.
+    class ROBOPTIM_CAPSULE_DLLAPI ResultWriter
+    {
+    public:
+      /// \brief Output formats.
+      enum Format
+	{
+	  TEXT,
+	  JSON,
+	  CSV,
+	  BINARY
+	};
+
+      /// \brief Constructor. Writes the header of the format, if any.
+      ///
+      /// \param os output stream, opened in binary mode for BINARY.
+      /// \param format output format.
+      ResultWriter (std::ostream& os, Format format);
+
+      /// \brief Write the result of one input.
+      void write (const FitResult& result);
+
+      /// \brief Get the output format.
+      Format format () const;
+
+    private:
+      void writeText (const FitResult& result);
+      void writeJson (const FitResult& result);
+      void writeCsv (const FitResult& result);
+      void writeBinary (const FitResult& result);
+
+      /// \brief Output stream.
+      std::ostream& os_;
+
+      /// \brief Output format.
+      Format format_;
+    };
+
+    /// \brief Get an output format from its name (text, json, csv or
+    /// binary).
+    ///
+    /// \return false if the name is unknown.
+    ROBOPTIM_CAPSULE_DLLAPI
+    bool parseResultFormat (const std::string& name,
+			    ResultWriter::Format& format);
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_RESULT_WRITER_HH
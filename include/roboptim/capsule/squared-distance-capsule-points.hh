@@ -0,0 +1,123 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of GenericSquaredDistanceCapsulePoints class
+ * that computes a smooth reformulation of the capsule-points
+ * distances.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_HH
+# define ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_HH
+
+# include <roboptim/core/twice-differentiable-function.hh>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Smooth point-in-capsule constraints.
+    ///
+    /// The distance to the segment is not differentiable where the
+    /// projection switches between an end point and the interior of
+    /// the segment. Here, each point \f$p_i\f$ gets an auxiliary
+    /// variable \f$t_i \in [0,1]\f$ that parameterizes a point of the
+    /// segment, and output i is:
+    ///
+    /// \f$\|(1 - t_i) e_1 + t_i e_2 - p_i\|^2 - r^2\f$
+    ///
+    /// Requiring all outputs to be nonpositive (with \f$r \geq 0\f$
+    /// and \f$0 \leq t_i \leq 1\f$) defines the same feasible capsules
+    /// as the distance constraints, but the functions are polynomial.
+    ///
+    /// The argument contains the 7 capsule parameters followed by the
+    /// N projection parameters. Row i only depends on the capsule
+    /// parameters and \f$t_i\f$, i.e. 8 variables, and so does its
+    /// (exact) Hessian.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericSquaredDistanceCapsulePoints
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
+    {
+    public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericTwiceDifferentiableFunction<T>);
+
+      /// \brief Constructor.
+      ///
+      /// \param polyhedrons polyhedron vector containing the points
+      /// that will be used in computing distances.
+      GenericSquaredDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+					   std::string name
+					   = "squared distance to points");
+
+      ~GenericSquaredDistanceCapsulePoints ();
+
+      /// \brief Get points attribute.
+      const polyhedron_t& points () const;
+
+      /// \brief Compute a starting point from capsule parameters.
+      ///
+      /// Projection parameters are initialized with the projections
+      /// of the points on the capsule segment.
+      ///
+      /// \param capsuleParam capsule parameters (7 elements).
+      /// \return x full argument (7 + N elements).
+      void startingPoint (argument_ref x,
+			  const_argument_ref capsuleParam) const;
+
+    protected:
+      virtual void
+      impl_compute (result_ref result,
+		    const_argument_ref argument) const;
+
+      virtual void
+      impl_gradient (gradient_ref gradient,
+		     const_argument_ref argument,
+		     size_type functionId = 0) const;
+
+      virtual void
+      impl_jacobian (jacobian_ref jacobian,
+		     const_argument_ref argument) const;
+
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+
+    private:
+      /// \brief Union of all the points of the polyhedrons.
+      polyhedron_t points_;
+    };
+
+    /// \brief Smooth distance function using dense matrices.
+    typedef GenericSquaredDistanceCapsulePoints<EigenMatrixDense>
+    SquaredDistanceCapsulePoints;
+
+    /// \brief Smooth distance function using sparse matrices.
+    typedef GenericSquaredDistanceCapsulePoints<EigenMatrixSparse>
+    SparseSquaredDistanceCapsulePoints;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_HH
@@ -0,0 +1,174 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of StadiumFitter class that computes the best
+ * fitting stadium for planar points.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_STADIUM_FITTER_HH
+# define ROBOPTIM_CAPSULE_STADIUM_FITTER_HH
+
+# include <string>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Stadium fitter class.
+    ///
+    /// Planar counterpart of Fitter, e.g. for the footprint of a
+    /// mobile base: the area (see GenericArea) of a stadium is
+    /// minimized under one distance constraint per point (see
+    /// GenericDistanceStadiumPoints), with 5 parameters instead of the
+    /// 7 of a capsule. Points are usually the vertices of
+    /// computeConvexPolygon, and the initial parameters are given by
+    /// stadiumFromPoints.
+    ///
+    /// Stadium parameters are given as in convertStadiumToSolverParam.
+    class ROBOPTIM_CAPSULE_DLLAPI StadiumFitter
+    {
+    public:
+      /// \brief Constructor.
+      StadiumFitter (const polygons_t& polygons,
+		     std::string solver = "ipopt");
+
+      ~StadiumFitter ();
+
+      /// \brief Get polygon attribute.
+      const polygons_t& polygons () const;
+
+      /// \brief Set polygon attribute.
+      void polygons (const polygons_t& polygons);
+
+      /// \brief Get stadium area for initial parameters.
+      value_type initArea () const;
+
+      /// \brief Get stadium area for solution parameters.
+      value_type solutionArea () const;
+
+      /// \brief Get initial stadium parameters.
+      const argument_t& initParam () const;
+
+      /// \brief Get solution stadium parameters.
+      const argument_t& solutionParam () const;
+
+      /// \brief Get the file where the solver writes its log.
+      ///
+      /// Default is empty, i.e. no file is written.
+      std::string& solverLogFile ();
+      const std::string& solverLogFile () const;
+
+      /// \brief Whether the solver prints its progress. Default is
+      /// false.
+      bool& verbose ();
+      bool verbose () const;
+
+      /// \brief Maximum number of solver iterations. Default is 0,
+      /// i.e. the solver default.
+      size_t& maxIterations ();
+      size_t maxIterations () const;
+
+      /// \brief Maximum CPU time of the optimization, in seconds.
+      /// Default is 0, i.e. no limit.
+      value_type& maxCpuTime ();
+      value_type maxCpuTime () const;
+
+      /// \brief Whether the solution is verified to contain the points
+      /// (see Fitter::verifyContainment). Default is true.
+      bool& verifyContainment ();
+      bool verifyContainment () const;
+
+      /// \brief Get the radius increase of the last containment
+      /// verification (0 if the solution contained all the points).
+      value_type radiusInflation () const;
+
+      /// \brief Whether the problem is built with sparse matrices
+      /// ("ipopt" is then replaced by "ipopt-sparse"). Default is
+      /// false.
+      bool& useSparseMatrices ();
+      bool useSparseMatrices () const;
+
+      /// \brief Get the outcome of the last optimization. If no
+      /// solution was found, the solution is the initial guess.
+      Fitter::SolverStatus solverStatus () const;
+
+      /// \brief Compute best fitting stadium over the polygons.
+      ///
+      /// \param initParam initial stadium parameters (5 elements).
+      void computeBestFitStadium (const_argument_ref initParam);
+
+      /// \brief Compute best fitting stadium over a polygon vector.
+      ///
+      /// \param polygons polygon vector over which the stadium is
+      /// fitted.
+      /// \param initParam initial stadium parameters (5 elements).
+      void computeBestFitStadium (const polygons_t& polygons,
+				  const_argument_ref initParam);
+
+    protected:
+      /// \brief Implementation of best fitting stadium computation.
+      void impl_computeBestFitStadium (const polygons_t& polygons,
+				       const_argument_ref initParam);
+
+    private:
+      /// \brief Polygon vector attribute.
+      polygons_t polygons_;
+
+      /// \brief Nonlinear solver.
+      std::string solver_;
+
+      /// \brief Stadium initial parameters.
+      argument_t initParam_;
+
+      /// \brief Stadium solution parameters.
+      argument_t solutionParam_;
+
+      /// \brief Solver log file.
+      std::string solverLogFile_;
+
+      /// \brief Whether the solver prints its progress.
+      bool verbose_;
+
+      /// \brief Maximum number of solver iterations.
+      size_t maxIterations_;
+
+      /// \brief Maximum CPU time of the optimization.
+      value_type maxCpuTime_;
+
+      /// \brief Whether the solution is verified to contain the points.
+      bool verifyContainment_;
+
+      /// \brief Radius increase of the last containment verification.
+      value_type radiusInflation_;
+
+      /// \brief Whether sparse matrices are used.
+      bool useSparseMatrices_;
+
+      /// \brief Outcome of the last optimization.
+      Fitter::SolverStatus solverStatus_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_STADIUM_FITTER_HH
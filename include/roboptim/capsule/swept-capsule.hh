@@ -0,0 +1,115 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Capsules bounding the volume swept by a moving link.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_SWEPT_CAPSULE_HH
+# define ROBOPTIM_CAPSULE_SWEPT_CAPSULE_HH
+
+# include <string>
+# include <vector>
+
+# include <Eigen/Geometry>
+# include <Eigen/StdVector>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Sequence of poses of a link (link frame to world frame).
+    typedef std::vector<Eigen::Isometry3d,
+			Eigen::aligned_allocator<Eigen::Isometry3d> > poses_t;
+
+    /// \brief Options of the swept capsule fitting.
+    struct ROBOPTIM_CAPSULE_DLLAPI SweptCapsuleOptions
+    {
+      SweptCapsuleOptions ();
+
+      /// \brief Largest displacement of a point between two samples of
+      /// the motion. Default is 0.01.
+      value_type maxStep;
+
+      /// \brief Largest number of samples between two poses. Default
+      /// is 64.
+      size_t maxSamplesPerInterval;
+
+      /// \brief Whether the radius is increased by the largest distance
+      /// between the motion and its samples, so that the capsule
+      /// contains the whole swept volume. Default is true.
+      bool conservative;
+
+      /// \brief Whether the capsule is optimized with Fitter over the
+      /// convex hull of the samples. Otherwise, the bounding capsule of
+      /// computeBoundingCapsulePolyhedron is used. Default is true.
+      bool optimize;
+
+      /// \brief Nonlinear solver used by Fitter. Default is "ipopt".
+      std::string solver;
+
+      /// \brief Number of threads transforming the points. Default
+      /// is 1.
+      size_t jobs;
+    };
+
+    /// \brief Sample the volume swept by a link along a motion.
+    ///
+    /// Between two consecutive poses, the motion interpolates the
+    /// translation linearly and the rotation spherically. Each interval
+    /// is sampled so that no point moves more than maxStep between
+    /// two samples.
+    ///
+    /// \param points points of the link, in the link frame (e.g. the
+    /// vertices of its convex hull).
+    /// \param poses poses of the link (at least one).
+    /// \param options sampling options.
+    /// \return sweptPoints points at every sample, in the world frame.
+    /// \return largest distance from a point of the motion to the
+    /// closest sample (half the largest sample step).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type sampleSweptPoints (const polyhedron_t& points,
+				  const poses_t& poses,
+				  const SweptCapsuleOptions& options,
+				  polyhedron_t& sweptPoints);
+
+    /// \brief Fit a capsule containing the volume swept by a link along
+    /// a motion.
+    ///
+    /// Only the vertices of the convex hull of the link are moved, and
+    /// the capsule is fitted over the convex hull of the samples, so
+    /// the number of constraints stays small.
+    ///
+    /// \param polyhedrons polyhedrons of the link, in the link frame.
+    /// \param poses poses of the link (at least one).
+    /// \param options fitting options.
+    /// \return capsule parameters (see convertCapsuleToSolverParam) in
+    /// the world frame.
+    ROBOPTIM_CAPSULE_DLLAPI
+    argument_t fitSweptCapsule (const polyhedrons_t& polyhedrons,
+				const poses_t& poses,
+				const SweptCapsuleOptions& options
+				= SweptCapsuleOptions ());
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_SWEPT_CAPSULE_HH
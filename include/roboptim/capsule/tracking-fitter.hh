@@ -0,0 +1,148 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of TrackingFitter class that fits capsules to
+ * streams of point clouds.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_TRACKING_FITTER_HH
+# define ROBOPTIM_CAPSULE_TRACKING_FITTER_HH
+
+# include <string>
+# include <vector>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/point-cloud.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Subsample points with a spatial hash.
+    ///
+    /// Space is divided into cubic cells, and the first point of each
+    /// non-empty cell is kept. The grid is anchored at the bounding box
+    /// of the points. If more than maxPoints points remain, the cell
+    /// size is doubled until they fit, or until a single cell covers
+    /// the bounding box.
+    ///
+    /// \param points points to subsample.
+    /// \param cellSize initial cell size (positive).
+    /// \param maxPoints maximum number of points, 0 for no limit.
+    /// \return subsampled points.
+    /// \return cell size actually used.
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type subsamplePoints (polyhedron_t& subsampled,
+				const std::vector<point_t>& points,
+				value_type cellSize, size_t maxPoints);
+
+    /// \brief Capsule fitter for streams of similar point clouds.
+    ///
+    /// The fitter is built once and keeps its state between frames.
+    /// Each frame is:
+    ///
+    /// - subsampled with a spatial hash (see subsamplePoints), which
+    ///   bounds the problem size;
+    /// - fitted starting from the previous capsule, inflated to contain
+    ///   the new points (capsuleFromPoints is used for the first
+    ///   frame);
+    /// - checked against all its points: the radius is increased so
+    ///   that the capsule contains the whole frame, not only the
+    ///   subsampled points.
+    ///
+    /// By default, the solver is limited to 50 iterations and the only
+    /// fallback is HEURISTIC, so that the latency of a frame is
+    /// bounded. Both can be changed through fitter ().
+    class ROBOPTIM_CAPSULE_DLLAPI TrackingFitter
+    {
+    public:
+      /// \brief Constructor.
+      ///
+      /// \param solver nonlinear solver.
+      explicit TrackingFitter (std::string solver = "ipopt");
+
+      ~TrackingFitter ();
+
+      /// \brief Fitter used for each frame, e.g. to set its options.
+      Fitter& fitter ();
+      const Fitter& fitter () const;
+
+      /// \brief Cell size of the subsampling. Default is 0.01. If 0,
+      /// points are not subsampled.
+      value_type& cellSize ();
+      value_type cellSize () const;
+
+      /// \brief Maximum number of points given to the solver. Default
+      /// is 256. If 0, there is no limit.
+      size_t& maxPoints ();
+      size_t maxPoints () const;
+
+      /// \brief Fit the capsule of a new frame.
+      ///
+      /// \param points points of the frame (not empty).
+      /// \return capsule parameters (see convertCapsuleToSolverParam).
+      const argument_t& update (const std::vector<point_t>& points);
+      const argument_t& update (const PointsView<float>& points);
+      const argument_t& update (const PointsView<double>& points);
+
+      /// \brief Forget the previous frames.
+      void reset ();
+
+      /// \brief Get the capsule parameters of the last frame (empty
+      /// before the first frame).
+      const argument_t& capsule () const;
+
+      /// \brief Number of frames since construction or reset.
+      size_t frameCount () const;
+
+      /// \brief Points given to the solver for the last frame.
+      const polyhedron_t& subsampledPoints () const;
+
+    private:
+      /// \brief Fit the capsule of the current frame.
+      void fitFrame ();
+
+      /// \brief Fitter used for each frame.
+      Fitter fitter_;
+
+      /// \brief Cell size of the subsampling.
+      value_type cellSize_;
+
+      /// \brief Maximum number of points given to the solver.
+      size_t maxPoints_;
+
+      /// \brief Points of the current frame, in a one-element vector.
+      polyhedrons_t frame_;
+
+      /// \brief Subsampled points of the current frame.
+      polyhedrons_t subsampled_;
+
+      /// \brief Current capsule parameters.
+      argument_t capsule_;
+
+      /// \brief Number of frames.
+      size_t frameCount_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_TRACKING_FITTER_HH
@@ -19,6 +19,8 @@
 #ifndef ROBOPTIM_CAPSULE_FWD_HH_
 # define ROBOPTIM_CAPSULE_FWD_HH_
 
+# include <vector>
+
 # include <Eigen/Core>
 
 # include <roboptim/core/function.hh>
@@ -42,11 +44,26 @@ namespace roboptim
     /// \brief Import solver type.
     typedef roboptim::Solver<roboptim::EigenMatrixDense> solver_t;
 
+    /// \brief Import sparse solver type.
+    typedef roboptim::Solver<roboptim::EigenMatrixSparse> sparse_solver_t;
+
     /// \brief Define geometry types.
     typedef Eigen::Matrix<value_type,3,1>         point_t;
     typedef Eigen::Matrix<value_type,3,1>         vector3_t;
     typedef std::vector<point_t>                  polyhedron_t;
     typedef std::vector<polyhedron_t>             polyhedrons_t;
+
+    /// \brief Define single-precision geometry types, e.g. for stored
+    /// geometry. Optimization problems always use value_type.
+    typedef Eigen::Matrix<float,3,1>              pointf_t;
+    typedef std::vector<pointf_t>                 polyhedronf_t;
+
+    /// \brief Define planar geometry types.
+    typedef Eigen::Matrix<value_type,2,1>         point2_t;
+    typedef Eigen::Matrix<value_type,2,1>         vector2_t;
+    typedef std::vector<point2_t, Eigen::aligned_allocator<point2_t> >
+    polygon_t;
+    typedef std::vector<polygon_t>                polygons_t;
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
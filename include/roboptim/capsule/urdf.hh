@@ -0,0 +1,196 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \brief Declaration of UrdfModel class that reads the link geometries
+ * of a URDF robot description and replaces their collision geometries
+ * with capsules.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_URDF_HH
+# define ROBOPTIM_CAPSULE_URDF_HH
+
+# include <iosfwd>
+# include <map>
+# include <string>
+# include <vector>
+
+# include <boost/property_tree/ptree.hpp>
+
+# include <Eigen/Geometry>
+
+# include <roboptim/capsule/config.hh>
+# include <roboptim/capsule/types.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    /// \brief Map from ROS package names to their directories.
+    typedef std::map<std::string, std::string> packages_t;
+
+    /// \brief Geometry of a link, in the link frame.
+    struct ROBOPTIM_CAPSULE_DLLAPI UrdfGeometry
+    {
+      /// \brief Supported geometry types.
+      enum Type
+	{
+	  /// \brief Mesh file, read with readMeshPoints.
+	  MESH,
+	  /// \brief Box centered on its origin.
+	  BOX,
+	  /// \brief Cylinder centered on its origin, along its z axis.
+	  CYLINDER
+	};
+
+      /// \brief Geometry type.
+      Type type;
+
+      /// \brief Resolved mesh file name (MESH only).
+      std::string fileName;
+
+      /// \brief Mesh scale (MESH), box size (BOX), or radius and
+      /// length in the first two elements (CYLINDER).
+      vector3_t size;
+
+      /// \brief Pose of the geometry in the link frame.
+      Eigen::Isometry3d origin;
+
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    /// \brief Link of a URDF model with a supported geometry.
+    struct ROBOPTIM_CAPSULE_DLLAPI UrdfLink
+    {
+      /// \brief Link name.
+      std::string name;
+
+      /// \brief Geometries of the link: the collision geometries, or
+      /// the visual ones if there is no collision geometry.
+      std::vector<UrdfGeometry, Eigen::aligned_allocator<UrdfGeometry> >
+      geometries;
+    };
+
+    /// \brief Resolve a URDF mesh file name.
+    ///
+    /// Supported names are "package://<package>/<path>", where the
+    /// package directory is taken from the packages, or else searched
+    /// in the ROS_PACKAGE_PATH directories, "file://<path>" and plain
+    /// paths, relative to the URDF directory.
+    ///
+    /// Throws std::runtime_error if a package cannot be found.
+    ///
+    /// \param uri mesh file name in the URDF.
+    /// \param directory URDF directory.
+    /// \param packages package directories.
+    ROBOPTIM_CAPSULE_DLLAPI
+    std::string resolveUrdfPath (const std::string& uri,
+				 const std::string& directory,
+				 const packages_t& packages);
+
+    /// \brief Compute the points of the geometries of a link, in the
+    /// link frame.
+    ///
+    /// Mesh vertices are scaled and moved to the link frame. Boxes
+    /// contribute their corners, and cylinders the vertices of
+    /// circumscribed prisms, so that the convex hull of the points
+    /// contains the geometries.
+    ///
+    /// Throws std::runtime_error if a mesh cannot be read.
+    ///
+    /// \param link link.
+    /// \return points vector to which the points are appended.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void readLinkPoints (const UrdfLink& link, polyhedron_t& points);
+
+    /// \brief URDF robot description whose collision geometries can be
+    /// replaced by capsules.
+    ///
+    /// The whole document is kept, and only the collision elements of
+    /// the links with a capsule are rewritten.
+    class ROBOPTIM_CAPSULE_DLLAPI UrdfModel
+    {
+    public:
+      /// \brief Capsule representations in the written URDF.
+      enum CapsuleGeometry
+	{
+	  /// \brief A cylinder and two spheres, supported by all URDF
+	  /// parsers.
+	  CYLINDER_SPHERES,
+	  /// \brief Non-standard <capsule radius="" length=""/> geometry,
+	  /// with the conventions of cylinders (centered, along z).
+	  CAPSULE
+	};
+
+      /// \brief Read a URDF file.
+      ///
+      /// Throws std::runtime_error if the file cannot be parsed.
+      ///
+      /// \param fileName URDF file.
+      /// \param packages package directories (see resolveUrdfPath).
+      explicit UrdfModel (const std::string& fileName,
+			  const packages_t& packages = packages_t ());
+
+      /// \brief Read a URDF document from a stream.
+      ///
+      /// \param is input stream.
+      /// \param directory directory of relative mesh file names.
+      /// \param packages package directories (see resolveUrdfPath).
+      UrdfModel (std::istream& is, const std::string& directory,
+		 const packages_t& packages = packages_t ());
+
+      /// \brief Get the robot name.
+      std::string name () const;
+
+      /// \brief Get the links that have a supported geometry.
+      const std::vector<UrdfLink>& links () const;
+
+      /// \brief Set the capsule of a link.
+      ///
+      /// \param link link index in links().
+      /// \param capsuleParam capsule parameters in the link frame (see
+      /// convertCapsuleToSolverParam).
+      void setCapsule (size_t link, const_argument_ref capsuleParam);
+
+      /// \brief Write the URDF, where the collision geometries of the
+      /// links with a capsule are replaced by the capsule.
+      ///
+      /// \param os output stream.
+      /// \param geometry capsule representation.
+      void write (std::ostream& os,
+		  CapsuleGeometry geometry = CYLINDER_SPHERES) const;
+
+    private:
+      /// \brief Parse the document and find the link geometries.
+      void parse (std::istream& is, const std::string& directory,
+		  const packages_t& packages);
+
+      /// \brief URDF document.
+      boost::property_tree::ptree tree_;
+
+      /// \brief Links with a supported geometry.
+      std::vector<UrdfLink> links_;
+
+      /// \brief Capsules of the links (empty if not set).
+      std::vector<argument_t> capsules_;
+    };
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_URDF_HH
@@ -22,12 +22,15 @@
 # include <iostream>
 # include <set>
 # include <limits>
+# include <string>
 
 # include <boost/foreach.hpp>
 
 # include <roboptim/capsule/config.hh>
 # include <roboptim/capsule/fwd.hh>
 # include <roboptim/capsule/types.hh>
+# include <roboptim/capsule/geometry.hh>
+# include <roboptim/capsule/point-cloud.hh>
 # include <roboptim/capsule/qhull.hh>
 
 namespace roboptim
@@ -35,26 +38,32 @@ namespace roboptim
   namespace capsule
   {
 
+    /// \brief Capsule with the scalar type of the optimization problems.
+    ///
+    /// Capsule used to be a class of its own: code that names it in
+    /// exported signatures must be rebuilt.
+    typedef GenericCapsule<value_type> Capsule;
+
+    /// \brief Single-precision capsule, e.g. for stored geometry.
+    typedef GenericCapsule<float> Capsulef;
+
     /// Creates a convex hull from a set of points.
     ROBOPTIM_CAPSULE_DLLAPI
     polyhedron_t convexHullFromPoints (const std::vector<point_t>& points);
 
-    /// \brief Structure containing Capsule data (start point, end point and
-    // radius).
-    struct ROBOPTIM_CAPSULE_DLLAPI Capsule
-    {
-      point_t P0, P1;
-      value_type radius;
-
-      Capsule ()
-	: P0 (0., 0., 0.),
-	  P1 (0., 0., 0.),
-	  radius (0.)
-      {}
-    };
+    /// Creates a convex hull from a view of packed points (e.g. a
+    /// mapped PointCloudFile).
+    ROBOPTIM_CAPSULE_DLLAPI
+    polyhedron_t convexHullFromPoints (const PointsView<float>& points);
+    ROBOPTIM_CAPSULE_DLLAPI
+    polyhedron_t convexHullFromPoints (const PointsView<double>& points);
 
     /// \brief Compute the distance from point p to segment [a,b].
     ///
+    /// The double overloads below are exported by the library. Hot
+    /// loops should call the inline templates of geometry.hh instead,
+    /// e.g. distancePointToSegment<value_type>.
+    ///
     /// \param p point.
     /// \param a start point of segment.
     /// \param b end point of segment.
@@ -77,6 +86,19 @@ namespace roboptim
                                  const point_t& a,
                                  const point_t& b);
 
+    /// \brief Compute the parameter of the projection of point p on
+    /// segment [a,b].
+    ///
+    /// \param p point.
+    /// \param a start point of segment.
+    /// \param b end point of segment.
+    ///
+    /// \return t in [0,1] such that the projection is a + t (b - a).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type projectionParameterOnSegment (const point_t& p,
+                                             const point_t& a,
+                                             const point_t& b);
+
     /// \brief Distance from a point to a line described as a point and a
     // direction.
     ROBOPTIM_CAPSULE_DLLAPI
@@ -84,10 +106,76 @@ namespace roboptim
                                     const point_t& linePoint,
                                     const vector3_t& dir);
 
+    /// \brief Compute the largest distance from points to a segment.
+    ///
+    /// Batch kernel for containment checks: squared distances are
+    /// compared, and a single square root is computed.
+    ///
+    /// \param polyhedrons polyhedrons containing the points.
+    /// \param a segment first end point.
+    /// \param b segment second end point.
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type maxDistanceToSegment (const polyhedrons_t& polyhedrons,
+				     const point_t& a, const point_t& b);
+
+    /// \brief Increase the radius of a capsule so that it contains
+    /// points.
+    ///
+    /// The radius is set to the largest distance from the points to the
+    /// segment, slightly increased to absorb the rounding errors of the
+    /// distance computation, if it is larger than the current radius.
+    /// Since capsules are convex, the vertices of a convex hull are
+    /// enough to guarantee that the hull is contained.
+    ///
+    /// \param capsuleParam capsule parameters (see
+    /// convertCapsuleToSolverParam), updated.
+    /// \param polyhedrons polyhedrons containing the points.
+    /// \return radius increase (0 if all points were contained).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type inflateToContain (argument_ref capsuleParam,
+				 const polyhedrons_t& polyhedrons);
+
+    /// \brief Compute the shortest capsule with a given axis line that
+    /// contains points.
+    ///
+    /// The radius is the largest distance from the points to the line.
+    /// For this radius, each point bounds the end points: they are
+    /// placed exactly, so that the segment is as short as possible.
+    ///
+    /// \param polyhedrons polyhedrons containing the points.
+    /// \param linePoint point of the axis line.
+    /// \param direction direction of the axis line (non-zero).
+    /// \return capsuleParam capsule parameters (see
+    /// convertCapsuleToSolverParam).
+    ROBOPTIM_CAPSULE_DLLAPI
+    void fitCapsuleAlongAxis (argument_ref capsuleParam,
+			      const polyhedrons_t& polyhedrons,
+			      const point_t& linePoint,
+			      const vector3_t& direction);
+
+    /// \brief Compute the volume of a capsule.
+    ///
+    /// \param param capsule parameters (see convertCapsuleToSolverParam).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type capsuleVolume (const_argument_ref param);
+
     /// \brief Compute the covariance matrix of a set of points.
     ROBOPTIM_CAPSULE_DLLAPI
     Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points);
 
+    /// \brief Compute the covariance matrix of a set of points with
+    /// several threads.
+    ///
+    /// Sums are computed over fixed chunks of points, combined
+    /// pairwise: the result is bitwise identical for any number of
+    /// threads.
+    ///
+    /// \param points points.
+    /// \param jobs number of threads.
+    ROBOPTIM_CAPSULE_DLLAPI
+    Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points,
+				      size_t jobs);
+
     // Returns indices imin and imax into pt[] array of the least and
     // most, respectively, distant points along the direction dir
     ROBOPTIM_CAPSULE_DLLAPI
@@ -95,15 +183,52 @@ namespace roboptim
                                       const std::vector<point_t>& points,
                                       int& imin, int& imax);
 
+    // Same with several threads (jobs). Ties give the first point, for
+    // any number of threads.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void extremePointsAlongDirection (vector3_t dir,
+                                      const std::vector<point_t>& points,
+                                      int& imin, int& imax,
+				      size_t jobs);
+
     /// Computes a capsule from a set of points.
     /// The algorithm currently used relies on the search of the largest spread
-    /// direction (PCA).
-    /// TODO: Optimize computation speed.
-    /// Spheres on both ends do not contain any point yet, cylinder length
-    /// could be shortened to have a better fit.
+    /// direction (PCA), through the average point.
+    /// The radius is the largest distance to this axis, and the end points
+    /// are then as close as possible: the result does not depend on the
+    /// order of the points.
     ROBOPTIM_CAPSULE_DLLAPI
     Capsule capsuleFromPoints (const std::vector<point_t>& points);
 
+    /// Same with several threads: the passes over the points use jobs
+    /// threads, with the same result for any number of threads (see
+    /// covarianceMatrix).
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsule capsuleFromPoints (const std::vector<point_t>& points,
+			       size_t jobs);
+
+    /// Computes a capsule from a view of packed points (e.g. a mapped
+    /// PointCloudFile), without copying them.
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsule capsuleFromPoints (const PointsView<float>& points);
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsule capsuleFromPoints (const PointsView<float>& points,
+			       size_t jobs);
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsule capsuleFromPoints (const PointsView<double>& points);
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsule capsuleFromPoints (const PointsView<double>& points,
+			       size_t jobs);
+
+    /// Computes a single-precision capsule from single-precision
+    /// points. Sums are accumulated in double, as for a
+    /// PointsView<float>.
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsulef capsuleFromPoints (const std::vector<pointf_t>& points);
+    ROBOPTIM_CAPSULE_DLLAPI
+    Capsulef capsuleFromPoints (const std::vector<pointf_t>& points,
+				size_t jobs);
+
     /// \brief Convert Capsule parameters to RobOptim solver
     /// parameters vector.
     ///
@@ -147,6 +272,60 @@ namespace roboptim
     convertPolyhedronVectorToPolyhedron (polyhedron_t& polyhedron,
 					 const polyhedrons_t& polyhedrons);
 
+    /// \brief Count the points of a polyhedron vector.
+    ///
+    /// \param polyhedrons polyhedron vector.
+    ///
+    /// \return total number of points.
+    ROBOPTIM_CAPSULE_DLLAPI
+    size_t countPoints (const polyhedrons_t& polyhedrons);
+
+    /// \brief Identity of a point of a polyhedron vector.
+    ///
+    /// Constraints of all the formulations follow the order of the
+    /// points in the polyhedron vector, so that constraint i is the
+    /// point of global index i (see pointIdFromIndex).
+    struct ROBOPTIM_CAPSULE_DLLAPI PointId
+    {
+      /// \brief Index of the polyhedron.
+      size_t polyhedron;
+
+      /// \brief Index of the point in the polyhedron.
+      size_t point;
+    };
+
+    /// \brief Get the identity of a point from its global index.
+    ///
+    /// \param polyhedrons polyhedron vector.
+    /// \param index global index, in [0, countPoints (polyhedrons)).
+    ROBOPTIM_CAPSULE_DLLAPI
+    PointId pointIdFromIndex (const polyhedrons_t& polyhedrons, size_t index);
+
+    /// \brief Get the global index of a point from its identity.
+    ROBOPTIM_CAPSULE_DLLAPI
+    size_t indexFromPointId (const polyhedrons_t& polyhedrons,
+			     const PointId& id);
+
+    /// \brief Find points in a polyhedron vector.
+    ///
+    /// Points are compared exactly, e.g. vertices of
+    /// computeConvexPolyhedron, which are copies of its input points.
+    ///
+    /// \param points points to find.
+    /// \param polyhedrons polyhedron vector.
+    /// \return ids identity of the first identical point of the
+    /// polyhedron vector, for each point. The polyhedron index is
+    /// polyhedrons.size () if there is none.
+    ROBOPTIM_CAPSULE_DLLAPI
+    void matchPoints (std::vector<PointId>& ids,
+		      const polyhedron_t& points,
+		      const polyhedrons_t& polyhedrons);
+
+    /// \brief Name of the distance constraint of a point, e.g.
+    /// "distance to point 3 of polyhedron 1".
+    ROBOPTIM_CAPSULE_DLLAPI
+    std::string constraintName (const PointId& id);
+
     /// \brief Compute bounding capsule of a vector of polyhedrons.
     ///
     /// Compute axis of capsule segment using least-squares fit. Radius
@@ -180,6 +359,98 @@ namespace roboptim
     computeConvexPolyhedron (const polyhedrons_t& polyhedrons,
 			     polyhedrons_t& convexPolyhedrons);
 
+    /// \brief Structure containing stadium data, i.e. a planar capsule
+    /// (start point, end point and radius).
+    struct ROBOPTIM_CAPSULE_DLLAPI Stadium
+    {
+      point2_t P0, P1;
+      value_type radius;
+
+      Stadium ()
+	: P0 (0., 0.),
+	  P1 (0., 0.),
+	  radius (0.)
+      {}
+
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    };
+
+    /// \brief Compute the distance from planar point p to segment
+    /// [a,b].
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type distancePointToSegment (const point2_t& p,
+                                       const point2_t& a,
+                                       const point2_t& b);
+
+    /// \brief Compute the parameter of the projection of planar point
+    /// p on segment [a,b].
+    ///
+    /// \return t in [0,1] such that the projection is a + t (b - a).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type projectionParameterOnSegment (const point2_t& p,
+                                             const point2_t& a,
+                                             const point2_t& b);
+
+    /// \brief Creates a convex polygon from a set of planar points.
+    ///
+    /// Vertices are given counter-clockwise, without collinear points,
+    /// and are copies of input points. No qhull call is needed.
+    ROBOPTIM_CAPSULE_DLLAPI
+    polygon_t convexHullFromPoints (const polygon_t& points);
+
+    /// \brief Count the points of a polygon vector.
+    ROBOPTIM_CAPSULE_DLLAPI
+    size_t countPoints (const polygons_t& polygons);
+
+    /// \brief Compute the convex polygon over a vector of polygons,
+    /// and store it in a one-element vector.
+    ROBOPTIM_CAPSULE_DLLAPI void
+    computeConvexPolygon (const polygons_t& polygons,
+			  polygons_t& convexPolygons);
+
+    /// Computes a stadium from a set of planar points, as
+    /// capsuleFromPoints: the axis is the largest spread direction
+    /// through the average point, the radius is the largest distance to
+    /// this axis, and the end points are as close as possible.
+    ROBOPTIM_CAPSULE_DLLAPI
+    Stadium stadiumFromPoints (const polygon_t& points);
+
+    /// \brief Compute the area of a stadium.
+    ///
+    /// \param param stadium parameters (see convertStadiumToSolverParam).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type stadiumArea (const_argument_ref param);
+
+    /// \brief Increase the radius of a stadium so that it contains
+    /// planar points (see inflateToContain for capsules).
+    ///
+    /// \param stadiumParam stadium parameters, updated.
+    /// \param polygons polygons containing the points.
+    /// \return radius increase (0 if all points were contained).
+    ROBOPTIM_CAPSULE_DLLAPI
+    value_type inflateToContain (argument_ref stadiumParam,
+				 const polygons_t& polygons);
+
+    /// \brief Convert Stadium parameters to RobOptim solver
+    /// parameters vector.
+    ///
+    /// \return dst parameters vector containing, in this order, the
+    /// first end point coordinates, the second end point coordinates
+    /// and the radius (5 elements).
+    ROBOPTIM_CAPSULE_DLLAPI
+    void convertStadiumToSolverParam (argument_ref dst,
+				      const point2_t& endPoint1,
+				      const point2_t& endPoint2,
+				      const value_type& radius);
+
+    /// \brief Convert RobOptim solver parameters vector to Stadium
+    /// parameters (see convertStadiumToSolverParam).
+    ROBOPTIM_CAPSULE_DLLAPI
+    void convertSolverParamToStadium (point2_t& endPoint1,
+				      point2_t& endPoint2,
+				      value_type& radius,
+				      const_argument_ref src);
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
@@ -24,7 +24,7 @@
 #ifndef ROBOPTIM_CAPSULE_VOLUME_HH
 # define ROBOPTIM_CAPSULE_VOLUME_HH
 
-# include <roboptim/core/differentiable-function.hh>
+# include <roboptim/core/twice-differentiable-function.hh>
 
 # include "roboptim/capsule/config.hh"
 # include "roboptim/capsule/types.hh"
@@ -36,15 +36,40 @@ namespace roboptim
     /// \brief Capsule volume function.
     ///
     /// This class computes the volume of a capsule defined by a
-    /// segment and a radius.
-    class ROBOPTIM_CAPSULE_DLLAPI Volume
-      : public roboptim::DifferentiableFunction
+    /// segment and a radius, as well as its gradient and Hessian.
+    ///
+    /// \tparam T matrix type (EigenMatrixDense or EigenMatrixSparse).
+    template <typename T>
+    class ROBOPTIM_CAPSULE_DLLAPI GenericVolume
+      : public roboptim::GenericTwiceDifferentiableFunction<T>
     {
     public:
+      ROBOPTIM_TWICE_DIFFERENTIABLE_FUNCTION_FWD_TYPEDEFS_
+      (GenericTwiceDifferentiableFunction<T>);
+
       /// \brief Constructor.
-      Volume (std::string name = "capsule volume");
+      GenericVolume (std::string name = "capsule volume");
+
+      /// \brief Constructor for problems with auxiliary variables or
+      /// a smoothed length.
+      ///
+      /// \param inputSize size of the optimization vector. The capsule
+      /// parameters are its first 7 elements, the other variables do
+      /// not appear in the volume.
+      /// \param lengthSmoothing smoothing parameter \f$\epsilon\f$
+      /// of the segment length, which becomes
+      /// \f$\sqrt{\|e_1 - e_2\|^2 + \epsilon^2} - \epsilon\f$. For
+      /// \f$\epsilon > 0\f$, the volume is smooth even for zero-length
+      /// segments (spherical capsules), and the length error is lower
+      /// than \f$\epsilon\f$.
+      GenericVolume (size_type inputSize,
+		     std::string name = "capsule volume",
+		     value_type lengthSmoothing = 0.);
 
-      ~Volume ();
+      ~GenericVolume ();
+
+      /// \brief Get length smoothing parameter.
+      value_type lengthSmoothing () const;
 
     protected:
       /// \brief Compute the volume of the capsule.
@@ -59,12 +84,39 @@ namespace roboptim
 
       /// \brief Compute gradient of the capsule volume with respect
       /// to the argument vector.
+      ///
+      /// Without smoothing, the gradient with respect to the end
+      /// points is not defined for zero-length segments, and the null
+      /// subgradient is used.
       virtual void
       impl_gradient (gradient_ref gradient,
 		     const_argument_ref argument,
 		     size_type functionId = 0) const;
+
+      /// \brief Compute Hessian of the capsule volume with respect
+      /// to the argument vector.
+      ///
+      /// With \f$d = e_1 - e_2\f$, \f$L = \|d\|\f$ and
+      /// \f$u = d / L\f$, the non-zero blocks are
+      /// \f$\pm \frac{\pi r^2}{L} (I - u u^T)\f$ for the end points,
+      /// \f$\pm 2 \pi r u\f$ for the end points and the radius, and
+      /// \f$2 \pi L + 8 \pi r\f$ for the radius.
+      virtual void
+      impl_hessian (hessian_ref hessian,
+		    const_argument_ref argument,
+		    size_type functionId = 0) const;
+
+    private:
+      /// \brief Length smoothing parameter.
+      value_type lengthSmoothing_;
     };
 
+    /// \brief Capsule volume function using dense matrices.
+    typedef GenericVolume<EigenMatrixDense> Volume;
+
+    /// \brief Capsule volume function using sparse matrices.
+    typedef GenericVolume<EigenMatrixSparse> SparseVolume;
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
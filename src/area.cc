@@ -0,0 +1,170 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/area.cc
+ *
+ * \brief Implementation of GenericArea.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AREA_CC_
+# define ROBOPTIM_CAPSULE_AREA_CC_
+
+# include <math.h>
+
+# include <roboptim/capsule/area.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 5, 5> stadiumHessian_t;
+
+      /// \brief Hessian of the area with respect to the stadium
+      /// parameters.
+      void areaHessian (stadiumHessian_t& hessian,
+			const_argument_ref argument)
+      {
+	vector2_t d = argument.segment<2> (0) - argument.segment<2> (2);
+	value_type length = d.norm ();
+	value_type r = argument[4];
+
+	hessian.setZero ();
+
+	// The end point blocks are not defined for zero-length
+	// segments: they are left null.
+	if (length > 0.)
+	  {
+	    vector2_t u = d / length;
+	    Eigen::Matrix2d endPointBlock = 2. * r / length
+	      * (Eigen::Matrix2d::Identity () - u * u.transpose ());
+
+	    hessian.block<2,2> (0, 0) = endPointBlock;
+	    hessian.block<2,2> (2, 2) = endPointBlock;
+	    hessian.block<2,2> (0, 2) = -endPointBlock;
+	    hessian.block<2,2> (2, 0) = -endPointBlock;
+
+	    hessian.block<2,1> (0, 4) = 2. * u;
+	    hessian.block<2,1> (2, 4) = -2. * u;
+	    hessian.block<1,2> (4, 0) = hessian.block<2,1> (0, 4).transpose ();
+	    hessian.block<1,2> (4, 2) = hessian.block<2,1> (2, 4).transpose ();
+	  }
+
+	hessian (4, 4) = 2. * M_PI;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericArea<T>::
+    GenericArea (std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T> (5, 1, name)
+    {
+    }
+
+    template <typename T>
+    GenericArea<T>::
+    ~GenericArea ()
+    {
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericArea<T>::
+    impl_compute (result_ref result, const_argument_ref argument) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      value_type length = (point2_t (argument[0], argument[1])
+			   - point2_t (argument[2], argument[3])).norm ();
+
+      result[0] = argument[4] * (2. * length + M_PI * argument[4]);
+    }
+
+    template <typename T>
+    void GenericArea<T>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      gradient.setZero ();
+
+      vector2_t d (argument[0] - argument[2], argument[1] - argument[3]);
+      value_type length = d.norm ();
+
+      if (length > 0.)
+	for (size_type i = 0; i < 2; ++i)
+	  {
+	    gradient.coeffRef (i) = 2. * argument[4] * d[i] / length;
+	    gradient.coeffRef (2 + i) = -2. * argument[4] * d[i] / length;
+	  }
+
+      gradient.coeffRef (4) = 2. * length + 2. * M_PI * argument[4];
+    }
+
+    template <>
+    void GenericArea<EigenMatrixDense>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      stadiumHessian_t h;
+      areaHessian (h, argument);
+      hessian = h;
+    }
+
+    template <>
+    void GenericArea<EigenMatrixSparse>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      stadiumHessian_t h;
+      areaHessian (h, argument);
+
+      // The whole 5x5 block is stored to keep a constant structure.
+      hessian.resize (5, 5);
+      hessian.setZero ();
+      hessian.reserve (25);
+      for (size_type i = 0; i < 5; ++i)
+	for (size_type j = 0; j < 5; ++j)
+	  hessian.insert (i, j) = h (i, j);
+      hessian.makeCompressed ();
+    }
+
+    // Explicit template instantiations.
+    template class GenericArea<EigenMatrixDense>;
+    template class GenericArea<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AREA_CC_
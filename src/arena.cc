@@ -0,0 +1,157 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/arena.cc
+ *
+ * \brief Implementation of Arena.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_ARENA_CC_
+# define ROBOPTIM_CAPSULE_ARENA_CC_
+
+# include <algorithm>
+# include <cassert>
+
+# include <boost/thread/tss.hpp>
+
+# include <roboptim/capsule/arena.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Arenas of the threads.
+      boost::thread_specific_ptr<Arena> threadArenas;
+
+      /// \brief Offset of the first aligned address of a block after
+      /// an offset.
+      inline size_t alignedOffset (const char* data, size_t offset,
+				   size_t alignment)
+      {
+	size_t address = reinterpret_cast<size_t> (data + offset);
+	return offset + ((alignment - address % alignment) % alignment);
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    Arena::
+    Arena (size_t blockSize)
+      : blockSize_ (blockSize),
+	blocks_ ()
+    {
+      assert (blockSize > 0 && "Invalid block size.");
+      current_.block = 0;
+      current_.offset = 0;
+    }
+
+    Arena::
+    ~Arena ()
+    {
+      release ();
+    }
+
+    void* Arena::
+    allocate (size_t size, size_t alignment)
+    {
+      assert (alignment > 0 && (alignment & (alignment - 1)) == 0
+	      && "Alignment must be a power of 2.");
+
+      while (current_.block < blocks_.size ())
+	{
+	  Block& block = blocks_[current_.block];
+	  size_t offset = alignedOffset (block.data, current_.offset,
+					 alignment);
+	  if (offset + size <= block.size)
+	    {
+	      current_.offset = offset + size;
+	      return block.data + offset;
+	    }
+
+	  // Try the next block, kept from a previous use.
+	  ++current_.block;
+	  current_.offset = 0;
+	}
+
+      // The new block is large enough whatever its alignment.
+      Block block;
+      block.size = std::max (blockSize_, size + alignment);
+      block.data = static_cast<char*> (::operator new (block.size));
+      blocks_.push_back (block);
+
+      current_.block = blocks_.size () - 1;
+      current_.offset = 0;
+      return allocate (size, alignment);
+    }
+
+    Arena::Marker Arena::
+    mark () const
+    {
+      return current_;
+    }
+
+    void Arena::
+    rewind (const Marker& marker)
+    {
+      assert ((marker.block < current_.block
+	       || (marker.block == current_.block
+		   && marker.offset <= current_.offset))
+	      && "Arena scopes must be nested.");
+      current_ = marker;
+    }
+
+    void Arena::
+    reset ()
+    {
+      current_.block = 0;
+      current_.offset = 0;
+    }
+
+    void Arena::
+    release ()
+    {
+      for (size_t i = 0; i < blocks_.size (); ++i)
+	::operator delete (blocks_[i].data);
+      blocks_.clear ();
+      reset ();
+    }
+
+    size_t Arena::
+    capacity () const
+    {
+      size_t capacity = 0;
+      for (size_t i = 0; i < blocks_.size (); ++i)
+	capacity += blocks_[i].size;
+      return capacity;
+    }
+
+    Arena& threadArena ()
+    {
+      if (!threadArenas.get ())
+	threadArenas.reset (new Arena ());
+      return *threadArenas;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_ARENA_CC_
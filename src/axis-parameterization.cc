@@ -0,0 +1,143 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/axis-parameterization.cc
+ *
+ * \brief Implementation of AxisParameterization.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_CC_
+# define ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_CC_
+
+# include <cmath>
+
+# include <roboptim/capsule/axis-parameterization.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    AxisParameterization::
+    AxisParameterization (const vector3_t& referenceDirection)
+    {
+      vector3_t x = vector3_t::UnitX ();
+      if (referenceDirection.norm () > 1e-6)
+	x = referenceDirection.normalized ();
+
+      frame_.col (0) = x;
+      frame_.col (1) = x.unitOrthogonal ();
+      frame_.col (2) = x.cross (frame_.col (1));
+    }
+
+    const Eigen::Matrix3d& AxisParameterization::
+    frame () const
+    {
+      return frame_;
+    }
+
+    vector3_t AxisParameterization::
+    direction (value_type alpha, value_type beta) const
+    {
+      return frame_ * vector3_t (std::cos (alpha) * std::cos (beta),
+				 std::sin (alpha) * std::cos (beta),
+				 std::sin (beta));
+    }
+
+    void AxisParameterization::
+    toEndPoints (argument_ref dst, const_argument_ref src) const
+    {
+      assert (src.size () == 7 && "Incorrect src size, expected 7.");
+      assert (dst.size () == 7 && "Incorrect dst size, expected 7.");
+
+      point_t center = src.segment<3> (0);
+      vector3_t u = direction (src[3], src[4]);
+
+      dst.segment<3> (0) = center - src[5] * u;
+      dst.segment<3> (3) = center + src[5] * u;
+      dst[6] = src[6];
+    }
+
+    void AxisParameterization::
+    fromEndPoints (argument_ref dst, const_argument_ref src) const
+    {
+      assert (src.size () == 7 && "Incorrect src size, expected 7.");
+      assert (dst.size () == 7 && "Incorrect dst size, expected 7.");
+
+      point_t endPoint1 = src.segment<3> (0);
+      point_t endPoint2 = src.segment<3> (3);
+      vector3_t axis = endPoint2 - endPoint1;
+      value_type length = axis.norm ();
+
+      dst.segment<3> (0) = 0.5 * (endPoint1 + endPoint2);
+      dst[3] = 0.;
+      dst[4] = 0.;
+
+      // Any direction is valid for a zero-length segment.
+      if (length > 0.)
+	{
+	  vector3_t v = frame_.transpose () * axis / length;
+	  dst[3] = std::atan2 (v[1], v[0]);
+	  dst[4] = std::asin (std::max (-1., std::min (1., v[2])));
+	}
+
+      dst[5] = 0.5 * length;
+      dst[6] = src[6];
+    }
+
+    void AxisParameterization::
+    jacobian (jacobian_t& jacobian, const_argument_ref src) const
+    {
+      assert (src.size () == 7 && "Incorrect src size, expected 7.");
+
+      value_type alpha = src[3];
+      value_type beta = src[4];
+      value_type h = src[5];
+
+      vector3_t u = direction (alpha, beta);
+      vector3_t uAlpha = frame_ * vector3_t (-std::sin (alpha) * std::cos (beta),
+					     std::cos (alpha) * std::cos (beta),
+					     0.);
+      vector3_t uBeta = frame_ * vector3_t (-std::cos (alpha) * std::sin (beta),
+					    -std::sin (alpha) * std::sin (beta),
+					    std::cos (beta));
+
+      jacobian.setZero ();
+
+      // e1 = c - h u
+      jacobian.block<3,3> (0, 0).setIdentity ();
+      jacobian.block<3,1> (0, 3) = -h * uAlpha;
+      jacobian.block<3,1> (0, 4) = -h * uBeta;
+      jacobian.block<3,1> (0, 5) = -u;
+
+      // e2 = c + h u
+      jacobian.block<3,3> (3, 0).setIdentity ();
+      jacobian.block<3,1> (3, 3) = h * uAlpha;
+      jacobian.block<3,1> (3, 4) = h * uBeta;
+      jacobian.block<3,1> (3, 5) = u;
+
+      // Radius.
+      jacobian (6, 6) = 1.;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_PARAMETERIZATION_CC_
@@ -0,0 +1,222 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/axis-parameterized-function.cc
+ *
+ * \brief Implementation of GenericAxisParameterizedFunction.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_CC_
+# define ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_CC_
+
+# include <vector>
+
+# include <roboptim/capsule/arena.hh>
+# include <roboptim/capsule/axis-parameterized-function.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericAxisParameterizedFunction<T>::
+    GenericAxisParameterizedFunction
+    (boost::shared_ptr<const function_t> function,
+     const AxisParameterization& parameterization)
+      : roboptim::GenericDifferentiableFunction<T>
+	(function->inputSize (), function->outputSize (),
+	 function->getName () + " (axis)"),
+	function_ (function),
+	parameterization_ (parameterization)
+    {
+      assert (function->inputSize () >= 7
+	      && "Wrong input size, expected at least 7.");
+    }
+
+    template <typename T>
+    GenericAxisParameterizedFunction<T>::
+    ~GenericAxisParameterizedFunction ()
+    {
+    }
+
+    template <typename T>
+    const typename GenericAxisParameterizedFunction<T>::function_t&
+    GenericAxisParameterizedFunction<T>::
+    function () const
+    {
+      return *function_;
+    }
+
+    template <typename T>
+    const AxisParameterization& GenericAxisParameterizedFunction<T>::
+    parameterization () const
+    {
+      return parameterization_;
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericAxisParameterizedFunction<T>::
+    impl_compute (result_ref result,
+		  const_argument_ref argument) const
+    {
+      argument_t x (this->inputSize ());
+      endPointArgument (x, argument);
+      (*function_) (result, x);
+    }
+
+    template <>
+    void GenericAxisParameterizedFunction<EigenMatrixDense>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      argument_t x (inputSize ());
+      endPointArgument (x, argument);
+
+      AxisParameterization::jacobian_t J;
+      parameterization_.jacobian (J, argument.head (7));
+
+      function_->gradient (gradient, x, functionId);
+      gradient.head (7) = J.transpose () * gradient.head (7);
+    }
+
+    template <>
+    void GenericAxisParameterizedFunction<EigenMatrixSparse>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      argument_t x (inputSize ());
+      endPointArgument (x, argument);
+
+      AxisParameterization::jacobian_t J;
+      parameterization_.jacobian (J, argument.head (7));
+
+      gradient_t g (inputSize ());
+      function_->gradient (g, x, functionId);
+
+      // The 7 capsule parameters are always stored (the chain rule
+      // mixes them), other elements keep the wrapped structure.
+      Eigen::Matrix<value_type, 7, 1> head = Eigen::Matrix<value_type, 7, 1>::Zero ();
+      for (gradient_t::InnerIterator it (g); it; ++it)
+	if (it.index () < 7)
+	  head[it.index ()] = it.value ();
+      head = J.transpose () * head;
+
+      gradient.setZero ();
+      gradient.reserve (g.nonZeros () + 7);
+      for (size_type j = 0; j < 7; ++j)
+	gradient.insert (j) = head[j];
+      for (gradient_t::InnerIterator it (g); it; ++it)
+	if (it.index () >= 7)
+	  gradient.insert (it.index ()) = it.value ();
+    }
+
+    template <>
+    void GenericAxisParameterizedFunction<EigenMatrixDense>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      argument_t x (inputSize ());
+      endPointArgument (x, argument);
+
+      AxisParameterization::jacobian_t J;
+      parameterization_.jacobian (J, argument.head (7));
+
+      function_->jacobian (jacobian, x);
+      matrix_t head = jacobian.leftCols (7) * J;
+      jacobian.leftCols (7) = head;
+    }
+
+    template <>
+    void GenericAxisParameterizedFunction<EigenMatrixSparse>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      argument_t x (inputSize ());
+      endPointArgument (x, argument);
+
+      AxisParameterization::jacobian_t J;
+      parameterization_.jacobian (J, argument.head (7));
+
+      jacobian_t inner (outputSize (), inputSize ());
+      function_->jacobian (inner, x);
+
+      // The chain rule is applied row by row: the wrapped Jacobian is
+      // copied to row-major storage, whatever ROBOPTIM_STORAGE_ORDER
+      // is.
+      typedef Eigen::SparseMatrix<value_type, Eigen::RowMajor> rowMajor_t;
+      rowMajor_t rows (inner);
+
+      // The triplets only live during the evaluation.
+      ArenaScope scope;
+      typedef Eigen::Triplet<value_type> triplet_t;
+      std::vector<triplet_t, ArenaAllocator<triplet_t> >
+	triplets (ArenaAllocator<triplet_t> (scope.arena ()));
+      triplets.reserve (static_cast<size_t> (rows.nonZeros ()
+					     + 7 * outputSize ()));
+
+      Eigen::Matrix<value_type, 1, 7> head;
+      for (size_type i = 0; i < outputSize (); ++i)
+	{
+	  head.setZero ();
+	  for (rowMajor_t::InnerIterator it (rows, i); it; ++it)
+	    if (it.col () < 7)
+	      head[it.col ()] = it.value ();
+	  head = head * J;
+
+	  for (size_type j = 0; j < 7; ++j)
+	    triplets.push_back (triplet_t (i, j, head[j]));
+	  for (rowMajor_t::InnerIterator it (rows, i); it; ++it)
+	    if (it.col () >= 7)
+	      triplets.push_back (triplet_t (i, it.col (), it.value ()));
+	}
+
+      jacobian.resize (outputSize (), inputSize ());
+      jacobian.setFromTriplets (triplets.begin (), triplets.end ());
+      jacobian.makeCompressed ();
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    template <typename T>
+    void GenericAxisParameterizedFunction<T>::
+    endPointArgument (argument_ref dst, const_argument_ref argument) const
+    {
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
+
+      dst = argument;
+      argument_t endPoints (7);
+      parameterization_.toEndPoints (endPoints, argument.head (7));
+      dst.head (7) = endPoints;
+    }
+
+    // Explicit template instantiations.
+    template class GenericAxisParameterizedFunction<EigenMatrixDense>;
+    template class GenericAxisParameterizedFunction<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_PARAMETERIZED_FUNCTION_CC_
@@ -0,0 +1,132 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/axis-volume.cc
+ *
+ * \brief Implementation of GenericAxisVolume.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_AXIS_VOLUME_CC_
+# define ROBOPTIM_CAPSULE_AXIS_VOLUME_CC_
+
+# include <math.h>
+
+# include <roboptim/capsule/axis-volume.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericAxisVolume<T>::
+    GenericAxisVolume (size_type inputSize, std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T> (inputSize, 1, name)
+    {
+      assert (inputSize >= 7 && "Wrong input size, expected at least 7.");
+    }
+
+    template <typename T>
+    GenericAxisVolume<T>::
+    ~GenericAxisVolume ()
+    {
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericAxisVolume<T>::
+    impl_compute (result_ref result, const_argument_ref argument) const
+    {
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
+
+      value_type h = argument[5];
+      value_type r = argument[6];
+
+      result[0] = 2. * h * M_PI * r * r + 4. / 3. * M_PI * r * r * r;
+    }
+
+    template <typename T>
+    void GenericAxisVolume<T>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
+
+      value_type h = argument[5];
+      value_type r = argument[6];
+
+      gradient.setZero ();
+      gradient.coeffRef (5) = 2. * M_PI * r * r;
+      gradient.coeffRef (6) = 4. * M_PI * h * r + 4. * M_PI * r * r;
+    }
+
+    template <>
+    void GenericAxisVolume<EigenMatrixDense>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      value_type h = argument[5];
+      value_type r = argument[6];
+
+      hessian.setZero ();
+      hessian (5, 6) = hessian (6, 5) = 4. * M_PI * r;
+      hessian (6, 6) = 4. * M_PI * h + 8. * M_PI * r;
+    }
+
+    template <>
+    void GenericAxisVolume<EigenMatrixSparse>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      value_type h = argument[5];
+      value_type r = argument[6];
+
+      // The (h,r) block is always stored to keep a constant structure.
+      hessian.resize (inputSize (), inputSize ());
+      hessian.setZero ();
+      hessian.reserve (4);
+      hessian.insert (5, 5) = 0.;
+      hessian.insert (5, 6) = 4. * M_PI * r;
+      hessian.insert (6, 5) = 4. * M_PI * r;
+      hessian.insert (6, 6) = 4. * M_PI * h + 8. * M_PI * r;
+      hessian.makeCompressed ();
+    }
+
+    // Explicit template instantiations.
+    template class GenericAxisVolume<EigenMatrixDense>;
+    template class GenericAxisVolume<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_AXIS_VOLUME_CC_
@@ -22,17 +22,291 @@
  * \brief CLI capsule generator.
  */
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
+#include <boost/bind.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/optional.hpp>
 #include <boost/program_options.hpp>
+#include <boost/thread.hpp>
 
 #include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/mesh-reader.hh>
+#include <roboptim/capsule/point-cloud.hh>
+#include <roboptim/capsule/result-writer.hh>
 #include <roboptim/capsule/util.hh>
 
 using namespace roboptim;
 using namespace roboptim::capsule;
 
+namespace
+{
+  /// \brief Fitting options shared by all inputs.
+  struct Options
+  {
+    /// \brief Nonlinear solver.
+    std::string solver;
+
+    /// \brief Solver used if the first one fails, may be empty.
+    std::string fallbackSolver;
+
+    /// \brief Optional optimization log directory.
+    boost::optional<std::string> logDir;
+
+    /// \brief Input format, deduced from file extensions if unknown.
+    MeshFormat format;
+
+    /// \brief Whether the solver prints its progress.
+    bool verbose;
+  };
+
+  /// \brief Seconds elapsed since a given time.
+  double secondsSince (const boost::posix_time::ptime& start)
+  {
+    return static_cast<double>
+      ((boost::posix_time::microsec_clock::universal_time () - start)
+       .total_microseconds ()) * 1e-6;
+  }
+
+  /// \brief Load an input and compute its convex hull.
+  ///
+  /// Throws std::runtime_error if the input cannot be read.
+  ///
+  /// \param input input file, "-" for the standard input, or empty.
+  /// \param format input format (MESH_UNKNOWN: from file extension).
+  /// \param points additional points (x0 y0 z0 x1 y1 z1 etc.).
+  /// \return convexPolyhedrons convex hull.
+  void loadConvexHull (const std::string& input, MeshFormat format,
+		       const std::vector<double>& points,
+		       polyhedrons_t& convexPolyhedrons)
+  {
+    if (format == MESH_UNKNOWN && !input.empty ())
+      format = meshFormatFromName (input);
+
+    // Point cloud files are mapped in memory, and their convex hull is
+    // computed in place
+    if (format == MESH_POINT_CLOUD && input != "-")
+      {
+	if (!points.empty ())
+	  throw std::runtime_error ("points cannot be added to a point cloud");
+
+	PointCloudFile cloud (input);
+	if (cloud.size () == 0)
+	  throw std::runtime_error ("no point to encapsulate");
+
+	if (cloud.scalarSize () == 4)
+	  convexPolyhedrons.push_back
+	    (convexHullFromPoints (cloud.floatPoints ()));
+	else
+	  convexPolyhedrons.push_back
+	    (convexHullFromPoints (cloud.doublePoints ()));
+	return;
+      }
+
+    // Fitter expects a vector of polyhedrons
+    polyhedrons_t polyhedrons (1);
+    polyhedron_t& polyhedron = polyhedrons[0];
+
+    // Load points from mesh file
+    if (!input.empty ())
+      readMeshPoints (input, format, polyhedron);
+
+    // Load points from CLI options
+    for (size_t i = 0; i + 2 < points.size (); i+=3)
+      {
+	point_t p (points[i], points[i+1], points[i+2]);
+	polyhedron.push_back (p);
+      }
+
+    if (polyhedron.empty ())
+      throw std::runtime_error ("no point to encapsulate");
+
+    // Only the convex hull matters, and it is usually much smaller than
+    // the input mesh.
+    computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
+  }
+
+  /// \brief Fit a capsule over a convex hull.
+  ///
+  /// \param convexPolyhedrons convex hull.
+  /// \param options fitting options.
+  /// \param fitter fitter, configured by this function.
+  void fitCapsule (const polyhedrons_t& convexPolyhedrons,
+		   const Options& options, Fitter& fitter)
+  {
+    // Load (optional) log directory
+    if (options.logDir)
+      fitter.logDirectory () = *options.logDir;
+
+    fitter.verbose () = options.verbose;
+    fitter.fallbackSolver () = options.fallbackSolver;
+
+    // Compute initial guess
+    point_t P0;
+    point_t P1;
+    value_type r = 0.;
+    argument_t initParam (7);
+
+    computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
+    convertCapsuleToSolverParam (initParam, P0, P1, r);
+
+    // Compute optimal capsule
+    fitter.computeBestFitCapsule (initParam);
+  }
+
+  /// \brief Load an input and fit a capsule over its convex hull.
+  ///
+  /// Errors are reported in the result instead of being thrown.
+  ///
+  /// \param input input file, "-" for the standard input, or empty.
+  /// \param points additional points (x0 y0 z0 x1 y1 z1 etc.).
+  /// \param options fitting options.
+  /// \param solverLogFile solver log file, empty to disable it, none
+  /// for the default one.
+  FitResult fitInput (const std::string& input,
+		      const std::vector<double>& points,
+		      const Options& options,
+		      const boost::optional<std::string>& solverLogFile)
+  {
+    FitResult result;
+    result.name = input;
+
+    try
+      {
+	boost::posix_time::ptime start
+	  = boost::posix_time::microsec_clock::universal_time ();
+
+	polyhedrons_t convexPolyhedrons;
+	loadConvexHull (input, options.format, points, convexPolyhedrons);
+	result.loadTime = secondsSince (start);
+	result.nbHullPoints = countPoints (convexPolyhedrons);
+
+	start = boost::posix_time::microsec_clock::universal_time ();
+
+	Fitter fitter (convexPolyhedrons, options.solver);
+	if (solverLogFile)
+	  fitter.solverLogFile () = *solverLogFile;
+	fitCapsule (convexPolyhedrons, options, fitter);
+	result.solveTime = secondsSince (start);
+
+	result.initParam = fitter.initParam ();
+	result.solutionParam = fitter.solutionParam ();
+	result.status = fitter.solverStatus ();
+	result.attempts = fitter.attempts ();
+      }
+    catch (std::exception& e)
+      {
+	result.error = e.what ();
+      }
+
+    return result;
+  }
+
+  /// \brief Inputs fitted in a single process by a pool of workers.
+  ///
+  /// The solver plugin is loaded once per fit, but the process start-up
+  /// is shared. Results are printed as they complete, so their order
+  /// depends on the solve times.
+  class Batch
+  {
+  public:
+    Batch (const std::vector<std::string>& inputs, const Options& options,
+	   ResultWriter& writer)
+      : inputs_ (inputs),
+	options_ (options),
+	writer_ (writer),
+	next_ (0),
+	failures_ (0)
+    {
+    }
+
+    /// \brief Fit all the inputs.
+    ///
+    /// \param jobs number of workers.
+    /// \return number of inputs that could not be fitted.
+    size_t run (size_t jobs)
+    {
+      jobs = std::max<size_t> (1, std::min (jobs, inputs_.size ()));
+
+      boost::thread_group workers;
+      for (size_t i = 0; i < jobs; ++i)
+	workers.create_thread (boost::bind (&Batch::work, this));
+      workers.join_all ();
+
+      return failures_;
+    }
+
+  private:
+    /// \brief Worker loop: fit inputs until there is none left.
+    void work ()
+    {
+      while (true)
+	{
+	  size_t i;
+	  {
+	    boost::mutex::scoped_lock lock (queueMutex_);
+	    if (next_ >= inputs_.size ())
+	      return;
+	    i = next_++;
+	  }
+
+	  process (i);
+	}
+    }
+
+    /// \brief Fit the i-th input and print the result.
+    void process (size_t i)
+    {
+      const std::string& input = inputs_[i];
+
+      // Each input gets its own log directory, and the solver log file
+      // would be shared.
+      Options options = options_;
+      if (options.logDir)
+	{
+	  std::stringstream logDir;
+	  logDir << *options.logDir << "/" << i;
+	  options.logDir = logDir.str ();
+	}
+
+      FitResult result = fitInput (input, std::vector<double> (), options,
+				   std::string ());
+
+      boost::mutex::scoped_lock lock (outputMutex_);
+      if (!result.error.empty ())
+	{
+	  std::cerr << "Error: " << input << ": " << result.error << std::endl;
+	  ++failures_;
+	}
+      writer_.write (result);
+    }
+
+    /// \brief Input files.
+    const std::vector<std::string>& inputs_;
+
+    /// \brief Fitting options.
+    const Options& options_;
+
+    /// \brief Result writer.
+    ResultWriter& writer_;
+
+    /// \brief Index of the next input to fit.
+    size_t next_;
+
+    /// \brief Number of failed inputs.
+    size_t failures_;
+
+    boost::mutex queueMutex_;
+    boost::mutex outputMutex_;
+  };
+} // end of anonymous namespace.
+
 int main(int argc, char** argv)
 {
   try
@@ -43,11 +317,32 @@ int main(int argc, char** argv)
       desc.add_options ()
 	("help", "Print this help and exit")
 	("solver", po::value<std::string> (), "Nonlinear solver used")
+	("fallback-solver", po::value<std::string> (),
+	 "Nonlinear solver used if the first one fails")
 	("log-dir", po::value<std::string> (), "Path to optimization logs")
-	("points", po::value<std::vector<double> > ()->multitoken ()->required (),
-	 "Points that will be encapsulated");
+	("points", po::value<std::vector<double> > ()->multitoken (),
+	 "Points that will be encapsulated")
+	("input", po::value<std::string> (),
+	 "Mesh file whose vertices will be encapsulated (STL, OBJ, PLY, "
+	 "raw float64 XYZ or RCPC point cloud), - for the standard input")
+	("format", po::value<std::string> (),
+	 "Input format (stl, obj, ply, xyz or rcpc), deduced from the file "
+	 "extension by default")
+	("manifest", po::value<std::string> (),
+	 "Batch mode: file listing one input per line")
+	("input-dir", po::value<std::string> (),
+	 "Batch mode: directory whose mesh files are all fitted")
+	("jobs", po::value<unsigned> ()->default_value (1),
+	 "Batch mode: number of parallel fits, 0 for one per core "
+	 "(the optimizations themselves run one at a time)")
+	("output-format", po::value<std::string> ()->default_value ("text"),
+	 "Result format: text, json (one object per line), csv or binary. "
+	 "Solver messages are disabled for all but text")
+	("output", po::value<std::string> (),
+	 "Result file, - or nothing for the standard output");
 
       po::positional_options_description positionalOptions;
+      positionalOptions.add ("input", 1);
 
       po::variables_map vm;
 
@@ -70,70 +365,150 @@ int main(int argc, char** argv)
 	      return EXIT_SUCCESS;
 	    }
 
-	  std::string solver = "ipopt";
+	  Options options;
+	  options.solver = "ipopt";
+	  options.format = MESH_UNKNOWN;
+	  options.verbose = true;
 
 	  // Load (optional) NLP solver
 	  if (vm.count ("solver"))
 	    {
-	      solver = vm["solver"].as<std::string> ();
+	      options.solver = vm["solver"].as<std::string> ();
 	    }
 
-	  // Check that points data was given
-	  if (!vm.count ("points"))
+	  // Load (optional) fallback NLP solver
+	  if (vm.count ("fallback-solver"))
 	    {
-	      std::cerr << "Error: missing mandatory point data." << std::endl;
-	      return EXIT_FAILURE;
+	      options.fallbackSolver = vm["fallback-solver"].as<std::string> ();
 	    }
 
-	  // Get points from CLI options
-	  const std::vector<double>&
-	    points = vm["points"].as<std::vector<double> > ();
+	  // Load (optional) log directory
+	  if (vm.count ("log-dir"))
+	    {
+	      options.logDir = vm["log-dir"].as<std::string> ();
+	    }
 
-	  if (points.size ()%3 != 0)
+	  // Load (optional) input format
+	  if (vm.count ("format"))
 	    {
-	      std::cerr << "Error: points should be an array of 3D points, "
-			<< "e.g. x0 y0 z0 x1 y1 z1 etc." << std::endl;
+	      options.format
+		= meshFormatFromName (vm["format"].as<std::string> ());
+	      if (options.format == MESH_UNKNOWN)
+		{
+		  std::cerr << "Error: unknown input format." << std::endl;
+		  return EXIT_FAILURE;
+		}
+	    }
+
+	  // Load result format
+	  ResultWriter::Format outputFormat;
+	  if (!parseResultFormat (vm["output-format"].as<std::string> (),
+				  outputFormat))
+	    {
+	      std::cerr << "Error: unknown output format." << std::endl;
 	      return EXIT_FAILURE;
 	    }
 
-	  // Load polyhedron
-	  polyhedron_t polyhedron;
-	  for (size_t i = 0; i < points.size (); i+=3)
+	  // Results must be the only content of machine-readable outputs
+	  if (outputFormat != ResultWriter::TEXT)
+	    options.verbose = false;
+
+	  // Open (optional) result file
+	  std::ofstream outputFile;
+	  if (vm.count ("output") && vm["output"].as<std::string> () != "-")
 	    {
-	      point_t p (points[i], points[i+1], points[i+2]);
-	      polyhedron.push_back (p);
+	      std::string output = vm["output"].as<std::string> ();
+	      outputFile.open (output.c_str (),
+			       std::ios::out | std::ios::binary);
+	      if (!outputFile)
+		{
+		  std::cerr << "Error: cannot open \"" << output << "\"."
+			    << std::endl;
+		  return EXIT_FAILURE;
+		}
 	    }
+	  std::ostream& os = outputFile.is_open () ? outputFile : std::cout;
+
+	  ResultWriter writer (os, outputFormat);
 
-	  // Fitter expects a vector of polyhedrons
-	  polyhedrons_t polyhedrons;
-	  polyhedrons.push_back (polyhedron);
+	  // Batch mode
+	  if (vm.count ("manifest") || vm.count ("input-dir"))
+	    {
+	      if (vm.count ("points") || vm.count ("input"))
+		{
+		  std::cerr << "Error: points and input cannot be used in "
+			    << "batch mode." << std::endl;
+		  return EXIT_FAILURE;
+		}
 
-	  // Create fitter
-	  Fitter fitter (polyhedrons, solver);
+	      std::vector<std::string> inputs;
+	      try
+		{
+		  if (vm.count ("manifest"))
+		    inputs = readManifest (vm["manifest"].as<std::string> ());
+		  if (vm.count ("input-dir"))
+		    {
+		      std::vector<std::string> files
+			= listMeshFiles (vm["input-dir"].as<std::string> ());
+		      inputs.insert (inputs.end (), files.begin (), files.end ());
+		    }
+		}
+	      catch (std::exception& e)
+		{
+		  std::cerr << "Error: " << e.what () << std::endl;
+		  return EXIT_FAILURE;
+		}
 
-	  // Load (optional) log directory
-	  if (vm.count ("log-dir"))
+	      size_t jobs = vm["jobs"].as<unsigned> ();
+	      if (jobs == 0)
+		jobs = boost::thread::hardware_concurrency ();
+
+	      // Solver traces of many fits would bury the streamed results
+	      options.verbose = false;
+
+	      Batch batch (inputs, options, writer);
+	      if (batch.run (jobs) > 0)
+		return EXIT_FAILURE;
+
+	      return EXIT_SUCCESS;
+	    }
+
+	  // Check that points data was given
+	  if (!vm.count ("points") && !vm.count ("input"))
 	    {
-	      fitter.logDirectory () = vm["log-dir"].as<std::string> ();
+	      std::cerr << "Error: missing mandatory point data." << std::endl;
+	      return EXIT_FAILURE;
 	    }
 
-	  // Compute initial guess
-	  point_t P0;
-	  point_t P1;
-	  value_type r = 0.;
-	  argument_t initParam (7);
+	  std::string input;
+	  if (vm.count ("input"))
+	    input = vm["input"].as<std::string> ();
 
-	  polyhedrons_t convexPolyhedrons;
-	  computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
-	  computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
-	  convertCapsuleToSolverParam (initParam, P0, P1, r);
+	  // Get points from CLI options
+	  std::vector<double> points;
+	  if (vm.count ("points"))
+	    points = vm["points"].as<std::vector<double> > ();
+
+	  if (points.size ()%3 != 0)
+	    {
+	      std::cerr << "Error: points should be an array of 3D points, "
+			<< "e.g. x0 y0 z0 x1 y1 z1 etc." << std::endl;
+	      return EXIT_FAILURE;
+	    }
 
 	  // Compute optimal capsule
-	  fitter.computeBestFitCapsule (initParam);
+	  FitResult result = fitInput (input, points, options, boost::none);
+
+	  // Display result (the input name is only needed in batch mode)
+	  if (outputFormat == ResultWriter::TEXT)
+	    result.name.clear ();
+	  writer.write (result);
 
-	  // Display result
-	  std::cout << "Initial: " << fitter.initParam () << std::endl;
-	  std::cout << "Solution: " << fitter.solutionParam () << std::endl;
+	  if (!result.error.empty ())
+	    {
+	      std::cerr << "Error: " << result.error << std::endl;
+	      return EXIT_FAILURE;
+	    }
 	}
       catch (boost::program_options::required_option& e)
 	{
@@ -45,6 +45,14 @@ namespace roboptim
     {
     }
 
+    DistanceCapsulePoint::
+    DistanceCapsulePoint (const point_t& point, const PointId& id)
+      : roboptim::DifferentiableFunction (7, 1, std::string ()),
+	point_ (point),
+	id_ (id)
+    {
+    }
+
     DistanceCapsulePoint::
     ~DistanceCapsulePoint ()
     {
@@ -56,6 +64,22 @@ namespace roboptim
       return point_;
     }
 
+    std::string DistanceCapsulePoint::
+    name () const
+    {
+      if (id_)
+	return constraintName (*id_);
+      return getName ();
+    }
+
+    std::ostream& DistanceCapsulePoint::
+    print (std::ostream& o) const
+    {
+      if (!id_)
+	return roboptim::DifferentiableFunction::print (o);
+      return o << constraintName (*id_);
+    }
+
     // -------------------PROTECTED FUNCTIONS--------------------
 
     void DistanceCapsulePoint::
@@ -71,7 +95,8 @@ namespace roboptim
       point_t endPoint2 (argument[3], argument[4], argument[5]);
 
       // Compute distance between segment and point.
-      value_type distance = distancePointToSegment (point_, endPoint1, endPoint2);
+      value_type distance
+	= distancePointToSegment<value_type> (point_, endPoint1, endPoint2);
 
       // Return difference between distance and capsule radius.
       result[0] = distance - argument[6];
@@ -98,9 +123,9 @@ namespace roboptim
       point_t endPoint2 (argument[3], argument[4], argument[5]);
 
       // Compute projection of point on segment.
-      point_t segmentClosest = projectionOnSegment (point_,
-                                                    endPoint1,
-                                                    endPoint2);
+      point_t segmentClosest = projectionOnSegment<value_type> (point_,
+                                                                endPoint1,
+                                                                endPoint2);
 
       // Compute unit axis between closest points.
       vector3_t unit = segmentClosest - point_;
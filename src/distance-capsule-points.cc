@@ -0,0 +1,205 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/distance-capsule-points.cc
+ *
+ * \brief Implementation of GenericDistanceCapsulePoints.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
+# define ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
+
+# include <roboptim/capsule/distance-capsule-points.hh>
+
+# include "roboptim/capsule/util.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 7, 1> capsuleGradient_t;
+
+      /// \brief Gradient of the distance between a capsule and a
+      /// point with respect to the capsule parameters.
+      ///
+      /// The projection parameter t of the point on the segment is
+      /// constant at first order, hence the closest point gradient is
+      /// (1-t) for the first end point and t for the second one.
+      void distanceGradient (capsuleGradient_t& gradient,
+			     const point_t& point,
+			     const_argument_ref argument)
+      {
+	point_t endPoint1 (argument[0], argument[1], argument[2]);
+	point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+	point_t closest
+	  = projectionOnSegment<value_type> (point, endPoint1, endPoint2);
+	value_type t = projectionParameterOnSegment<value_type>
+	  (point, endPoint1, endPoint2);
+
+	gradient.setZero ();
+
+	// The distance is not differentiable when the point lies on the
+	// segment: the null subgradient is used.
+	vector3_t unit = closest - point;
+	value_type distance = unit.norm ();
+	if (distance > 0.)
+	  {
+	    unit /= distance;
+	    gradient.segment<3> (0) = (1. - t) * unit;
+	    gradient.segment<3> (3) = t * unit;
+	  }
+
+	gradient[6] = -1.;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericDistanceCapsulePoints<T>::
+    GenericDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+				  std::string name)
+      : roboptim::GenericDifferentiableFunction<T>
+	(7, static_cast<size_type> (countPoints (polyhedrons)), name)
+    {
+      points_.reserve (static_cast<size_t> (this->outputSize ()));
+
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	points_.insert (points_.end (), polyhedron.begin (), polyhedron.end ());
+    }
+
+    template <typename T>
+    GenericDistanceCapsulePoints<T>::
+    ~GenericDistanceCapsulePoints ()
+    {
+    }
+
+    template <typename T>
+    const polyhedron_t& GenericDistanceCapsulePoints<T>::
+    points () const
+    {
+      return points_;
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericDistanceCapsulePoints<T>::
+    impl_compute (result_ref result,
+		  const_argument_ref argument) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      // Define capsule axis from argument.
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      for (size_t i = 0; i < points_.size (); ++i)
+	result[static_cast<size_type> (i)]
+	  = distancePointToSegment<value_type> (points_[i],
+						endPoint1, endPoint2)
+	  - argument[6];
+    }
+
+    template <>
+    void GenericDistanceCapsulePoints<EigenMatrixDense>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      capsuleGradient_t g;
+      distanceGradient (g, points_[static_cast<size_t> (functionId)], argument);
+      gradient = g;
+    }
+
+    template <>
+    void GenericDistanceCapsulePoints<EigenMatrixSparse>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      capsuleGradient_t g;
+      distanceGradient (g, points_[static_cast<size_t> (functionId)], argument);
+
+      // Explicit zeros are kept to preserve the structure.
+      gradient.setZero ();
+      gradient.reserve (7);
+      for (size_type j = 0; j < 7; ++j)
+	gradient.insert (j) = g[j];
+    }
+
+    template <>
+    void GenericDistanceCapsulePoints<EigenMatrixDense>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      capsuleGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  distanceGradient (g, points_[i], argument);
+	  jacobian.row (static_cast<size_type> (i)) = g.transpose ();
+	}
+    }
+
+    template <>
+    void GenericDistanceCapsulePoints<EigenMatrixSparse>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+
+      // Every row is fully filled (7 non-zeros, explicit zeros
+      // included), so that the sparsity pattern never changes between
+      // iterations. The reserved size depends on the storage order.
+      jacobian.resize (outputSize (), 7);
+      if (jacobian_t::IsRowMajor)
+	jacobian.reserve (Eigen::VectorXi::Constant (jacobian.outerSize (), 7));
+      else
+	jacobian.reserve (Eigen::VectorXi::Constant
+			  (jacobian.outerSize (),
+			   static_cast<int> (outputSize ())));
+
+      capsuleGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  distanceGradient (g, points_[i], argument);
+	  for (size_type j = 0; j < 7; ++j)
+	    jacobian.insert (static_cast<size_type> (i), j) = g[j];
+	}
+
+      jacobian.makeCompressed ();
+    }
+
+    // Explicit template instantiations.
+    template class GenericDistanceCapsulePoints<EigenMatrixDense>;
+    template class GenericDistanceCapsulePoints<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_CAPSULE_POINTS_CC_
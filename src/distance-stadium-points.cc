@@ -0,0 +1,195 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/distance-stadium-points.cc
+ *
+ * \brief Implementation of GenericDistanceStadiumPoints.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_CC_
+# define ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_CC_
+
+# include <roboptim/capsule/distance-stadium-points.hh>
+
+# include "roboptim/capsule/util.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 5, 1> stadiumGradient_t;
+
+      /// \brief Gradient of the distance between a stadium and a
+      /// planar point with respect to the stadium parameters (see
+      /// distanceGradient of GenericDistanceCapsulePoints).
+      void distanceGradient (stadiumGradient_t& gradient,
+			     const point2_t& point,
+			     const_argument_ref argument)
+      {
+	point2_t endPoint1 (argument[0], argument[1]);
+	point2_t endPoint2 (argument[2], argument[3]);
+
+	value_type t = projectionParameterOnSegment (point,
+						     endPoint1, endPoint2);
+	vector2_t unit = endPoint1 + t * (endPoint2 - endPoint1) - point;
+
+	gradient.setZero ();
+
+	// The distance is not differentiable when the point lies on the
+	// segment: the null subgradient is used.
+	value_type distance = unit.norm ();
+	if (distance > 0.)
+	  {
+	    unit /= distance;
+	    gradient.segment<2> (0) = (1. - t) * unit;
+	    gradient.segment<2> (2) = t * unit;
+	  }
+
+	gradient[4] = -1.;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericDistanceStadiumPoints<T>::
+    GenericDistanceStadiumPoints (const polygons_t& polygons,
+				  std::string name)
+      : roboptim::GenericDifferentiableFunction<T>
+	(5, static_cast<size_type> (countPoints (polygons)), name)
+    {
+      points_.reserve (static_cast<size_t> (this->outputSize ()));
+
+      BOOST_FOREACH (const polygon_t& polygon, polygons)
+	points_.insert (points_.end (), polygon.begin (), polygon.end ());
+    }
+
+    template <typename T>
+    GenericDistanceStadiumPoints<T>::
+    ~GenericDistanceStadiumPoints ()
+    {
+    }
+
+    template <typename T>
+    const polygon_t& GenericDistanceStadiumPoints<T>::
+    points () const
+    {
+      return points_;
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericDistanceStadiumPoints<T>::
+    impl_compute (result_ref result,
+		  const_argument_ref argument) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      point2_t endPoint1 (argument[0], argument[1]);
+      point2_t endPoint2 (argument[2], argument[3]);
+
+      for (size_t i = 0; i < points_.size (); ++i)
+	result[static_cast<size_type> (i)]
+	  = distancePointToSegment (points_[i], endPoint1, endPoint2)
+	  - argument[4];
+    }
+
+    template <>
+    void GenericDistanceStadiumPoints<EigenMatrixDense>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      stadiumGradient_t g;
+      distanceGradient (g, points_[static_cast<size_t> (functionId)], argument);
+      gradient = g;
+    }
+
+    template <>
+    void GenericDistanceStadiumPoints<EigenMatrixSparse>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      stadiumGradient_t g;
+      distanceGradient (g, points_[static_cast<size_t> (functionId)], argument);
+
+      // Explicit zeros are kept to preserve the structure.
+      gradient.setZero ();
+      gradient.reserve (5);
+      for (size_type j = 0; j < 5; ++j)
+	gradient.insert (j) = g[j];
+    }
+
+    template <>
+    void GenericDistanceStadiumPoints<EigenMatrixDense>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      stadiumGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  distanceGradient (g, points_[i], argument);
+	  jacobian.row (static_cast<size_type> (i)) = g.transpose ();
+	}
+    }
+
+    template <>
+    void GenericDistanceStadiumPoints<EigenMatrixSparse>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == 5 && "Wrong argument size, expected 5.");
+
+      // Every row is fully filled, so that the sparsity pattern never
+      // changes between iterations. Whatever the storage order, every
+      // outer vector is full.
+      jacobian.resize (outputSize (), 5);
+      jacobian.reserve (Eigen::VectorXi::Constant
+			(jacobian.outerSize (),
+			 static_cast<int> (jacobian.innerSize ())));
+
+      stadiumGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  distanceGradient (g, points_[i], argument);
+	  for (size_type j = 0; j < 5; ++j)
+	    jacobian.insert (static_cast<size_type> (i), j) = g[j];
+	}
+
+      jacobian.makeCompressed ();
+    }
+
+    // Explicit template instantiations.
+    template class GenericDistanceStadiumPoints<EigenMatrixDense>;
+    template class GenericDistanceStadiumPoints<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_DISTANCE_STADIUM_POINTS_CC_
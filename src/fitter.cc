@@ -31,28 +31,420 @@
 # include <boost/shared_ptr.hpp>
 # include <boost/make_shared.hpp>
 # include <boost/ref.hpp>
+# include <boost/thread/mutex.hpp>
 
 # include <roboptim/core/decorator/finite-difference-gradient.hh>
 # include <roboptim/core/linear-function.hh>
 # include <roboptim/core/optimization-logger.hh>
 
 # include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/arena.hh>
+# include <roboptim/capsule/axis-parameterization.hh>
+# include <roboptim/capsule/axis-parameterized-function.hh>
+# include <roboptim/capsule/axis-volume.hh>
+# include <roboptim/capsule/util.hh>
 
 namespace roboptim
 {
   namespace capsule
   {
+    namespace
+    {
+      /// \brief Solver plugins are loaded with libltdl, which is not
+      /// thread-safe.
+      boost::mutex pluginMutex;
+
+      /// \brief MUMPS is not thread-safe.
+      boost::mutex solveMutex;
+
+      /// \brief Extract the multipliers of the constraints from a
+      /// result.
+      ///
+      /// Depending on the plugin, the multipliers of the argument bounds
+      /// may come first: the constraint multipliers are the last ones.
+      void constraintMultipliers (vector_t& multipliers,
+				  const Result& result,
+				  size_type nbConstraints)
+      {
+	if (result.lambda.size () >= nbConstraints)
+	  multipliers = result.lambda.tail (nbConstraints);
+	else
+	  multipliers.resize (0);
+      }
+
+      /// \brief Solve a capsule fitting problem.
+      ///
+      /// If no solution is found, the solution falls back to the
+      /// initial parameters.
+      ///
+      /// \tparam S solver type.
+      /// \param parameterization parameterization of the problem.
+      /// \param nbConstraints number of constraint outputs.
+      /// \return multipliers Lagrange multipliers of the constraints,
+      /// empty if the solver does not provide them.
+      /// \return solver status.
+      template <typename S>
+      Fitter::SolverStatus solveProblem (typename S::problem_t& problem,
+			 const std::string& solverName,
+			 Fitter::Parameterization parameterization,
+			 const Fitter& fitter,
+			 const_argument_ref initParam,
+			 argument_ref solutionParam,
+			 size_type nbConstraints,
+			 vector_t& multipliers)
+      {
+	multipliers.resize (0);
+
+	// Create solver using Ipopt.
+	FitterSolver<S> fitterSolver (solverName, problem, fitter);
+	S& solver = fitterSolver.solver ();
+
+	// Exact Hessians require twice-differentiable functions, i.e. the
+	// smooth formulation of the constraints with end points.
+	if (fitter.useExactHessian ()
+	    && fitter.constraintType () == Fitter::SQUARED_DISTANCE
+	    && parameterization == Fitter::ENDPOINTS)
+	  solver.parameters ()["ipopt.hessian_approximation"].value = "exact";
+	else
+	  solver.parameters ()["ipopt.hessian_approximation"].value
+	    = "limited-memory";
+
+	// Set optimization logger if a log directory was provided.
+	// Note: actual logging to file is done once the OptimizationLogger is
+	// destroyed.
+	boost::shared_ptr<OptimizationLogger<S> > logger;
+	if (fitter.logDirectory ())
+	  {
+	    // Add optimization logger.
+	    logger = boost::make_shared<OptimizationLogger<S> >
+	      (boost::ref (solver), *fitter.logDirectory ());
+	  }
+
+	// Solve problem and check if the optimum is correct.
+	Fitter::SolverStatus status
+	  = fitterSolver.solve (initParam, solutionParam);
+	if (fitterSolver.result ())
+	  constraintMultipliers (multipliers, *fitterSolver.result (),
+				 nbConstraints);
+	return status;
+      }
+
+      /// \brief Add one distance constraint per point (dense problem).
+      ///
+      /// \param named whether each constraint stores its name (see
+      /// constraintName), e.g. for the optimization logger. Otherwise,
+      /// names are only built when the constraints are printed.
+      void addDistanceConstraints (solver_t::problem_t& problem,
+				   const polyhedrons_t& polyhedrons,
+				   bool named)
+      {
+	// Constraints are only used by the problem: they are taken from
+	// the arena of the enclosing scope.
+	ArenaAllocator<DistanceCapsulePoint> allocator;
+
+	// Distances must always be negative (points remain inside the
+	// capsule as it shrinks).
+	Function::interval_t distanceInterval
+	  = Function::makeUpperInterval (0.);
+
+	// Cycle through polyhedron points and define distance
+	// functions. They are the constraints of the optimization
+	// problem, in the order of pointIdFromIndex.
+	PointId id;
+	for (id.polyhedron = 0; id.polyhedron < polyhedrons.size ();
+	     ++id.polyhedron)
+	  {
+	    const polyhedron_t& polyhedron = polyhedrons[id.polyhedron];
+	    for (id.point = 0; id.point < polyhedron.size (); ++id.point)
+	      {
+		boost::shared_ptr<DistanceCapsulePoint> distance;
+		if (named)
+		  distance = boost::allocate_shared<DistanceCapsulePoint>
+		    (allocator, polyhedron[id.point], constraintName (id));
+		else
+		  distance = boost::allocate_shared<DistanceCapsulePoint>
+		    (allocator, polyhedron[id.point], id);
+
+		problem.addConstraint (distance, distanceInterval, 1.);
+	      }
+	  }
+      }
+
+      /// \brief Add a single stacked distance constraint (sparse
+      /// problem).
+      void addDistanceConstraints (sparse_solver_t::problem_t& problem,
+				   const polyhedrons_t& polyhedrons,
+				   bool /* named */)
+      {
+	// Taken from the arena of the enclosing scope, as the dense
+	// constraints.
+	boost::shared_ptr<SparseDistanceCapsulePoints>
+	  distances = boost::allocate_shared<SparseDistanceCapsulePoints>
+	  (ArenaAllocator<SparseDistanceCapsulePoints> (), polyhedrons);
+	size_t nbPoints = distances->points ().size ();
+
+	// Distances must always be negative (points remain inside the
+	// capsule as it shrinks).
+	Function::intervals_t distanceIntervals
+	  (nbPoints, Function::makeUpperInterval (0.));
+	sparse_solver_t::problem_t::scaling_t distanceScaling (nbPoints, 1.);
+
+	problem.addConstraint (distances, distanceIntervals, distanceScaling);
+      }
+
+      /// \brief Add a stacked point-in-capsule constraint, expressed
+      /// with the parameterization of the fitter.
+      ///
+      /// \tparam T matrix type.
+      /// \tparam F constraint type.
+      /// \param axis whether the problem uses the AXIS
+      /// parameterization.
+      template <typename T, typename F>
+      void addCapsuleConstraint (typename Solver<T>::problem_t& problem,
+				 boost::shared_ptr<F> constraint,
+				 bool axis,
+				 const AxisParameterization& parameterization)
+      {
+	typedef typename Solver<T>::problem_t problem_t;
+
+	size_t nbPoints = static_cast<size_t> (constraint->outputSize ());
+
+	// Constraints must always be negative (points remain inside the
+	// capsule as it shrinks).
+	Function::intervals_t intervals
+	  (nbPoints, Function::makeUpperInterval (0.));
+	typename problem_t::scaling_t scaling (nbPoints, 1.);
+
+	if (axis)
+	  {
+	    typedef GenericAxisParameterizedFunction<T> axisConstraint_t;
+	    boost::shared_ptr<axisConstraint_t>
+	      axisConstraint = boost::allocate_shared<axisConstraint_t>
+	      (ArenaAllocator<axisConstraint_t> (), constraint,
+	       parameterization);
+	    problem.addConstraint (axisConstraint, intervals, scaling);
+	  }
+	else
+	  problem.addConstraint (constraint, intervals, scaling);
+      }
+
+      /// \brief Build and solve the capsule fitting problem.
+      ///
+      /// \tparam T matrix type.
+      /// \param capsuleParameterization parameterization of the
+      /// problem, which may differ from the fitter one in fallbacks.
+      /// \return multipliers Lagrange multipliers of the
+      /// point-in-capsule constraints, one per point.
+      /// \return solver status.
+      template <typename T>
+      Fitter::SolverStatus solveCapsuleProblem (const polyhedrons_t& polyhedrons,
+				const Fitter& fitter,
+				const std::string& solverName,
+				Fitter::Parameterization
+				capsuleParameterization,
+				const_argument_ref initParam,
+				argument_ref solutionParam,
+				vector_t& multipliers)
+      {
+	typedef Solver<T> localSolver_t;
+	typedef typename localSolver_t::problem_t problem_t;
+	typedef GenericDistanceCapsulePoints<T> distances_t;
+	typedef GenericSquaredDistanceCapsulePoints<T> squaredDistances_t;
+
+	size_t nbPoints = countPoints (polyhedrons);
+	Fitter::ConstraintType constraintType = fitter.constraintType ();
+	bool axis = (capsuleParameterization == Fitter::AXIS);
+
+	// The smooth formulation has one auxiliary variable per point.
+	size_type inputSize = 7;
+	if (constraintType == Fitter::SQUARED_DISTANCE)
+	  inputSize += static_cast<size_type> (nbPoints);
+
+	// Angles are measured from the initial capsule axis.
+	point_t endPoint1 (initParam[0], initParam[1], initParam[2]);
+	point_t endPoint2 (initParam[3], initParam[4], initParam[5]);
+	AxisParameterization parameterization (endPoint2 - endPoint1);
+
+	// Temporary data of the problem is released in bulk when it is
+	// destroyed.
+	ArenaScope scope;
+
+	// Define optimization problem with volume as cost function.
+	boost::shared_ptr<GenericFunction<T> > volume;
+	if (axis)
+	  volume.reset (new GenericAxisVolume<T> (inputSize));
+	else
+	  volume.reset (new GenericVolume<T> (inputSize, "capsule volume",
+					      fitter.lengthSmoothing ()));
+	problem_t problem (volume);
+
+	// The radius must not be negative.
+	problem.argumentBounds ()[6] = Function::makeLowerInterval (0.);
+
+	// Neither must the half-length.
+	if (axis)
+	  problem.argumentBounds ()[5] = Function::makeLowerInterval (0.);
+
+	argument_t startingPoint (inputSize);
+
+	switch (constraintType)
+	  {
+	  case Fitter::DISTANCE:
+	    {
+	      startingPoint = initParam;
+	      if (axis)
+		{
+		  boost::shared_ptr<distances_t>
+		    distances = boost::allocate_shared<distances_t>
+		    (ArenaAllocator<distances_t> (), polyhedrons);
+		  addCapsuleConstraint<T> (problem, distances, axis,
+					   parameterization);
+		}
+	      else
+		{
+		  // The logger reads the stored names, printing builds
+		  // them.
+		  bool named = fitter.logDirectory ().is_initialized ();
+		  addDistanceConstraints (problem, polyhedrons, named);
+		}
+	      break;
+	    }
+	  case Fitter::SQUARED_DISTANCE:
+	    {
+	      boost::shared_ptr<squaredDistances_t>
+		distances = boost::allocate_shared<squaredDistances_t>
+		(ArenaAllocator<squaredDistances_t> (), polyhedrons);
+	      distances->startingPoint (startingPoint, initParam);
+
+	      // Projection parameters lie on the segment.
+	      for (size_t i = 0; i < nbPoints; ++i)
+		problem.argumentBounds ()[7 + i]
+		  = Function::makeInterval (0., 1.);
+
+	      addCapsuleConstraint<T> (problem, distances, axis,
+				       parameterization);
+	      break;
+	    }
+	  }
+
+	if (axis)
+	  {
+	    argument_t axisParam (7);
+	    parameterization.fromEndPoints (axisParam, initParam);
+	    startingPoint.head (7) = axisParam;
+	  }
+
+	// Define problem starting point.
+	problem.startingPoint () = startingPoint;
+
+	argument_t solution (inputSize);
+	Fitter::SolverStatus status
+	  = solveProblem<localSolver_t> (problem, solverName,
+					 capsuleParameterization, fitter,
+					 startingPoint, solution,
+					 static_cast<size_type> (nbPoints),
+					 multipliers);
+
+	// Only keep the capsule parameters, as end points.
+	if (axis)
+	  parameterization.toEndPoints (solutionParam, solution.head (7));
+	else
+	  solutionParam = solution.head (7);
+
+	return status;
+      }
+    } // end of anonymous namespace.
+
     // -------------------PUBLIC FUNCTIONS-----------------------
 
+    boost::mutex& solverPluginMutex ()
+    {
+      return pluginMutex;
+    }
+
+    boost::mutex& solverMutex ()
+    {
+      return solveMutex;
+    }
+
+    void setIpoptParameters (solver_t::parameters_t& parameters,
+			     const std::string& logFile,
+			     bool verbose,
+			     size_t maxIterations,
+			     value_type maxCpuTime)
+    {
+      if (!logFile.empty ())
+	{
+	  parameters["ipopt.output_file"].value = logFile;
+	  parameters["ipopt.file_print_level"].value = 5;
+	}
+      parameters["ipopt.linear_solver"].value = "mumps";
+      parameters["ipopt.derivative_test_perturbation"].value = 10e-8;
+      if (verbose)
+	{
+	  parameters["ipopt.derivative_test"].value = "first-order";
+	  parameters["ipopt.print_level"].value = 5;
+	  parameters["ipopt.print_user_options"].value = "yes";
+	}
+      else
+	{
+	  // Nothing is printed on the standard output.
+	  parameters["ipopt.derivative_test"].value = "none";
+	  parameters["ipopt.print_level"].value = 0;
+	  parameters["ipopt.print_user_options"].value = "no";
+	  parameters["ipopt.sb"].value = "yes";
+	}
+      parameters["ipopt.bound_relax_factor"].value = 1e-12;
+      parameters["ipopt.tol"].value = 1e-3;
+      parameters["ipopt.compl_inf_tol"].value = 1e-6;
+      parameters["ipopt.dual_inf_tol"].value = 1e5;
+      parameters["ipopt.constr_viol_tol"].value = 1e-6;
+      parameters["ipopt.acceptable_iter"].value = 15;
+      parameters["ipopt.acceptable_tol"].value = 1e1;
+      parameters["ipopt.acceptable_obj_change_tol"].value = 1e-3;
+      parameters["ipopt.acceptable_compl_inf_tol"].value = 1e-3;
+      parameters["ipopt.acceptable_dual_inf_tol"].value = 1e2;
+      parameters["ipopt.acceptable_constr_viol_tol"].value = 1e-5;
+      parameters["ipopt.mu_strategy"].value = "adaptive";
+      parameters["ipopt.nlp_scaling_method"].value = "gradient-based";
+      if (maxIterations > 0)
+	parameters["ipopt.max_iter"].value = static_cast<int> (maxIterations);
+      if (maxCpuTime > 0.)
+	parameters["ipopt.max_cpu_time"].value = maxCpuTime;
+    }
+
     Fitter::
     Fitter (const polyhedrons_t& polyhedrons,
             std::string solver)
       : polyhedrons_ (polyhedrons),
-        solver_ (solver)
+        solver_ (solver),
+        solverLogFile_ ("fitter-ipopt.log"),
+        verbose_ (true),
+        solverStatus_ (NOT_SOLVED),
+        fallbacks_ (),
+        fallbackSolver_ (),
+        attempts_ (),
+        maxIterations_ (0),
+        maxCpuTime_ (0.),
+        multipliers_ (),
+        activeTolerance_ (1e-4),
+        supportPoints_ (),
+        verifyContainment_ (true),
+        radiusInflation_ (0.),
+        useSparseMatrices_ (false),
+        constraintType_ (DISTANCE),
+        useExactHessian_ (false),
+        lengthSmoothing_ (0.),
+        parameterization_ (ENDPOINTS)
     {
       argument_t param (7);
       param.setZero ();
       solutionParam_ = param;
+
+      fallbacks_.push_back (PERTURBED_START);
+      fallbacks_.push_back (OTHER_PARAMETERIZATION);
+      fallbacks_.push_back (OTHER_SOLVER);
+      fallbacks_.push_back (HEURISTIC);
     }
 
     Fitter::
@@ -119,6 +511,161 @@ namespace roboptim
       return logDir_;
     }
 
+    std::string& Fitter::solverLogFile ()
+    {
+      return solverLogFile_;
+    }
+
+    const std::string& Fitter::solverLogFile () const
+    {
+      return solverLogFile_;
+    }
+
+    bool& Fitter::verbose ()
+    {
+      return verbose_;
+    }
+
+    bool Fitter::verbose () const
+    {
+      return verbose_;
+    }
+
+    Fitter::SolverStatus Fitter::solverStatus () const
+    {
+      return solverStatus_;
+    }
+
+    std::vector<Fitter::FitStep>& Fitter::fallbacks ()
+    {
+      return fallbacks_;
+    }
+
+    const std::vector<Fitter::FitStep>& Fitter::fallbacks () const
+    {
+      return fallbacks_;
+    }
+
+    std::string& Fitter::fallbackSolver ()
+    {
+      return fallbackSolver_;
+    }
+
+    const std::string& Fitter::fallbackSolver () const
+    {
+      return fallbackSolver_;
+    }
+
+    const Fitter::attempts_t& Fitter::attempts () const
+    {
+      return attempts_;
+    }
+
+    size_t& Fitter::maxIterations ()
+    {
+      return maxIterations_;
+    }
+
+    size_t Fitter::maxIterations () const
+    {
+      return maxIterations_;
+    }
+
+    value_type& Fitter::maxCpuTime ()
+    {
+      return maxCpuTime_;
+    }
+
+    value_type Fitter::maxCpuTime () const
+    {
+      return maxCpuTime_;
+    }
+
+    const vector_t& Fitter::multipliers () const
+    {
+      return multipliers_;
+    }
+
+    value_type& Fitter::activeTolerance ()
+    {
+      return activeTolerance_;
+    }
+
+    value_type Fitter::activeTolerance () const
+    {
+      return activeTolerance_;
+    }
+
+    const Fitter::supportPoints_t& Fitter::supportPoints () const
+    {
+      return supportPoints_;
+    }
+
+    bool& Fitter::verifyContainment ()
+    {
+      return verifyContainment_;
+    }
+
+    bool Fitter::verifyContainment () const
+    {
+      return verifyContainment_;
+    }
+
+    value_type Fitter::radiusInflation () const
+    {
+      return radiusInflation_;
+    }
+
+    bool& Fitter::useSparseMatrices ()
+    {
+      return useSparseMatrices_;
+    }
+
+    bool Fitter::useSparseMatrices () const
+    {
+      return useSparseMatrices_;
+    }
+
+    Fitter::ConstraintType& Fitter::constraintType ()
+    {
+      return constraintType_;
+    }
+
+    Fitter::ConstraintType Fitter::constraintType () const
+    {
+      return constraintType_;
+    }
+
+    bool& Fitter::useExactHessian ()
+    {
+      return useExactHessian_;
+    }
+
+    bool Fitter::useExactHessian () const
+    {
+      return useExactHessian_;
+    }
+
+    value_type& Fitter::lengthSmoothing ()
+    {
+      return lengthSmoothing_;
+    }
+
+    value_type Fitter::lengthSmoothing () const
+    {
+      return lengthSmoothing_;
+    }
+
+    Fitter::Parameterization& Fitter::parameterization ()
+    {
+      return parameterization_;
+    }
+
+    Fitter::Parameterization Fitter::parameterization () const
+    {
+      return parameterization_;
+    }
+
     void Fitter::
     computeBestFitCapsule (const_argument_ref initParam)
     {
@@ -160,122 +707,193 @@ namespace roboptim
       assert (initParam.size () == 7
 	      && "Incorrect initParam size, expected 7.");
 
-      // Define volume function. It is the cost of the optimization
-      // problem.
+      // Define volume function, used to evaluate the initial and
+      // solution capsules.
       boost::shared_ptr<Volume> volume (new Volume ());
       initParam_ = initParam;
       initVolume_ = (*volume) (initParam)[0];
 
-      // Define optimization problem with volume as cost function.
-      solver_t::problem_t problem (volume);
+      attempts_.clear ();
+      multipliers_.resize (0);
+      solverStatus_ = runStep (INITIAL_SOLVE, polyhedrons, solutionParam);
 
-      // Define problem starting point.
-      problem.startingPoint () = initParam;
+      // Fallback chain: stop at the first step that gives a solution.
+      for (size_t i = 0; i < fallbacks_.size (); ++i)
+	{
+	  if (solverStatus_ != NO_SOLUTION && solverStatus_ != SOLVER_FAILED)
+	    break;
 
-      // The radius must not be negative.
-      problem.argumentBounds ()[6] = Function::makeLowerInterval (0.);
+	  argument_t stepSolution (7);
+	  SolverStatus status = runStep (fallbacks_[i], polyhedrons,
+					 stepSolution);
+	  if (status == NOT_SOLVED)
+	    continue;
+
+	  // A failed step returns its own start, e.g. the perturbed
+	  // capsule: the solution remains the initial guess.
+	  solverStatus_ = status;
+	  if (status != NO_SOLUTION && status != SOLVER_FAILED)
+	    solutionParam = stepSolution;
+	}
 
-      // Cycle through polyhedron points and define distance
-      // functions. They are the constraints of the optimization
-      // problem.
-      BOOST_FOREACH (polyhedron_t polyhedron, polyhedrons)
-	{
-	  for (size_t j = 0; j < polyhedron.size (); ++j)
-	    {
-	      const point_t& point = polyhedron[j];
+      // The solution satisfies the constraints up to the solver
+      // tolerances.
+      radiusInflation_ = 0.;
+      if (verifyContainment_)
+	radiusInflation_ = inflateToContain (solutionParam, polyhedrons);
 
-	      std::string s = "distance to point ";
-	      std::stringstream name;
-	      name << s << j;
+      solutionParam_ = solutionParam;
+      solutionVolume_ = (*volume) (solutionParam)[0];
 
-	      // Add distance constraint. Distance must always be negative
-	      // (points remain inside the capsule as it shrinks).
-	      boost::shared_ptr<DistanceCapsulePoint>
-		distance (new DistanceCapsulePoint (point, name.str ()));
-	      Function::interval_t distanceInterval
-		= Function::makeUpperInterval (0.);
+      computeSupportPoints (polyhedrons);
+    }
 
-	      problem.addConstraint (distance, distanceInterval, 1.);
+    void Fitter::
+    computeSupportPoints (const polyhedrons_t& polyhedrons)
+    {
+      supportPoints_.clear ();
+
+      point_t endPoint1 = solutionParam_.segment<3> (0);
+      point_t endPoint2 = solutionParam_.segment<3> (3);
+      value_type threshold = (1. - activeTolerance_) * solutionParam_[6];
+      bool hasMultipliers = (multipliers_.size ()
+			     == static_cast<size_type> (countPoints
+							(polyhedrons)));
+
+      size_t index = 0;
+      SupportPoint support;
+      for (support.id.polyhedron = 0;
+	   support.id.polyhedron < polyhedrons.size ();
+	   ++support.id.polyhedron)
+	{
+	  const polyhedron_t& polyhedron = polyhedrons[support.id.polyhedron];
+	  for (support.id.point = 0; support.id.point < polyhedron.size ();
+	       ++support.id.point, ++index)
+	    {
+	      support.distance = distancePointToSegment<value_type>
+		(polyhedron[support.id.point], endPoint1, endPoint2);
+	      if (support.distance < threshold)
+		continue;
+
+	      support.multiplier = hasMultipliers ?
+		multipliers_[static_cast<size_type> (index)] : 0.;
+	      supportPoints_.push_back (support);
 	    }
 	}
+    }
 
-      // Create solver using Ipopt.
-      SolverFactory<solver_t> factory (solver_, problem);
-      solver_t& solver = factory ();
-
-      // Ipopt parameters
-      solver.parameters ()["ipopt.output_file"].value = "fitter-ipopt.log";
-      solver.parameters ()["ipopt.linear_solver"].value = "mumps";
-      solver.parameters ()["ipopt.derivative_test"].value = "first-order";
-      solver.parameters ()["ipopt.derivative_test_perturbation"].value = 10e-8;
-      solver.parameters ()["ipopt.print_level"].value = 5;
-      solver.parameters ()["ipopt.file_print_level"].value = 5;
-      solver.parameters ()["ipopt.print_user_options"].value = "yes";
-      solver.parameters ()["ipopt.bound_relax_factor"].value = 1e-12;
-      solver.parameters ()["ipopt.tol"].value = 1e-3;
-      solver.parameters ()["ipopt.compl_inf_tol"].value = 1e-6;
-      solver.parameters ()["ipopt.dual_inf_tol"].value = 1e5;
-      solver.parameters ()["ipopt.constr_viol_tol"].value = 1e-6;
-      solver.parameters ()["ipopt.acceptable_iter"].value = 15;
-      solver.parameters ()["ipopt.acceptable_tol"].value = 1e1;
-      solver.parameters ()["ipopt.acceptable_obj_change_tol"].value = 1e-3;
-      solver.parameters ()["ipopt.acceptable_compl_inf_tol"].value = 1e-3;
-      solver.parameters ()["ipopt.acceptable_dual_inf_tol"].value = 1e2;
-      solver.parameters ()["ipopt.acceptable_constr_viol_tol"].value = 1e-5;
-      solver.parameters ()["ipopt.mu_strategy"].value = "adaptive";
-      solver.parameters ()["ipopt.nlp_scaling_method"].value = "gradient-based";
-
-      // Set optimization logger if a log directory was provided.
-      // Note: actual logging to file is done once the OptimizationLogger is
-      // destroyed.
-      boost::shared_ptr<OptimizationLogger<solver_t> > logger;
-      if (logDir_)
+    Fitter::SolverStatus Fitter::
+    solve (const polyhedrons_t& polyhedrons,
+	   const std::string& solver,
+	   Parameterization parameterization,
+	   const_argument_ref startParam,
+	   argument_ref solutionParam)
+    {
+      // The smooth formulation adds one variable per point: its
+      // dense Jacobian would grow with the square of the points.
+      if (useSparseMatrices_ || constraintType_ == SQUARED_DISTANCE)
 	{
-	  // Add optimization logger.
-	  logger = boost::make_shared<OptimizationLogger<solver_t> > (boost::ref (solver), *logDir_);
+	  // The sparse Ipopt plugin is named differently.
+	  std::string solverName = solver;
+	  if (solverName == "ipopt")
+	    solverName = "ipopt-sparse";
+
+	  return solveCapsuleProblem<EigenMatrixSparse>
+	    (polyhedrons, *this, solverName, parameterization, startParam,
+	     solutionParam, multipliers_);
 	}
 
-      // Solve problem and check if the optimum is correct.
-      solver_t::result_t result = solver.minimum ();
+      return solveCapsuleProblem<EigenMatrixDense>
+	(polyhedrons, *this, solver, parameterization, startParam,
+	 solutionParam, multipliers_);
+    }
 
-      switch (solver.minimumType ())
+    Fitter::SolverStatus Fitter::
+    runStep (FitStep step, const polyhedrons_t& polyhedrons,
+	     argument_ref solutionParam)
+    {
+      SolverStatus status = NOT_SOLVED;
+
+      switch (step)
 	{
-	case solver_t::SOLVER_NO_SOLUTION:
+	case INITIAL_SOLVE:
 	  {
-	    std::cerr << "No solution." << std::endl;
-	    solutionParam = initParam_;
+	    status = solve (polyhedrons, solver_, parameterization_,
+			    initParam_, solutionParam);
 	    break;
 	  }
-	case solver_t::SOLVER_ERROR:
+	case PERTURBED_START:
 	  {
-	    // Display error and fall back gracefully to initial
-	    // guess.
-	    std::cerr << "An error happened: " << std::endl
-	    	      << solver.getMinimum<SolverError> ().what ()
-	    	      << std::endl;
-	    solutionParam = initParam_;
+	    // Strictly feasible start, with moved end points (the
+	    // perturbation is deterministic).
+	    value_type scale = std::max (initParam_[6], 1e-3);
+	    argument_t startParam = initParam_;
+	    startParam.segment<3> (0) += 0.05 * scale * vector3_t (1., -1., 1.);
+	    startParam.segment<3> (3) -= 0.05 * scale * vector3_t (1., -1., 1.);
+	    startParam[6] = 1.2 * scale;
+
+	    status = solve (polyhedrons, solver_, parameterization_,
+			    startParam, solutionParam);
 	    break;
 	  }
-	case solver_t::SOLVER_VALUE_WARNINGS:
+	case OTHER_PARAMETERIZATION:
 	  {
-	    // Display the result.
-	    std::cout << "A solution has been found (with warnings)" << std::endl
-		      << solver.getMinimum<ResultWithWarnings> ()
-		      << std::endl;
-	    solutionParam = solver.getMinimum<ResultWithWarnings> ().x;
+	    Parameterization parameterization
+	      = (parameterization_ == AXIS) ? ENDPOINTS : AXIS;
+	    status = solve (polyhedrons, solver_, parameterization,
+			    initParam_, solutionParam);
 	    break;
 	  }
-	case solver_t::SOLVER_VALUE:
+	case OTHER_SOLVER:
 	  {
-	    // Display the result.
-	    std::cout << "A solution has been found" << std::endl;
-	    solutionParam = solver.getMinimum<Result> ().x;
+	    // Skipped, but still recorded.
+	    if (fallbackSolver_.empty ())
+	      break;
+
+	    status = solve (polyhedrons, fallbackSolver_, parameterization_,
+			    initParam_, solutionParam);
+	    break;
+	  }
+	case HEURISTIC:
+	  {
+	    point_t endPoint1 = initParam_.segment<3> (0);
+	    point_t endPoint2 = initParam_.segment<3> (3);
+	    vector3_t direction = endPoint2 - endPoint1;
+
+	    // A zero-length initial capsule has no axis: the direction
+	    // of largest spread is used instead.
+	    if (direction.norm () < 1e-12)
+	      {
+		polyhedron_t points;
+		convertPolyhedronVectorToPolyhedron (points, polyhedrons);
+		Capsule capsule = capsuleFromPoints (points);
+		direction = capsule.P1 - capsule.P0;
+	      }
+	    if (direction.norm () < 1e-12)
+	      direction = vector3_t::UnitX ();
+
+	    fitCapsuleAlongAxis (solutionParam, polyhedrons,
+				 0.5 * (endPoint1 + endPoint2), direction);
+
+	    // The initial capsule may be smaller, once it contains the
+	    // points.
+	    argument_t initCapsule = initParam_;
+	    inflateToContain (initCapsule, polyhedrons);
+	    if (capsuleVolume (initCapsule) < capsuleVolume (solutionParam))
+	      solutionParam = initCapsule;
+
+	    multipliers_.resize (0);
+	    status = HEURISTIC_SOLUTION;
 	    break;
 	  }
 	}
 
-      solutionParam_ = solutionParam;
-      solutionVolume_ = (*volume) (solutionParam)[0];
+      Attempt attempt;
+      attempt.step = step;
+      attempt.status = status;
+      attempts_.push_back (attempt);
+
+      return status;
     }
 
   } // end of namespace capsule.
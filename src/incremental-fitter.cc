@@ -0,0 +1,300 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/incremental-fitter.cc
+ *
+ * \brief Implementation of IncrementalFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_CC_
+# define ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_CC_
+
+# include <boost/foreach.hpp>
+
+# include <roboptim/capsule/incremental-fitter.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    IncrementalFitter::
+    IncrementalFitter (const polyhedron_t& points, std::string solver)
+      : points_ (points),
+	removed_ (points.size (), false),
+	size_ (points.size ()),
+	hull_ (),
+	added_ (),
+	hullVertexRemoved_ (true),
+	needsRefit_ (true),
+	capsule_ (),
+	fitter_ (polyhedrons_t (1, points), solver),
+	activeTolerance_ (1e-3),
+	refitCount_ (0)
+    {
+      assert (!points.empty () && "Empty point set.");
+    }
+
+    IncrementalFitter::
+    IncrementalFitter (const polyhedron_t& points,
+		       const_argument_ref capsuleParam,
+		       std::string solver)
+      : points_ (points),
+	removed_ (points.size (), false),
+	size_ (points.size ()),
+	hull_ (),
+	added_ (),
+	hullVertexRemoved_ (true),
+	needsRefit_ (false),
+	capsule_ (capsuleParam),
+	fitter_ (polyhedrons_t (1, points), solver),
+	activeTolerance_ (1e-3),
+	refitCount_ (0)
+    {
+      assert (!points.empty () && "Empty point set.");
+      assert (capsuleParam.size () == 7
+	      && "Wrong capsule parameters size, expected 7.");
+    }
+
+    IncrementalFitter::
+    ~IncrementalFitter ()
+    {
+    }
+
+    Fitter& IncrementalFitter::fitter ()
+    {
+      return fitter_;
+    }
+
+    const Fitter& IncrementalFitter::fitter () const
+    {
+      return fitter_;
+    }
+
+    value_type& IncrementalFitter::activeTolerance ()
+    {
+      return activeTolerance_;
+    }
+
+    value_type IncrementalFitter::activeTolerance () const
+    {
+      return activeTolerance_;
+    }
+
+    size_t IncrementalFitter::
+    addPoint (const point_t& point)
+    {
+      points_.push_back (point);
+      removed_.push_back (false);
+      notifyAdded (points_.size () - 1);
+      return points_.size () - 1;
+    }
+
+    void IncrementalFitter::
+    removePoint (size_t id)
+    {
+      assert (contains (id) && "Unknown point.");
+
+      removed_[id] = true;
+      --size_;
+
+      // Removing an interior point does not change the hull. Points
+      // added since the last hull update are not part of it yet.
+      if (!hullVertexRemoved_ && isHullVertex (points_[id]))
+	hullVertexRemoved_ = true;
+
+      if (!needsRefit_ && isActive (points_[id]))
+	needsRefit_ = true;
+    }
+
+    void IncrementalFitter::
+    movePoint (size_t id, const point_t& point)
+    {
+      removePoint (id);
+      points_[id] = point;
+      removed_[id] = false;
+      notifyAdded (id);
+    }
+
+    bool IncrementalFitter::
+    contains (size_t id) const
+    {
+      return id < points_.size () && !removed_[id];
+    }
+
+    const point_t& IncrementalFitter::
+    point (size_t id) const
+    {
+      assert (id < points_.size () && "Unknown point.");
+      return points_[id];
+    }
+
+    size_t IncrementalFitter::size () const
+    {
+      return size_;
+    }
+
+    bool IncrementalFitter::
+    update ()
+    {
+      if (!needsRefit_)
+	return false;
+
+      assert (size_ > 0 && "Empty point set.");
+
+      updateHull ();
+      polyhedrons_t polyhedrons (1, hull_);
+
+      // Warm start: the previous capsule, made feasible.
+      argument_t initParam (7);
+      if (capsule_.size () == 7)
+	{
+	  initParam = capsule_;
+	  inflateToContain (initParam, polyhedrons);
+	}
+      else
+	{
+	  point_t endPoint1;
+	  point_t endPoint2;
+	  value_type radius;
+	  computeBoundingCapsulePolyhedron (polyhedrons,
+					    endPoint1, endPoint2, radius);
+	  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2,
+				       radius);
+	}
+
+      fitter_.computeBestFitCapsule (polyhedrons, initParam);
+      capsule_ = fitter_.solutionParam ();
+
+      needsRefit_ = false;
+      ++refitCount_;
+      return true;
+    }
+
+    bool IncrementalFitter::needsRefit () const
+    {
+      return needsRefit_;
+    }
+
+    const argument_t& IncrementalFitter::capsule () const
+    {
+      return capsule_;
+    }
+
+    const polyhedron_t& IncrementalFitter::hull () const
+    {
+      return hull_;
+    }
+
+    polyhedron_t IncrementalFitter::
+    activePoints () const
+    {
+      polyhedron_t active;
+      for (size_t i = 0; i < points_.size (); ++i)
+	if (!removed_[i] && isActive (points_[i]))
+	  active.push_back (points_[i]);
+      return active;
+    }
+
+    size_t IncrementalFitter::refitCount () const
+    {
+      return refitCount_;
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void IncrementalFitter::
+    notifyAdded (size_t id)
+    {
+      ++size_;
+      added_.push_back (id);
+
+      // A point inside the capsule keeps it feasible, hence optimal.
+      if (!needsRefit_ && capsule_.size () == 7)
+	{
+	  point_t endPoint1;
+	  point_t endPoint2;
+	  value_type radius;
+	  convertSolverParamToCapsule (endPoint1, endPoint2, radius, capsule_);
+	  if (distancePointToSegment<value_type> (points_[id],
+						  endPoint1, endPoint2) > radius)
+	    needsRefit_ = true;
+	}
+    }
+
+    bool IncrementalFitter::
+    isActive (const point_t& point) const
+    {
+      if (capsule_.size () != 7)
+	return false;
+
+      point_t endPoint1;
+      point_t endPoint2;
+      value_type radius;
+      convertSolverParamToCapsule (endPoint1, endPoint2, radius, capsule_);
+      return distancePointToSegment<value_type> (point, endPoint1, endPoint2)
+	>= (1. - activeTolerance_) * radius;
+    }
+
+    bool IncrementalFitter::
+    isHullVertex (const point_t& point) const
+    {
+      // Hull vertices are copies of the input points.
+      BOOST_FOREACH (const point_t& vertex, hull_)
+	if (vertex == point)
+	  return true;
+      return false;
+    }
+
+    void IncrementalFitter::
+    updateHull ()
+    {
+      if (!hullVertexRemoved_ && added_.empty ())
+	return;
+
+      std::vector<point_t> points;
+      if (hullVertexRemoved_)
+	{
+	  // The hull may shrink: start again from all the points.
+	  points.reserve (size_);
+	  for (size_t i = 0; i < points_.size (); ++i)
+	    if (!removed_[i])
+	      points.push_back (points_[i]);
+	}
+      else
+	{
+	  // The hull of the old hull vertices and the new points.
+	  points = hull_;
+	  BOOST_FOREACH (size_t id, added_)
+	    if (!removed_[id])
+	      points.push_back (points_[id]);
+	}
+
+      hull_ = convexHullFromPoints (points);
+      added_.clear ();
+      hullVertexRemoved_ = false;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_INCREMENTAL_FITTER_CC_
@@ -0,0 +1,686 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/mesh-reader.cc
+ *
+ * \brief Implementation of the mesh readers.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MESH_READER_CC_
+# define ROBOPTIM_CAPSULE_MESH_READER_CC_
+
+# include <cctype>
+# include <cstdlib>
+# include <cstring>
+# include <fstream>
+# include <iostream>
+# include <sstream>
+# include <stdexcept>
+# include <algorithm>
+# include <vector>
+
+# include <boost/cstdint.hpp>
+# include <boost/filesystem.hpp>
+
+# include <roboptim/capsule/mesh-reader.hh>
+# include <roboptim/capsule/point-cloud.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Read n bytes, return false if the stream ended first.
+      bool readBytes (std::istream& is, unsigned char* buffer, size_t n)
+      {
+	is.read (reinterpret_cast<char*> (buffer),
+		 static_cast<std::streamsize> (n));
+	return static_cast<size_t> (is.gcount ()) == n;
+      }
+
+      /// \brief Number of bytes left in a stream, or -1 if it is not
+      /// seekable (e.g. the standard input).
+      std::streamoff remainingBytes (std::istream& is)
+      {
+	std::streampos position = is.tellg ();
+	if (position == std::streampos (-1))
+	  return -1;
+
+	is.seekg (0, std::ios::end);
+	std::streampos end = is.tellg ();
+	is.seekg (position);
+	if (end == std::streampos (-1) || !is)
+	  {
+	    is.clear ();
+	    is.seekg (position);
+	    return -1;
+	  }
+
+	return end - position;
+      }
+
+      /// \brief Reserve space for the points announced by a header.
+      ///
+      /// Headers are not trusted: the count is checked against the size
+      /// of the stream first, so that a malformed file cannot request
+      /// an arbitrary amount of memory. Nothing is reserved for streams
+      /// that are not seekable.
+      ///
+      /// \param count number of records announced by the header.
+      /// \param recordSize minimum size of a record, in bytes.
+      /// \param pointsPerRecord points read from each record.
+      /// \return false if the stream is too short for the records.
+      bool reservePoints (std::istream& is, polyhedron_t& points,
+			  size_t count, size_t recordSize,
+			  size_t pointsPerRecord)
+      {
+	std::streamoff remaining = remainingBytes (is);
+	if (remaining < 0)
+	  return true;
+
+	if (count > static_cast<size_t> (remaining) / recordSize)
+	  return false;
+
+	points.reserve (points.size () + pointsPerRecord * count);
+	return true;
+      }
+
+      /// \brief Decode an unsigned integer independently of the host
+      /// byte order.
+      template <typename U>
+      U decodeUnsigned (const unsigned char* buffer, bool bigEndian)
+      {
+	U value = 0;
+	for (size_t i = 0; i < sizeof (U); ++i)
+	  {
+	    size_t k = bigEndian ? i : sizeof (U) - 1 - i;
+	    value = static_cast<U> ((value << 8) | buffer[k]);
+	  }
+	return value;
+      }
+
+      float decodeFloat32 (const unsigned char* buffer, bool bigEndian)
+      {
+	boost::uint32_t bits
+	  = decodeUnsigned<boost::uint32_t> (buffer, bigEndian);
+	float value;
+	std::memcpy (&value, &bits, sizeof (value));
+	return value;
+      }
+
+      double decodeFloat64 (const unsigned char* buffer, bool bigEndian)
+      {
+	boost::uint64_t bits
+	  = decodeUnsigned<boost::uint64_t> (buffer, bigEndian);
+	double value;
+	std::memcpy (&value, &bits, sizeof (value));
+	return value;
+      }
+
+      /// \brief Parse a floating-point token.
+      value_type parseValue (const std::string& token)
+      {
+	const char* begin = token.c_str ();
+	char* end = 0;
+	value_type value = std::strtod (begin, &end);
+	if (end == begin || *end != '\0')
+	  throw std::runtime_error ("invalid number \"" + token + "\"");
+	return value;
+      }
+
+      /// \brief Remove a trailing carriage return (CRLF files).
+      void stripCarriageReturn (std::string& line)
+      {
+	if (!line.empty () && line[line.size () - 1] == '\r')
+	  line.erase (line.size () - 1);
+      }
+
+      // -------------------------- STL ---------------------------
+
+      /// \brief Token-driven ASCII STL parser: every "vertex" keyword
+      /// is followed by 3 coordinates, and every "solid" is closed by
+      /// an "endsolid".
+      class AsciiStlParser
+      {
+      public:
+	explicit AsciiStlParser (polyhedron_t& points)
+	  : points_ (points),
+	    coordinate_ (-1),
+	    closed_ (false)
+	{
+	}
+
+	void operator() (const std::string& token)
+	{
+	  // Binary data read as text, e.g. a truncated binary file whose
+	  // header starts with "solid", contains control bytes.
+	  for (size_t i = 0; i < token.size (); ++i)
+	    if (static_cast<unsigned char> (token[i]) < 0x20
+		|| token[i] == 0x7f)
+	      throw std::runtime_error ("invalid ASCII STL");
+
+	  if (coordinate_ >= 0)
+	    {
+	      point_[coordinate_++] = parseValue (token);
+	      if (coordinate_ == 3)
+		{
+		  points_.push_back (point_);
+		  coordinate_ = -1;
+		}
+	    }
+	  else if (token == "vertex")
+	    coordinate_ = 0;
+	  else if (token == "solid")
+	    closed_ = false;
+	  else if (token == "endsolid")
+	    closed_ = true;
+	}
+
+	void finish () const
+	{
+	  if (coordinate_ >= 0)
+	    throw std::runtime_error ("truncated STL vertex");
+	  if (!closed_)
+	    throw std::runtime_error ("truncated ASCII STL");
+	}
+
+      private:
+	polyhedron_t& points_;
+	point_t point_;
+	int coordinate_;
+	bool closed_;
+      };
+
+      void readStl (std::istream& is, polyhedron_t& points)
+      {
+	// Binary files start with an 80-byte header and the number of
+	// facets. ASCII files start with "solid", which some binary
+	// exporters also write in the header. A binary file has exactly
+	// 50 bytes per facet after the header, which is checked when the
+	// stream is seekable. Otherwise, the keywords of the first facet
+	// are looked for, which fails if the "solid" line is too long.
+	unsigned char header[84];
+	is.read (reinterpret_cast<char*> (header), 84);
+	size_t headerSize = static_cast<size_t> (is.gcount ());
+	std::string prefix (reinterpret_cast<char*> (header), headerSize);
+
+	bool ascii = prefix.compare (0, 5, "solid") == 0;
+	if (ascii && headerSize == 84)
+	  {
+	    std::streamoff remaining = remainingBytes (is);
+	    if (remaining >= 0)
+	      ascii = static_cast<boost::uint64_t> (remaining)
+		!= 50 * static_cast<boost::uint64_t>
+		(decodeUnsigned<boost::uint32_t> (header + 80, false));
+	    else
+	      ascii = prefix.find ("facet", 5) != std::string::npos
+		|| prefix.find ("endsolid", 5) != std::string::npos;
+	  }
+
+	if (ascii)
+	  {
+	    AsciiStlParser parser (points);
+
+	    // The last token of the prefix may continue in the stream.
+	    size_t last = prefix.find_last_of (" \t\r\n");
+	    std::string tail;
+	    if (last != std::string::npos)
+	      {
+		tail = prefix.substr (last + 1);
+		prefix.erase (last + 1);
+	      }
+
+	    std::istringstream prefixStream (prefix);
+	    std::string token;
+	    while (prefixStream >> token)
+	      parser (token);
+
+	    if (!tail.empty ())
+	      {
+		if (is && !std::isspace (is.peek ()) && is >> token)
+		  tail += token;
+		parser (tail);
+	      }
+
+	    while (is >> token)
+	      parser (token);
+	    parser.finish ();
+	    return;
+	  }
+
+	if (headerSize < 84)
+	  throw std::runtime_error ("truncated binary STL header");
+
+	boost::uint32_t nbFacets
+	  = decodeUnsigned<boost::uint32_t> (header + 80, false);
+
+	// Facet: normal, 3 vertices (float32) and attribute byte count.
+	if (!reservePoints (is, points, nbFacets, 50, 3))
+	  throw std::runtime_error ("truncated binary STL");
+
+	unsigned char facet[50];
+	for (boost::uint32_t i = 0; i < nbFacets; ++i)
+	  {
+	    if (!readBytes (is, facet, 50))
+	      throw std::runtime_error ("truncated binary STL");
+
+	    for (size_t v = 0; v < 3; ++v)
+	      {
+		const unsigned char* vertex = facet + 12 + 12 * v;
+		points.push_back (point_t (decodeFloat32 (vertex, false),
+					   decodeFloat32 (vertex + 4, false),
+					   decodeFloat32 (vertex + 8, false)));
+	      }
+	  }
+      }
+
+      // -------------------------- OBJ ---------------------------
+
+      void readObj (std::istream& is, polyhedron_t& points)
+      {
+	std::string line;
+	while (std::getline (is, line))
+	  {
+	    const char* c = line.c_str ();
+	    while (*c == ' ' || *c == '\t')
+	      ++c;
+
+	    // Geometric vertices only: "v x y z [w]".
+	    if (c[0] != 'v' || (c[1] != ' ' && c[1] != '\t'))
+	      continue;
+
+	    point_t point;
+	    const char* begin = c + 1;
+	    for (int i = 0; i < 3; ++i)
+	      {
+		char* end = 0;
+		point[i] = std::strtod (begin, &end);
+		if (end == begin)
+		  throw std::runtime_error ("invalid OBJ vertex \"" + line + "\"");
+		begin = end;
+	      }
+	    points.push_back (point);
+	  }
+      }
+
+      // -------------------------- PLY ---------------------------
+
+      enum PlyEncoding
+	{
+	  PLY_ASCII,
+	  PLY_BINARY_LITTLE_ENDIAN,
+	  PLY_BINARY_BIG_ENDIAN
+	};
+
+      struct PlyProperty
+      {
+	std::string name;
+	/// \brief Scalar type name, or list type for lists.
+	std::string type;
+	bool list;
+      };
+
+      struct PlyElement
+      {
+	std::string name;
+	size_t count;
+	std::vector<PlyProperty> properties;
+      };
+
+      /// \brief Size in bytes of a PLY scalar type.
+      size_t plyTypeSize (const std::string& type)
+      {
+	if (type == "char" || type == "uchar"
+	    || type == "int8" || type == "uint8")
+	  return 1;
+	if (type == "short" || type == "ushort"
+	    || type == "int16" || type == "uint16")
+	  return 2;
+	if (type == "int" || type == "uint" || type == "float"
+	    || type == "int32" || type == "uint32" || type == "float32")
+	  return 4;
+	if (type == "double" || type == "float64")
+	  return 8;
+	throw std::runtime_error ("unknown PLY type \"" + type + "\"");
+      }
+
+      /// \brief Decode a binary PLY scalar.
+      value_type decodePlyScalar (const std::string& type,
+				  const unsigned char* buffer,
+				  bool bigEndian)
+      {
+	if (type == "float" || type == "float32")
+	  return decodeFloat32 (buffer, bigEndian);
+	if (type == "double" || type == "float64")
+	  return decodeFloat64 (buffer, bigEndian);
+	if (type == "char" || type == "int8")
+	  return static_cast<boost::int8_t> (buffer[0]);
+	if (type == "uchar" || type == "uint8")
+	  return buffer[0];
+	if (type == "short" || type == "int16")
+	  return static_cast<boost::int16_t>
+	    (decodeUnsigned<boost::uint16_t> (buffer, bigEndian));
+	if (type == "ushort" || type == "uint16")
+	  return decodeUnsigned<boost::uint16_t> (buffer, bigEndian);
+	if (type == "int" || type == "int32")
+	  return static_cast<boost::int32_t>
+	    (decodeUnsigned<boost::uint32_t> (buffer, bigEndian));
+	return decodeUnsigned<boost::uint32_t> (buffer, bigEndian);
+      }
+
+      void readPly (std::istream& is, polyhedron_t& points)
+      {
+	std::string line;
+	std::getline (is, line);
+	stripCarriageReturn (line);
+	if (line != "ply")
+	  throw std::runtime_error ("missing PLY magic number");
+
+	PlyEncoding encoding = PLY_ASCII;
+	std::vector<PlyElement> elements;
+
+	bool endHeader = false;
+	while (!endHeader && std::getline (is, line))
+	  {
+	    stripCarriageReturn (line);
+	    std::istringstream ss (line);
+	    std::string keyword;
+	    ss >> keyword;
+
+	    if (keyword == "format")
+	      {
+		std::string name;
+		ss >> name;
+		if (name == "ascii")
+		  encoding = PLY_ASCII;
+		else if (name == "binary_little_endian")
+		  encoding = PLY_BINARY_LITTLE_ENDIAN;
+		else if (name == "binary_big_endian")
+		  encoding = PLY_BINARY_BIG_ENDIAN;
+		else
+		  throw std::runtime_error ("unknown PLY format \"" + name + "\"");
+	      }
+	    else if (keyword == "element")
+	      {
+		PlyElement element;
+		if (!(ss >> element.name >> element.count))
+		  throw std::runtime_error ("invalid PLY element \"" + line + "\"");
+		elements.push_back (element);
+	      }
+	    else if (keyword == "property")
+	      {
+		if (elements.empty ())
+		  throw std::runtime_error ("PLY property without element");
+
+		PlyProperty property;
+		ss >> property.type;
+		property.list = (property.type == "list");
+		if (property.list)
+		  {
+		    // Only the type of the elements is kept.
+		    std::string countType;
+		    ss >> countType >> property.type;
+		  }
+		ss >> property.name;
+		elements.back ().properties.push_back (property);
+	      }
+	    else if (keyword == "end_header")
+	      endHeader = true;
+	  }
+
+	if (!endHeader)
+	  throw std::runtime_error ("truncated PLY header");
+
+	bool bigEndian = (encoding == PLY_BINARY_BIG_ENDIAN);
+
+	for (size_t e = 0; e < elements.size (); ++e)
+	  {
+	    const PlyElement& element = elements[e];
+
+	    // Lists have a variable size, so elements are only read up to
+	    // the vertices.
+	    size_t size = 0;
+	    int coordinates[3] = {-1, -1, -1};
+	    for (size_t p = 0; p < element.properties.size (); ++p)
+	      {
+		const PlyProperty& property = element.properties[p];
+		if (property.list)
+		  throw std::runtime_error ("unsupported PLY list property "
+					    "before or in vertex element");
+		size += plyTypeSize (property.type);
+
+		if (property.name == "x")
+		  coordinates[0] = static_cast<int> (p);
+		else if (property.name == "y")
+		  coordinates[1] = static_cast<int> (p);
+		else if (property.name == "z")
+		  coordinates[2] = static_cast<int> (p);
+	      }
+
+	    bool vertex = (element.name == "vertex");
+	    if (vertex && (coordinates[0] < 0 || coordinates[1] < 0
+			   || coordinates[2] < 0))
+	      throw std::runtime_error ("missing PLY vertex coordinates");
+
+	    // ASCII vertices have at least one digit per property, and
+	    // separators between them.
+	    size_t recordSize = (encoding == PLY_ASCII) ?
+	      2 * element.properties.size () - 1 : size;
+	    if (vertex && recordSize > 0
+		&& !reservePoints (is, points, element.count, recordSize, 1))
+	      throw std::runtime_error ("truncated PLY data");
+
+	    std::vector<unsigned char> buffer (size);
+	    std::vector<value_type> values (element.properties.size ());
+	    for (size_t i = 0; i < element.count; ++i)
+	      {
+		if (encoding == PLY_ASCII)
+		  {
+		    if (!std::getline (is, line))
+		      throw std::runtime_error ("truncated PLY data");
+		    if (!vertex)
+		      continue;
+
+		    std::istringstream ss (line);
+		    for (size_t p = 0; p < values.size (); ++p)
+		      if (!(ss >> values[p]))
+			throw std::runtime_error ("invalid PLY vertex \""
+						  + line + "\"");
+		  }
+		else
+		  {
+		    if (!readBytes (is, buffer.data (), size))
+		      throw std::runtime_error ("truncated PLY data");
+		    if (!vertex)
+		      continue;
+
+		    size_t offset = 0;
+		    for (size_t p = 0; p < values.size (); ++p)
+		      {
+			const std::string& type = element.properties[p].type;
+			values[p] = decodePlyScalar (type, &buffer[offset],
+						     bigEndian);
+			offset += plyTypeSize (type);
+		      }
+		  }
+
+		points.push_back (point_t (values[coordinates[0]],
+					   values[coordinates[1]],
+					   values[coordinates[2]]));
+	      }
+
+	    if (vertex)
+	      return;
+	  }
+
+	throw std::runtime_error ("missing PLY vertex element");
+      }
+
+      // -------------------------- XYZ ---------------------------
+
+      void readXyz (std::istream& is, polyhedron_t& points)
+      {
+	unsigned char buffer[24];
+	while (true)
+	  {
+	    is.read (reinterpret_cast<char*> (buffer), 24);
+	    std::streamsize n = is.gcount ();
+	    if (n == 0)
+	      return;
+	    if (n != 24)
+	      throw std::runtime_error ("truncated XYZ data");
+
+	    points.push_back (point_t (decodeFloat64 (buffer, false),
+				       decodeFloat64 (buffer + 8, false),
+				       decodeFloat64 (buffer + 16, false)));
+	  }
+      }
+    } // end of anonymous namespace.
+
+    MeshFormat meshFormatFromName (const std::string& name)
+    {
+      size_t dot = name.find_last_of ('.');
+      std::string extension
+	= (dot == std::string::npos) ? name : name.substr (dot + 1);
+
+      for (size_t i = 0; i < extension.size (); ++i)
+	extension[i] = static_cast<char>
+	  (std::tolower (static_cast<unsigned char> (extension[i])));
+
+      if (extension == "stl")
+	return MESH_STL;
+      if (extension == "obj")
+	return MESH_OBJ;
+      if (extension == "ply")
+	return MESH_PLY;
+      if (extension == "xyz")
+	return MESH_XYZ;
+      if (extension == "rcpc")
+	return MESH_POINT_CLOUD;
+      return MESH_UNKNOWN;
+    }
+
+    void readMeshPoints (std::istream& is, MeshFormat format,
+			 polyhedron_t& points)
+    {
+      switch (format)
+	{
+	case MESH_STL:
+	  readStl (is, points);
+	  break;
+	case MESH_OBJ:
+	  readObj (is, points);
+	  break;
+	case MESH_PLY:
+	  readPly (is, points);
+	  break;
+	case MESH_XYZ:
+	  readXyz (is, points);
+	  break;
+	case MESH_POINT_CLOUD:
+	  {
+	    polyhedrons_t parts;
+	    readPointCloud (is, parts);
+	    for (size_t i = 0; i < parts.size (); ++i)
+	      points.insert (points.end (), parts[i].begin (), parts[i].end ());
+	    break;
+	  }
+	case MESH_UNKNOWN:
+	  throw std::runtime_error ("unknown mesh format");
+	}
+    }
+
+    void readMeshPoints (const std::string& fileName, MeshFormat format,
+			 polyhedron_t& points)
+    {
+      if (format == MESH_UNKNOWN)
+	format = meshFormatFromName (fileName);
+
+      if (format == MESH_UNKNOWN)
+	throw std::runtime_error ("unknown mesh format for \"" + fileName
+				  + "\"");
+
+      if (fileName == "-")
+	{
+	  readMeshPoints (std::cin, format, points);
+	  return;
+	}
+
+      std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+      if (!file)
+	throw std::runtime_error ("cannot open \"" + fileName + "\"");
+
+      readMeshPoints (file, format, points);
+    }
+
+    std::vector<std::string> readManifest (const std::string& fileName)
+    {
+      namespace fs = boost::filesystem;
+
+      std::ifstream file (fileName.c_str ());
+      if (!file)
+	throw std::runtime_error ("cannot open \"" + fileName + "\"");
+
+      fs::path directory = fs::path (fileName).parent_path ();
+
+      std::vector<std::string> inputs;
+      std::string line;
+      while (std::getline (file, line))
+	{
+	  size_t begin = line.find_first_not_of (" \t\r");
+	  if (begin == std::string::npos || line[begin] == '#')
+	    continue;
+	  size_t end = line.find_last_not_of (" \t\r");
+
+	  fs::path input (line.substr (begin, end - begin + 1));
+	  if (input.is_relative ())
+	    input = directory / input;
+	  inputs.push_back (input.string ());
+	}
+
+      return inputs;
+    }
+
+    std::vector<std::string> listMeshFiles (const std::string& directory)
+    {
+      namespace fs = boost::filesystem;
+
+      if (!fs::is_directory (directory))
+	throw std::runtime_error ("\"" + directory + "\" is not a directory");
+
+      std::vector<std::string> inputs;
+      for (fs::directory_iterator it (directory);
+	   it != fs::directory_iterator (); ++it)
+	{
+	  std::string input = it->path ().string ();
+	  if (fs::is_regular_file (it->status ())
+	      && meshFormatFromName (input) != MESH_UNKNOWN)
+	    inputs.push_back (input);
+	}
+
+      // Directory iteration order is unspecified.
+      std::sort (inputs.begin (), inputs.end ());
+      return inputs;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MESH_READER_CC_
@@ -0,0 +1,139 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/mesh-to-point-cloud.cc
+ *
+ * \brief CLI converter from mesh files to point cloud files.
+ */
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <roboptim/capsule/mesh-reader.hh>
+#include <roboptim/capsule/point-cloud.hh>
+
+using namespace roboptim;
+using namespace roboptim::capsule;
+
+int main(int argc, char** argv)
+{
+  try
+    {
+      namespace po = boost::program_options;
+
+      po::options_description desc ("Options");
+      desc.add_options ()
+	("help", "Print this help and exit")
+	("input", po::value<std::vector<std::string> > ()->multitoken (),
+	 "Mesh files (STL, OBJ, PLY or raw float64 XYZ), one part per "
+	 "file, - for the standard input")
+	("format", po::value<std::string> (),
+	 "Input format (stl, obj, ply or xyz), deduced from the file "
+	 "extensions by default")
+	("output", po::value<std::string> (),
+	 "Point cloud file (.rcpc)")
+	("float32", "Store coordinates as float32 instead of float64");
+
+      po::positional_options_description positionalOptions;
+      positionalOptions.add ("input", -1);
+
+      po::variables_map vm;
+
+      try
+	{
+	  po::store (po::command_line_parser (argc, argv)
+		     .options (desc)
+		     .positional (positionalOptions)
+		     .style(
+			    po::command_line_style::unix_style
+			    ^ po::command_line_style::allow_short
+			    )
+		     .run (),
+		     vm);
+
+	  // Display help message
+	  if (vm.count ("help"))
+	    {
+	      std::cout << desc;
+	      return EXIT_SUCCESS;
+	    }
+
+	  if (!vm.count ("input") || !vm.count ("output"))
+	    {
+	      std::cerr << "Error: missing input or output file." << std::endl;
+	      return EXIT_FAILURE;
+	    }
+
+	  MeshFormat format = MESH_UNKNOWN;
+	  if (vm.count ("format"))
+	    {
+	      format = meshFormatFromName (vm["format"].as<std::string> ());
+	      if (format == MESH_UNKNOWN)
+		{
+		  std::cerr << "Error: unknown input format." << std::endl;
+		  return EXIT_FAILURE;
+		}
+	    }
+
+	  const std::vector<std::string>&
+	    inputs = vm["input"].as<std::vector<std::string> > ();
+	  const std::string& output = vm["output"].as<std::string> ();
+
+	  try
+	    {
+	      // Read the meshes, one part per file
+	      polyhedrons_t polyhedrons (inputs.size ());
+	      for (size_t i = 0; i < inputs.size (); ++i)
+		readMeshPoints (inputs[i], format, polyhedrons[i]);
+
+	      std::ofstream file (output.c_str (),
+				  std::ios::out | std::ios::binary);
+	      if (!file)
+		throw std::runtime_error ("cannot open \"" + output + "\"");
+
+	      writePointCloud (file, polyhedrons, vm.count ("float32") > 0);
+	    }
+	  catch (std::runtime_error& e)
+	    {
+	      std::cerr << "Error: " << e.what () << std::endl;
+	      return EXIT_FAILURE;
+	    }
+	}
+      catch (boost::program_options::error& e)
+	{
+	  std::cerr << "Error: " << e.what() << std::endl << std::endl;
+
+	  return EXIT_FAILURE;
+	}
+
+    }
+  catch (std::exception& e)
+    {
+      std::cerr << "Unhandled Exception reached the top of main: "
+		<< e.what() << ", application will now exit" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
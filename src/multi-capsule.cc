@@ -0,0 +1,539 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/multi-capsule.cc
+ *
+ * \brief Implementation of the multi-capsule decomposition and of
+ * CapsuleHierarchy.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_MULTI_CAPSULE_CC_
+# define ROBOPTIM_CAPSULE_MULTI_CAPSULE_CC_
+
+# include <algorithm>
+# include <cstring>
+# include <iostream>
+# include <stdexcept>
+
+# include <boost/bind.hpp>
+# include <boost/cstdint.hpp>
+# include <boost/foreach.hpp>
+# include <boost/thread.hpp>
+
+# include <Eigen/Eigenvalues>
+
+# include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/multi-capsule.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Points covered by one capsule.
+      struct Cluster
+      {
+	/// \brief Points of the cluster.
+	polyhedron_t points;
+
+	/// \brief Capsule parameters.
+	argument_t capsule;
+
+	/// \brief Capsule volume.
+	value_type volume;
+
+	/// \brief Whether the cluster cannot be split further.
+	bool final;
+      };
+
+      /// \brief Fit a capsule to the points of a cluster.
+      void fitCluster (Cluster& cluster, const MultiCapsuleOptions& options)
+      {
+	polyhedrons_t polyhedrons (1, cluster.points);
+
+	// The convex hull only speeds up the optimization.
+	polyhedrons_t convexPolyhedrons;
+	if (options.optimize)
+	  computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
+	else
+	  convexPolyhedrons.swap (polyhedrons);
+
+	point_t P0;
+	point_t P1;
+	value_type r = 0.;
+	argument_t initParam (7);
+	computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
+	convertCapsuleToSolverParam (initParam, P0, P1, r);
+
+	if (options.optimize)
+	  {
+	    Fitter fitter (convexPolyhedrons, options.solver);
+	    fitter.verbose () = false;
+	    fitter.solverLogFile () = "";
+	    fitter.computeBestFitCapsule (initParam);
+	    cluster.capsule = fitter.solutionParam ();
+	  }
+	else
+	  cluster.capsule = initParam;
+
+	// The bounding capsule is not guaranteed to contain all the
+	// points (the solution is verified by the fitter).
+	if (!options.optimize)
+	  inflateToContain (cluster.capsule, convexPolyhedrons);
+
+	cluster.volume = capsuleVolume (cluster.capsule);
+      }
+
+      /// \brief Split a cluster by the plane orthogonal to its principal
+      /// axis going through its centroid.
+      ///
+      /// \return false if one of the halves would be empty.
+      bool splitCluster (const Cluster& cluster, Cluster& first,
+			 Cluster& second, value_type overlap)
+      {
+	point_t centroid = point_t::Zero ();
+	BOOST_FOREACH (const point_t& p, cluster.points)
+	  centroid += p;
+	centroid /= static_cast<value_type> (cluster.points.size ());
+
+	// Eigenvalues are sorted in increasing order.
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d>
+	  eigenSolver (covarianceMatrix (cluster.points));
+	vector3_t axis = eigenSolver.eigenvectors ().col (2);
+
+	first.points.clear ();
+	second.points.clear ();
+	BOOST_FOREACH (const point_t& p, cluster.points)
+	  {
+	    value_type s = (p - centroid).dot (axis);
+	    if (s <= 0.5 * overlap)
+	      first.points.push_back (p);
+	    if (s >= -0.5 * overlap)
+	      second.points.push_back (p);
+	  }
+
+	first.final = second.final = false;
+	return first.points.size () < cluster.points.size ()
+	  && second.points.size () < cluster.points.size ();
+      }
+
+      /// \brief Cluster to split, and the halves it is split into.
+      struct Split
+      {
+	const Cluster* cluster;
+	Cluster* first;
+	Cluster* second;
+
+	/// \brief Whether the cluster was split and its halves fitted.
+	bool split;
+      };
+
+      /// \brief Clusters split and fitted by a pool of workers.
+      ///
+      /// Splitting, bounding capsules and containment inflation run
+      /// concurrently. Convex hulls and optimizations are serialized by
+      /// their own mutexes, so a worker computing a convex hull only
+      /// overlaps the optimization of another one.
+      class ClusterSplitter
+      {
+      public:
+	ClusterSplitter (std::vector<Split>& splits,
+			 const MultiCapsuleOptions& options)
+	  : splits_ (splits),
+	    options_ (options),
+	    next_ (0)
+	{
+	}
+
+	void run ()
+	{
+	  size_t jobs = std::max<size_t>
+	    (1, std::min (options_.jobs, splits_.size ()));
+
+	  if (jobs == 1)
+	    {
+	      work ();
+	      return;
+	    }
+
+	  boost::thread_group workers;
+	  for (size_t i = 0; i < jobs; ++i)
+	    workers.create_thread (boost::bind (&ClusterSplitter::work, this));
+	  workers.join_all ();
+	}
+
+      private:
+	void work ()
+	{
+	  while (true)
+	    {
+	      size_t i;
+	      {
+		boost::mutex::scoped_lock lock (mutex_);
+		if (next_ >= splits_.size ())
+		  return;
+		i = next_++;
+	      }
+
+	      Split& split = splits_[i];
+	      split.split = split.cluster->points.size () >= options_.minPoints
+		&& splitCluster (*split.cluster, *split.first, *split.second,
+				 options_.overlap);
+	      if (split.split)
+		{
+		  fitCluster (*split.first, options_);
+		  fitCluster (*split.second, options_);
+		}
+	    }
+	}
+
+	std::vector<Split>& splits_;
+	const MultiCapsuleOptions& options_;
+	size_t next_;
+	boost::mutex mutex_;
+      };
+
+      bool largerVolume (const Cluster& a, const Cluster& b)
+      {
+	return a.volume > b.volume;
+      }
+
+      const char hierarchyMagic[8] = {'R', 'C', 'L', 'O', 'D', 'C', 'A', 'P'};
+      const boost::uint32_t hierarchyVersion = 1;
+
+      /// \brief Write a little-endian unsigned integer.
+      template <typename U>
+      void writeUnsigned (std::ostream& os, U value)
+      {
+	char buffer[sizeof (U)];
+	for (size_t i = 0; i < sizeof (U); ++i)
+	  buffer[i] = static_cast<char> ((value >> (8 * i)) & 0xff);
+	os.write (buffer, sizeof (U));
+      }
+
+      /// \brief Read a little-endian unsigned integer.
+      template <typename U>
+      U readUnsigned (std::istream& is)
+      {
+	unsigned char buffer[sizeof (U)];
+	is.read (reinterpret_cast<char*> (buffer), sizeof (U));
+	if (static_cast<size_t> (is.gcount ()) != sizeof (U))
+	  throw std::runtime_error ("truncated capsule hierarchy");
+
+	U value = 0;
+	for (size_t i = 0; i < sizeof (U); ++i)
+	  value = static_cast<U> (value | (static_cast<U> (buffer[i]) << (8 * i)));
+	return value;
+      }
+
+      void writeFloat64 (std::ostream& os, double value)
+      {
+	boost::uint64_t bits;
+	std::memcpy (&bits, &value, sizeof (bits));
+	writeUnsigned (os, bits);
+      }
+
+      double readFloat64 (std::istream& is)
+      {
+	boost::uint64_t bits = readUnsigned<boost::uint64_t> (is);
+	double value;
+	std::memcpy (&value, &bits, sizeof (value));
+	return value;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    MultiCapsuleOptions::MultiCapsuleOptions ()
+      : maxCapsules (8),
+	volumeRatio (0.8),
+	overlap (0.),
+	minPoints (8),
+	optimize (true),
+	solver ("ipopt"),
+	jobs (1)
+    {
+    }
+
+    std::vector<argument_t>
+    fitCapsules (const polyhedrons_t& polyhedrons,
+		 const MultiCapsuleOptions& options)
+    {
+      assert (options.maxCapsules > 0 && "Invalid maximum number of capsules.");
+
+      std::vector<Cluster> leaves (1);
+      convertPolyhedronVectorToPolyhedron (leaves[0].points, polyhedrons);
+      leaves[0].final = false;
+      fitCluster (leaves[0], options);
+
+      // Each round splits the largest leaves in parallel, and fits
+      // their halves.
+      while (leaves.size () < options.maxCapsules)
+	{
+	  std::sort (leaves.begin (), leaves.end (), largerVolume);
+
+	  std::vector<size_t> candidates;
+	  for (size_t i = 0; i < leaves.size ()
+		 && leaves.size () + candidates.size () < options.maxCapsules;
+	       ++i)
+	    {
+	      if (leaves[i].final)
+		continue;
+	      if (leaves[i].points.size () < options.minPoints)
+		leaves[i].final = true;
+	      else
+		candidates.push_back (i);
+	    }
+
+	  if (candidates.empty ())
+	    break;
+
+	  std::vector<Cluster> halves (2 * candidates.size ());
+	  std::vector<Split> splits (candidates.size ());
+	  for (size_t i = 0; i < candidates.size (); ++i)
+	    {
+	      splits[i].cluster = &leaves[candidates[i]];
+	      splits[i].first = &halves[2 * i];
+	      splits[i].second = &halves[2 * i + 1];
+	    }
+
+	  ClusterSplitter (splits, options).run ();
+
+	  for (size_t i = 0; i < candidates.size (); ++i)
+	    {
+	      Cluster& leaf = leaves[candidates[i]];
+	      if (!splits[i].split)
+		{
+		  leaf.final = true;
+		  continue;
+		}
+
+	      Cluster& first = halves[2 * i];
+	      Cluster& second = halves[2 * i + 1];
+	      if (first.volume + second.volume < options.volumeRatio * leaf.volume)
+		{
+		  std::swap (leaf, first);
+		  leaves.push_back (second);
+		}
+	      else
+		leaf.final = true;
+	    }
+	}
+
+      std::sort (leaves.begin (), leaves.end (), largerVolume);
+
+      std::vector<argument_t> capsules;
+      BOOST_FOREACH (const Cluster& leaf, leaves)
+	capsules.push_back (leaf.capsule);
+      return capsules;
+    }
+
+    CapsuleHierarchy::CapsuleHierarchy ()
+      : nodes_ ()
+    {
+    }
+
+    CapsuleHierarchy::CapsuleHierarchy (const polyhedrons_t& polyhedrons,
+					size_t maxDepth,
+					const MultiCapsuleOptions& options)
+      : nodes_ ()
+    {
+      // Clusters of the deepest level, and their nodes.
+      std::vector<Cluster> clusters (1);
+      convertPolyhedronVectorToPolyhedron (clusters[0].points, polyhedrons);
+      fitCluster (clusters[0], options);
+      std::vector<size_t> ids (1, addNode (clusters[0].capsule, -1));
+
+      // Each level is built at once: its clusters are split in
+      // parallel, and their halves fitted.
+      for (size_t depth = 0; depth < maxDepth && !clusters.empty (); ++depth)
+	{
+	  std::vector<Cluster> halves (2 * clusters.size ());
+	  std::vector<Split> splits (clusters.size ());
+	  for (size_t i = 0; i < clusters.size (); ++i)
+	    {
+	      splits[i].cluster = &clusters[i];
+	      splits[i].first = &halves[2 * i];
+	      splits[i].second = &halves[2 * i + 1];
+	    }
+
+	  ClusterSplitter (splits, options).run ();
+
+	  std::vector<Cluster> nextClusters;
+	  std::vector<size_t> nextIds;
+	  for (size_t i = 0; i < clusters.size (); ++i)
+	    {
+	      if (!splits[i].split
+		  || halves[2 * i].volume + halves[2 * i + 1].volume
+		  >= options.volumeRatio * clusters[i].volume)
+		continue;
+
+	      for (size_t j = 2 * i; j < 2 * i + 2; ++j)
+		{
+		  nextIds.push_back
+		    (addNode (halves[j].capsule,
+			      static_cast<size_type> (ids[i])));
+		  nextClusters.push_back (Cluster ());
+		  std::swap (nextClusters.back (), halves[j]);
+		}
+	    }
+
+	  clusters.swap (nextClusters);
+	  ids.swap (nextIds);
+	}
+    }
+
+    size_t CapsuleHierarchy::size () const
+    {
+      return nodes_.size ();
+    }
+
+    bool CapsuleHierarchy::empty () const
+    {
+      return nodes_.empty ();
+    }
+
+    const CapsuleHierarchyNode& CapsuleHierarchy::node (size_t i) const
+    {
+      assert (i < nodes_.size () && "Invalid node index.");
+      return nodes_[i];
+    }
+
+    size_t CapsuleHierarchy::depth () const
+    {
+      size_t depth = 0;
+      BOOST_FOREACH (const CapsuleHierarchyNode& node, nodes_)
+	depth = std::max (depth, node.depth);
+      return depth;
+    }
+
+    std::vector<argument_t> CapsuleHierarchy::level (size_t level) const
+    {
+      std::vector<argument_t> capsules;
+      BOOST_FOREACH (const CapsuleHierarchyNode& node, nodes_)
+	if (node.depth == level || (node.depth < level && node.children.empty ()))
+	  capsules.push_back (node.capsule);
+      return capsules;
+    }
+
+    size_t CapsuleHierarchy::addNode (const_argument_ref capsule,
+				      size_type parent)
+    {
+      assert (capsule.size () == 7 && "Incorrect capsule size, expected 7.");
+      assert (parent < static_cast<size_type> (nodes_.size ())
+	      && "Invalid parent index.");
+      assert ((parent >= 0 || nodes_.empty ())
+	      && "Only the first node can be a root.");
+
+      size_t id = nodes_.size ();
+
+      CapsuleHierarchyNode node;
+      node.capsule = capsule;
+      node.parent = parent;
+      node.depth = 0;
+      if (parent >= 0)
+	{
+	  node.depth = nodes_[static_cast<size_t> (parent)].depth + 1;
+	  nodes_[static_cast<size_t> (parent)].children.push_back (id);
+	}
+      nodes_.push_back (node);
+
+      return id;
+    }
+
+    void writeCapsuleHierarchies
+    (std::ostream& os, const CapsuleHierarchy::hierarchies_t& hierarchies)
+    {
+      os.write (hierarchyMagic, sizeof (hierarchyMagic));
+      writeUnsigned (os, hierarchyVersion);
+      writeUnsigned (os, static_cast<boost::uint32_t> (hierarchies.size ()));
+
+      for (size_t i = 0; i < hierarchies.size (); ++i)
+	{
+	  const std::string& name = hierarchies[i].first;
+	  const CapsuleHierarchy& hierarchy = hierarchies[i].second;
+
+	  writeUnsigned (os, static_cast<boost::uint32_t> (name.size ()));
+	  os.write (name.data (), static_cast<std::streamsize> (name.size ()));
+
+	  writeUnsigned (os, static_cast<boost::uint32_t> (hierarchy.size ()));
+	  for (size_t j = 0; j < hierarchy.size (); ++j)
+	    {
+	      const CapsuleHierarchyNode& node = hierarchy.node (j);
+	      writeUnsigned (os, static_cast<boost::uint32_t>
+			     (static_cast<boost::int32_t> (node.parent)));
+	      for (size_type k = 0; k < 7; ++k)
+		writeFloat64 (os, node.capsule[k]);
+	    }
+	}
+
+      if (!os)
+	throw std::runtime_error ("cannot write capsule hierarchies");
+    }
+
+    void readCapsuleHierarchies (std::istream& is,
+				 CapsuleHierarchy::hierarchies_t& hierarchies)
+    {
+      char magic[sizeof (hierarchyMagic)];
+      is.read (magic, sizeof (magic));
+      if (static_cast<size_t> (is.gcount ()) != sizeof (magic)
+	  || std::memcmp (magic, hierarchyMagic, sizeof (magic)) != 0)
+	throw std::runtime_error ("not a capsule hierarchy file");
+
+      if (readUnsigned<boost::uint32_t> (is) != hierarchyVersion)
+	throw std::runtime_error ("unsupported capsule hierarchy version");
+
+      boost::uint32_t nbHierarchies = readUnsigned<boost::uint32_t> (is);
+      for (boost::uint32_t i = 0; i < nbHierarchies; ++i)
+	{
+	  std::string name (readUnsigned<boost::uint32_t> (is), '\0');
+	  if (!name.empty ())
+	    {
+	      is.read (&name[0], static_cast<std::streamsize> (name.size ()));
+	      if (static_cast<size_t> (is.gcount ()) != name.size ())
+		throw std::runtime_error ("truncated capsule hierarchy");
+	    }
+
+	  hierarchies.push_back (std::make_pair (name, CapsuleHierarchy ()));
+	  CapsuleHierarchy& hierarchy = hierarchies.back ().second;
+
+	  boost::uint32_t nbNodes = readUnsigned<boost::uint32_t> (is);
+	  argument_t capsule (7);
+	  for (boost::uint32_t j = 0; j < nbNodes; ++j)
+	    {
+	      size_type parent = static_cast<boost::int32_t>
+		(readUnsigned<boost::uint32_t> (is));
+	      for (size_type k = 0; k < 7; ++k)
+		capsule[k] = readFloat64 (is);
+
+	      // The root has no parent, and parents come first.
+	      if (j == 0 ? parent != -1
+		  : parent < 0 || parent >= static_cast<size_type> (j))
+		throw std::runtime_error ("invalid capsule hierarchy node");
+	      hierarchy.addNode (capsule, parent);
+	    }
+	}
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_MULTI_CAPSULE_CC_
@@ -0,0 +1,398 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/point-cloud.cc
+ *
+ * \brief Implementation of the point cloud file format.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_POINT_CLOUD_CC_
+# define ROBOPTIM_CAPSULE_POINT_CLOUD_CC_
+
+# include <cstring>
+# include <iostream>
+# include <stdexcept>
+
+# include <boost/cstdint.hpp>
+# include <boost/interprocess/file_mapping.hpp>
+# include <boost/interprocess/mapped_region.hpp>
+
+# include <roboptim/capsule/point-cloud.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      const char magic[8] = {'R', 'C', 'P', 'C', 'L', 'O', 'U', 'D'};
+      const boost::uint32_t version = 1;
+      const size_t headerSize = 32;
+
+      /// \brief Coordinates are used in place, which requires a
+      /// little-endian host.
+      bool isLittleEndianHost ()
+      {
+	const boost::uint16_t one = 1;
+	unsigned char first;
+	std::memcpy (&first, &one, 1);
+	return first == 1;
+      }
+
+      template <typename U>
+      U decodeUnsigned (const char* buffer)
+      {
+	const unsigned char* bytes
+	  = reinterpret_cast<const unsigned char*> (buffer);
+	U value = 0;
+	for (size_t i = sizeof (U); i > 0; --i)
+	  value = static_cast<U> ((value << 8) | bytes[i - 1]);
+	return value;
+      }
+
+      template <typename U>
+      void writeUnsigned (std::ostream& os, U value)
+      {
+	char bytes[sizeof (U)];
+	for (size_t i = 0; i < sizeof (U); ++i)
+	  bytes[i] = static_cast<char> ((value >> (8 * i)) & 0xff);
+	os.write (bytes, sizeof (U));
+      }
+
+      template <typename U, typename S>
+      void writeScalar (std::ostream& os, S value)
+      {
+	U bits;
+	std::memcpy (&bits, &value, sizeof (U));
+	writeUnsigned (os, bits);
+      }
+
+      template <typename U, typename S>
+      S decodeScalar (const char* buffer)
+      {
+	U bits = decodeUnsigned<U> (buffer);
+	S value;
+	std::memcpy (&value, &bits, sizeof (S));
+	return value;
+      }
+
+      /// \brief Fixed-size part of the header.
+      struct Header
+      {
+	size_t scalarSize;
+	boost::uint64_t nbPoints;
+	boost::uint64_t nbParts;
+      };
+
+      /// \brief Decode and check the fixed-size part of the header.
+      Header decodeHeader (const char* buffer)
+      {
+	if (std::memcmp (buffer, magic, 8) != 0)
+	  throw std::runtime_error ("not a point cloud");
+
+	if (decodeUnsigned<boost::uint32_t> (buffer + 8) != version)
+	  throw std::runtime_error ("unsupported point cloud version");
+
+	Header header;
+	header.scalarSize = decodeUnsigned<boost::uint32_t> (buffer + 12);
+	if (header.scalarSize != 4 && header.scalarSize != 8)
+	  throw std::runtime_error ("invalid point cloud scalar size");
+
+	header.nbPoints = decodeUnsigned<boost::uint64_t> (buffer + 16);
+	header.nbParts = decodeUnsigned<boost::uint64_t> (buffer + 24);
+	return header;
+      }
+
+      /// \brief Check the part offsets.
+      void checkOffsets (const std::vector<size_t>& offsets,
+			 boost::uint64_t nbPoints)
+      {
+	for (size_t i = 1; i < offsets.size (); ++i)
+	  if (offsets[i] < offsets[i - 1])
+	    throw std::runtime_error ("invalid point cloud part offsets");
+
+	if (offsets.front () != 0 || offsets.back () != nbPoints)
+	  throw std::runtime_error ("invalid point cloud part offsets");
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    PointCloudFile::
+    PointCloudFile (const std::string& fileName)
+      : data_ (0),
+	scalarSize_ (0),
+	size_ (0)
+    {
+      using namespace boost::interprocess;
+
+      if (!isLittleEndianHost ())
+	throw std::runtime_error ("point clouds cannot be mapped on "
+				  "big-endian hosts");
+
+      try
+	{
+	  file_mapping mapping (fileName.c_str (), read_only);
+	  region_.reset (new mapped_region (mapping, read_only));
+	}
+      catch (interprocess_exception& e)
+	{
+	  throw std::runtime_error ("cannot map \"" + fileName + "\": "
+				    + e.what ());
+	}
+
+      const char* begin = static_cast<const char*> (region_->get_address ());
+      size_t fileSize = region_->get_size ();
+
+      if (fileSize < headerSize)
+	throw std::runtime_error ("\"" + fileName + "\" is not a point cloud");
+
+      Header header = decodeHeader (begin);
+      scalarSize_ = header.scalarSize;
+
+      // Check sizes before any multiplication may overflow.
+      size_t available = fileSize - headerSize;
+      if (header.nbParts > 0 && header.nbParts >= available / 8)
+	throw std::runtime_error ("truncated point cloud");
+
+      size_t dataOffset = headerSize;
+      if (header.nbParts > 0)
+	dataOffset += 8 * (static_cast<size_t> (header.nbParts) + 1);
+
+      if (header.nbPoints > (fileSize - dataOffset) / (3 * scalarSize_))
+	throw std::runtime_error ("truncated point cloud");
+
+      size_ = static_cast<size_t> (header.nbPoints);
+      data_ = begin + dataOffset;
+
+      if (header.nbParts == 0)
+	{
+	  offsets_.push_back (0);
+	  offsets_.push_back (size_);
+	}
+      else
+	{
+	  offsets_.resize (static_cast<size_t> (header.nbParts) + 1);
+	  for (size_t i = 0; i < offsets_.size (); ++i)
+	    offsets_[i] = static_cast<size_t>
+	      (decodeUnsigned<boost::uint64_t> (begin + headerSize + 8 * i));
+	  checkOffsets (offsets_, header.nbPoints);
+	}
+    }
+
+    PointCloudFile::
+    ~PointCloudFile ()
+    {
+    }
+
+    size_t PointCloudFile::
+    scalarSize () const
+    {
+      return scalarSize_;
+    }
+
+    size_t PointCloudFile::
+    size () const
+    {
+      return size_;
+    }
+
+    size_t PointCloudFile::
+    nbParts () const
+    {
+      return offsets_.size () - 1;
+    }
+
+    size_t PointCloudFile::
+    partBegin (size_t part) const
+    {
+      assert (part < nbParts () && "Invalid part index.");
+      return offsets_[part];
+    }
+
+    size_t PointCloudFile::
+    partSize (size_t part) const
+    {
+      assert (part < nbParts () && "Invalid part index.");
+      return offsets_[part + 1] - offsets_[part];
+    }
+
+    PointsView<float> PointCloudFile::
+    floatPoints () const
+    {
+      assert (scalarSize_ == 4 && "Point cloud does not contain float32.");
+      return PointsView<float> (reinterpret_cast<const float*> (data_), size_);
+    }
+
+    PointsView<float> PointCloudFile::
+    floatPoints (size_t part) const
+    {
+      assert (scalarSize_ == 4 && "Point cloud does not contain float32.");
+      return PointsView<float>
+	(reinterpret_cast<const float*> (data_) + 3 * partBegin (part),
+	 partSize (part));
+    }
+
+    PointsView<double> PointCloudFile::
+    doublePoints () const
+    {
+      assert (scalarSize_ == 8 && "Point cloud does not contain float64.");
+      return PointsView<double> (reinterpret_cast<const double*> (data_),
+				 size_);
+    }
+
+    PointsView<double> PointCloudFile::
+    doublePoints (size_t part) const
+    {
+      assert (scalarSize_ == 8 && "Point cloud does not contain float64.");
+      return PointsView<double>
+	(reinterpret_cast<const double*> (data_) + 3 * partBegin (part),
+	 partSize (part));
+    }
+
+    void PointCloudFile::
+    polyhedrons (polyhedrons_t& polyhedrons) const
+    {
+      polyhedrons.resize (nbParts ());
+      for (size_t part = 0; part < nbParts (); ++part)
+	{
+	  polyhedron_t& polyhedron = polyhedrons[part];
+	  polyhedron.resize (partSize (part));
+
+	  if (scalarSize_ == 4)
+	    {
+	      PointsView<float> points = floatPoints (part);
+	      for (size_t i = 0; i < points.size (); ++i)
+		polyhedron[i] = points[i];
+	    }
+	  else
+	    {
+	      PointsView<double> points = doublePoints (part);
+	      for (size_t i = 0; i < points.size (); ++i)
+		polyhedron[i] = points[i];
+	    }
+	}
+    }
+
+    void readPointCloud (std::istream& is, polyhedrons_t& polyhedrons)
+    {
+      char buffer[headerSize];
+      is.read (buffer, headerSize);
+      if (static_cast<size_t> (is.gcount ()) != headerSize)
+	throw std::runtime_error ("truncated point cloud");
+
+      Header header = decodeHeader (buffer);
+
+      std::vector<size_t> offsets;
+      if (header.nbParts == 0)
+	{
+	  offsets.push_back (0);
+	  offsets.push_back (static_cast<size_t> (header.nbPoints));
+	}
+      else
+	{
+	  char offset[8];
+	  for (boost::uint64_t i = 0; i <= header.nbParts; ++i)
+	    {
+	      is.read (offset, 8);
+	      if (is.gcount () != 8)
+		throw std::runtime_error ("truncated point cloud");
+	      offsets.push_back (static_cast<size_t>
+				 (decodeUnsigned<boost::uint64_t> (offset)));
+	    }
+	  checkOffsets (offsets, header.nbPoints);
+	}
+
+      // Points are streamed, the size given in the header is only
+      // trusted once the data has been read.
+      char point[24];
+      std::streamsize pointSize
+	= static_cast<std::streamsize> (3 * header.scalarSize);
+      for (size_t part = 0; part + 1 < offsets.size (); ++part)
+	{
+	  polyhedrons.push_back (polyhedron_t ());
+	  polyhedron_t& polyhedron = polyhedrons.back ();
+
+	  for (size_t i = offsets[part]; i < offsets[part + 1]; ++i)
+	    {
+	      is.read (point, pointSize);
+	      if (is.gcount () != pointSize)
+		throw std::runtime_error ("truncated point cloud");
+
+	      if (header.scalarSize == 4)
+		polyhedron.push_back
+		  (point_t (decodeScalar<boost::uint32_t, float> (point),
+			    decodeScalar<boost::uint32_t, float> (point + 4),
+			    decodeScalar<boost::uint32_t, float> (point + 8)));
+	      else
+		polyhedron.push_back
+		  (point_t (decodeScalar<boost::uint64_t, double> (point),
+			    decodeScalar<boost::uint64_t, double> (point + 8),
+			    decodeScalar<boost::uint64_t, double> (point + 16)));
+	    }
+	}
+    }
+
+    void writePointCloud (std::ostream& os, const polyhedrons_t& polyhedrons,
+			  bool singlePrecision)
+    {
+      boost::uint64_t nbPoints = countPoints (polyhedrons);
+      boost::uint64_t nbParts = polyhedrons.size ();
+
+      os.write (magic, 8);
+      writeUnsigned<boost::uint32_t> (os, version);
+      writeUnsigned<boost::uint32_t> (os, singlePrecision ? 4 : 8);
+      writeUnsigned<boost::uint64_t> (os, nbPoints);
+      writeUnsigned<boost::uint64_t> (os, nbParts);
+
+      if (nbParts > 0)
+	{
+	  boost::uint64_t offset = 0;
+	  writeUnsigned<boost::uint64_t> (os, offset);
+	  BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	    {
+	      offset += polyhedron.size ();
+	      writeUnsigned<boost::uint64_t> (os, offset);
+	    }
+	}
+
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	{
+	  BOOST_FOREACH (const point_t& point, polyhedron)
+	    {
+	      for (int i = 0; i < 3; ++i)
+		{
+		  if (singlePrecision)
+		    writeScalar<boost::uint32_t>
+		      (os, static_cast<float> (point[i]));
+		  else
+		    writeScalar<boost::uint64_t> (os, point[i]);
+		}
+	    }
+	}
+
+      if (!os)
+	throw std::runtime_error ("cannot write point cloud");
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_POINT_CLOUD_CC_
@@ -0,0 +1,430 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/result-writer.cc
+ *
+ * \brief Implementation of ResultWriter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_RESULT_WRITER_CC_
+# define ROBOPTIM_CAPSULE_RESULT_WRITER_CC_
+
+# include <cctype>
+# include <cmath>
+# include <cstdio>
+# include <cstring>
+# include <iostream>
+# include <limits>
+
+# include <boost/cstdint.hpp>
+# include <boost/math/special_functions/fpclassify.hpp>
+
+# include <roboptim/core/io.hh>
+
+# include <roboptim/capsule/result-writer.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Get the i-th capsule parameter, NaN if missing.
+      value_type parameter (const argument_t& param, size_type i)
+      {
+	if (param.size () != 7)
+	  return std::numeric_limits<value_type>::quiet_NaN ();
+	return param[i];
+      }
+
+      /// \brief Get the volume of a capsule, NaN if missing.
+      value_type volume (const argument_t& param)
+      {
+	if (param.size () != 7)
+	  return std::numeric_limits<value_type>::quiet_NaN ();
+	return capsuleVolume (param);
+      }
+
+      /// \brief Write a JSON number, null if not finite.
+      void writeJsonNumber (std::ostream& os, double value)
+      {
+	if (boost::math::isfinite (value))
+	  os << value;
+	else
+	  os << "null";
+      }
+
+      /// \brief Write a JSON string literal.
+      void writeJsonString (std::ostream& os, const std::string& s)
+      {
+	os << '"';
+	for (size_t i = 0; i < s.size (); ++i)
+	  {
+	    unsigned char c = static_cast<unsigned char> (s[i]);
+	    switch (c)
+	      {
+	      case '"':  os << "\\\""; break;
+	      case '\\': os << "\\\\"; break;
+	      case '\n': os << "\\n"; break;
+	      case '\r': os << "\\r"; break;
+	      case '\t': os << "\\t"; break;
+	      default:
+		if (c < 0x20)
+		  {
+		    char buffer[8];
+		    std::sprintf (buffer, "\\u%04x", c);
+		    os << buffer;
+		  }
+		else
+		  os << s[i];
+	      }
+	  }
+	os << '"';
+      }
+
+      /// \brief Write a capsule as a JSON object, null if missing.
+      void writeJsonCapsule (std::ostream& os, const argument_t& param)
+      {
+	if (param.size () != 7)
+	  {
+	    os << "null";
+	    return;
+	  }
+
+	os << "{\"p0\":[";
+	for (size_type i = 0; i < 3; ++i)
+	  {
+	    if (i > 0) os << ',';
+	    writeJsonNumber (os, param[i]);
+	  }
+	os << "],\"p1\":[";
+	for (size_type i = 3; i < 6; ++i)
+	  {
+	    if (i > 3) os << ',';
+	    writeJsonNumber (os, param[i]);
+	  }
+	os << "],\"radius\":";
+	writeJsonNumber (os, param[6]);
+	os << ",\"volume\":";
+	writeJsonNumber (os, capsuleVolume (param));
+	os << '}';
+      }
+
+      /// \brief Write a CSV field, quoted if needed.
+      void writeCsvString (std::ostream& os, const std::string& s)
+      {
+	if (s.find_first_of (",\"\r\n") == std::string::npos)
+	  {
+	    os << s;
+	    return;
+	  }
+
+	os << '"';
+	for (size_t i = 0; i < s.size (); ++i)
+	  {
+	    if (s[i] == '"')
+	      os << '"';
+	    os << s[i];
+	  }
+	os << '"';
+      }
+
+      /// \brief Write a CSV number, empty if not finite.
+      void writeCsvNumber (std::ostream& os, double value)
+      {
+	if (boost::math::isfinite (value))
+	  os << value;
+      }
+
+      /// \brief Write a little-endian unsigned integer.
+      template <typename U>
+      void writeUnsigned (std::ostream& os, U value)
+      {
+	char buffer[sizeof (U)];
+	for (size_t i = 0; i < sizeof (U); ++i)
+	  buffer[i] = static_cast<char> ((value >> (8 * i)) & 0xff);
+	os.write (buffer, sizeof (U));
+      }
+
+      /// \brief Write a little-endian float64.
+      void writeFloat64 (std::ostream& os, double value)
+      {
+	boost::uint64_t bits;
+	std::memcpy (&bits, &value, sizeof (bits));
+	writeUnsigned (os, bits);
+      }
+
+      /// \brief Write a length-prefixed string.
+      void writeBinaryString (std::ostream& os, const std::string& s)
+      {
+	writeUnsigned (os, static_cast<boost::uint32_t> (s.size ()));
+	os.write (s.data (), static_cast<std::streamsize> (s.size ()));
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    FitResult::FitResult ()
+      : name (),
+	initParam (),
+	solutionParam (),
+	status (Fitter::NOT_SOLVED),
+	attempts (),
+	loadTime (0.),
+	solveTime (0.),
+	nbHullPoints (0),
+	error ()
+    {
+    }
+
+    const char* solverStatusName (Fitter::SolverStatus status)
+    {
+      switch (status)
+	{
+	case Fitter::NOT_SOLVED:
+	  return "not_solved";
+	case Fitter::SOLUTION_FOUND:
+	  return "solution_found";
+	case Fitter::SOLUTION_WITH_WARNINGS:
+	  return "solution_with_warnings";
+	case Fitter::NO_SOLUTION:
+	  return "no_solution";
+	case Fitter::SOLVER_FAILED:
+	  return "solver_failed";
+	case Fitter::HEURISTIC_SOLUTION:
+	  return "heuristic_solution";
+	}
+      return "unknown";
+    }
+
+    const char* fitStepName (Fitter::FitStep step)
+    {
+      switch (step)
+	{
+	case Fitter::INITIAL_SOLVE:
+	  return "initial_solve";
+	case Fitter::PERTURBED_START:
+	  return "perturbed_start";
+	case Fitter::OTHER_PARAMETERIZATION:
+	  return "other_parameterization";
+	case Fitter::OTHER_SOLVER:
+	  return "other_solver";
+	case Fitter::HEURISTIC:
+	  return "heuristic";
+	}
+      return "unknown";
+    }
+
+    bool parseResultFormat (const std::string& name,
+			    ResultWriter::Format& format)
+    {
+      std::string lower (name);
+      for (size_t i = 0; i < lower.size (); ++i)
+	lower[i] = static_cast<char>
+	  (std::tolower (static_cast<unsigned char> (lower[i])));
+
+      if (lower == "text")
+	format = ResultWriter::TEXT;
+      else if (lower == "json")
+	format = ResultWriter::JSON;
+      else if (lower == "csv")
+	format = ResultWriter::CSV;
+      else if (lower == "binary")
+	format = ResultWriter::BINARY;
+      else
+	return false;
+
+      return true;
+    }
+
+    ResultWriter::ResultWriter (std::ostream& os, Format format)
+      : os_ (os),
+	format_ (format)
+    {
+      switch (format_)
+	{
+	case CSV:
+	  os_ << "name,status,"
+	      << "initial_p0_x,initial_p0_y,initial_p0_z,"
+	      << "initial_p1_x,initial_p1_y,initial_p1_z,"
+	      << "initial_radius,initial_volume,"
+	      << "p0_x,p0_y,p0_z,p1_x,p1_y,p1_z,radius,volume,"
+	      << "load_time,solve_time,hull_points,error,attempts\n";
+	  os_.flush ();
+	  break;
+	case BINARY:
+	  os_.write ("RCRESULT", 8);
+	  writeUnsigned (os_, static_cast<boost::uint32_t> (2));
+	  os_.flush ();
+	  break;
+	case TEXT:
+	case JSON:
+	  break;
+	}
+    }
+
+    ResultWriter::Format ResultWriter::format () const
+    {
+      return format_;
+    }
+
+    void ResultWriter::write (const FitResult& result)
+    {
+      switch (format_)
+	{
+	case TEXT:
+	  writeText (result);
+	  break;
+	case JSON:
+	  writeJson (result);
+	  break;
+	case CSV:
+	  writeCsv (result);
+	  break;
+	case BINARY:
+	  writeBinary (result);
+	  break;
+	}
+
+      // Each record is complete when it is visible to a reader.
+      os_.flush ();
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void ResultWriter::writeText (const FitResult& result)
+    {
+      // Errors are reported by the caller.
+      if (!result.error.empty ())
+	return;
+
+      if (!result.name.empty ())
+	os_ << "Input: " << result.name << std::endl;
+      os_ << "Initial: " << result.initParam << std::endl;
+      os_ << "Solution: " << result.solutionParam << std::endl;
+
+      if (result.attempts.size () > 1)
+	{
+	  os_ << "Fallbacks:";
+	  for (size_t i = 1; i < result.attempts.size (); ++i)
+	    os_ << " " << fitStepName (result.attempts[i].step)
+		<< " (" << solverStatusName (result.attempts[i].status) << ")";
+	  os_ << std::endl;
+	}
+    }
+
+    void ResultWriter::writeJson (const FitResult& result)
+    {
+      std::streamsize precision = os_.precision (17);
+
+      os_ << "{\"name\":";
+      writeJsonString (os_, result.name);
+      os_ << ",\"status\":\"" << solverStatusName (result.status) << '"';
+      os_ << ",\"attempts\":[";
+      for (size_t i = 0; i < result.attempts.size (); ++i)
+	{
+	  if (i > 0) os_ << ',';
+	  os_ << "{\"step\":\"" << fitStepName (result.attempts[i].step)
+	      << "\",\"status\":\""
+	      << solverStatusName (result.attempts[i].status) << "\"}";
+	}
+      os_ << ']';
+      os_ << ",\"initial\":";
+      writeJsonCapsule (os_, result.initParam);
+      os_ << ",\"solution\":";
+      writeJsonCapsule (os_, result.solutionParam);
+      os_ << ",\"load_time\":";
+      writeJsonNumber (os_, result.loadTime);
+      os_ << ",\"solve_time\":";
+      writeJsonNumber (os_, result.solveTime);
+      os_ << ",\"hull_points\":" << result.nbHullPoints;
+      os_ << ",\"error\":";
+      if (result.error.empty ())
+	os_ << "null";
+      else
+	writeJsonString (os_, result.error);
+      os_ << "}\n";
+
+      os_.precision (precision);
+    }
+
+    void ResultWriter::writeCsv (const FitResult& result)
+    {
+      std::streamsize precision = os_.precision (17);
+
+      writeCsvString (os_, result.name);
+      os_ << ',' << solverStatusName (result.status);
+      for (size_type i = 0; i < 7; ++i)
+	{
+	  os_ << ',';
+	  writeCsvNumber (os_, parameter (result.initParam, i));
+	}
+      os_ << ',';
+      writeCsvNumber (os_, volume (result.initParam));
+      for (size_type i = 0; i < 7; ++i)
+	{
+	  os_ << ',';
+	  writeCsvNumber (os_, parameter (result.solutionParam, i));
+	}
+      os_ << ',';
+      writeCsvNumber (os_, volume (result.solutionParam));
+      os_ << ',';
+      writeCsvNumber (os_, result.loadTime);
+      os_ << ',';
+      writeCsvNumber (os_, result.solveTime);
+      os_ << ',' << result.nbHullPoints << ',';
+      writeCsvString (os_, result.error);
+      os_ << ',';
+      for (size_t i = 0; i < result.attempts.size (); ++i)
+	os_ << (i > 0 ? ";" : "") << fitStepName (result.attempts[i].step)
+	    << ':' << solverStatusName (result.attempts[i].status);
+      os_ << '\n';
+
+      os_.precision (precision);
+    }
+
+    void ResultWriter::writeBinary (const FitResult& result)
+    {
+      writeUnsigned (os_, static_cast<boost::uint32_t> (result.status));
+      writeBinaryString (os_, result.name);
+      for (size_type i = 0; i < 7; ++i)
+	writeFloat64 (os_, parameter (result.initParam, i));
+      for (size_type i = 0; i < 7; ++i)
+	writeFloat64 (os_, parameter (result.solutionParam, i));
+      writeFloat64 (os_, volume (result.initParam));
+      writeFloat64 (os_, volume (result.solutionParam));
+      writeFloat64 (os_, result.loadTime);
+      writeFloat64 (os_, result.solveTime);
+      writeUnsigned (os_, static_cast<boost::uint64_t> (result.nbHullPoints));
+      writeBinaryString (os_, result.error);
+      writeUnsigned (os_, static_cast<boost::uint32_t>
+		     (result.attempts.size ()));
+      for (size_t i = 0; i < result.attempts.size (); ++i)
+	{
+	  writeUnsigned (os_, static_cast<boost::uint32_t>
+			 (result.attempts[i].step));
+	  writeUnsigned (os_, static_cast<boost::uint32_t>
+			 (result.attempts[i].status));
+	}
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_RESULT_WRITER_CC_
@@ -0,0 +1,309 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/squared-distance-capsule-points.cc
+ *
+ * \brief Implementation of GenericSquaredDistanceCapsulePoints.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_CC_
+# define ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_CC_
+
+# include <roboptim/capsule/squared-distance-capsule-points.hh>
+
+# include "roboptim/capsule/util.hh"
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 8, 1> smoothGradient_t;
+
+      /// \brief Gradient of the i-th output with respect to the
+      /// capsule parameters (first 7 elements) and to t_i (last
+      /// element).
+      void squaredDistanceGradient (smoothGradient_t& gradient,
+				    const point_t& point,
+				    const_argument_ref argument,
+				    size_type i)
+      {
+	point_t endPoint1 (argument[0], argument[1], argument[2]);
+	point_t endPoint2 (argument[3], argument[4], argument[5]);
+	value_type t = argument[7 + i];
+
+	vector3_t w = (1. - t) * endPoint1 + t * endPoint2 - point;
+
+	gradient.segment<3> (0) = 2. * (1. - t) * w;
+	gradient.segment<3> (3) = 2. * t * w;
+	gradient[6] = -2. * argument[6];
+	gradient[7] = 2. * w.dot (endPoint2 - endPoint1);
+      }
+
+      typedef Eigen::Matrix<value_type, 8, 8> smoothHessian_t;
+
+      /// \brief Hessian of the i-th output with respect to the
+      /// capsule parameters and t_i (same ordering as the gradient).
+      void squaredDistanceHessian (smoothHessian_t& hessian,
+				   const point_t& point,
+				   const_argument_ref argument,
+				   size_type i)
+      {
+	point_t endPoint1 (argument[0], argument[1], argument[2]);
+	point_t endPoint2 (argument[3], argument[4], argument[5]);
+	value_type t = argument[7 + i];
+
+	vector3_t axis = endPoint2 - endPoint1;
+	vector3_t w = (1. - t) * endPoint1 + t * endPoint2 - point;
+	Eigen::Matrix3d identity = Eigen::Matrix3d::Identity ();
+
+	hessian.setZero ();
+
+	hessian.block<3,3> (0, 0) = 2. * (1. - t) * (1. - t) * identity;
+	hessian.block<3,3> (3, 3) = 2. * t * t * identity;
+	hessian.block<3,3> (0, 3) = 2. * t * (1. - t) * identity;
+	hessian.block<3,3> (3, 0) = hessian.block<3,3> (0, 3);
+
+	hessian.block<3,1> (0, 7) = 2. * ((1. - t) * axis - w);
+	hessian.block<3,1> (3, 7) = 2. * (t * axis + w);
+	hessian.block<1,3> (7, 0) = hessian.block<3,1> (0, 7).transpose ();
+	hessian.block<1,3> (7, 3) = hessian.block<3,1> (3, 7).transpose ();
+
+	hessian (6, 6) = -2.;
+	hessian (7, 7) = 2. * axis.squaredNorm ();
+      }
+
+      /// \brief Index in the argument of the i-th local variable.
+      inline size_type globalIndex (size_type local, size_type i)
+      {
+	return (local < 7) ? local : 7 + i;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    template <typename T>
+    GenericSquaredDistanceCapsulePoints<T>::
+    GenericSquaredDistanceCapsulePoints (const polyhedrons_t& polyhedrons,
+					 std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T>
+	(7 + static_cast<size_type> (countPoints (polyhedrons)),
+	 static_cast<size_type> (countPoints (polyhedrons)), name)
+    {
+      points_.reserve (static_cast<size_t> (this->outputSize ()));
+
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	points_.insert (points_.end (), polyhedron.begin (), polyhedron.end ());
+    }
+
+    template <typename T>
+    GenericSquaredDistanceCapsulePoints<T>::
+    ~GenericSquaredDistanceCapsulePoints ()
+    {
+    }
+
+    template <typename T>
+    const polyhedron_t& GenericSquaredDistanceCapsulePoints<T>::
+    points () const
+    {
+      return points_;
+    }
+
+    template <typename T>
+    void GenericSquaredDistanceCapsulePoints<T>::
+    startingPoint (argument_ref x, const_argument_ref capsuleParam) const
+    {
+      assert (capsuleParam.size () == 7
+	      && "Wrong capsule parameters size, expected 7.");
+      assert (x.size () == this->inputSize () && "Wrong argument size.");
+
+      point_t endPoint1 (capsuleParam[0], capsuleParam[1], capsuleParam[2]);
+      point_t endPoint2 (capsuleParam[3], capsuleParam[4], capsuleParam[5]);
+
+      x.head (7) = capsuleParam;
+      for (size_t i = 0; i < points_.size (); ++i)
+	x[7 + static_cast<size_type> (i)]
+	  = projectionParameterOnSegment<value_type> (points_[i],
+						      endPoint1, endPoint2);
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    template <typename T>
+    void GenericSquaredDistanceCapsulePoints<T>::
+    impl_compute (result_ref result,
+		  const_argument_ref argument) const
+    {
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
+
+      point_t endPoint1 (argument[0], argument[1], argument[2]);
+      point_t endPoint2 (argument[3], argument[4], argument[5]);
+
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  size_type id = static_cast<size_type> (i);
+	  value_type t = argument[7 + id];
+	  result[id] = ((1. - t) * endPoint1 + t * endPoint2
+			- points_[i]).squaredNorm ()
+	    - argument[6] * argument[6];
+	}
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixDense>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      smoothGradient_t g;
+      squaredDistanceGradient (g, points_[static_cast<size_t> (functionId)],
+			       argument, functionId);
+
+      gradient.setZero ();
+      gradient.head (7) = g.head<7> ();
+      gradient[7 + functionId] = g[7];
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixSparse>::
+    impl_gradient (gradient_ref gradient,
+		   const_argument_ref argument,
+		   size_type functionId) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      smoothGradient_t g;
+      squaredDistanceGradient (g, points_[static_cast<size_t> (functionId)],
+			       argument, functionId);
+
+      gradient.setZero ();
+      gradient.reserve (8);
+      for (size_type j = 0; j < 7; ++j)
+	gradient.insert (j) = g[j];
+      gradient.insert (7 + functionId) = g[7];
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixDense>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      jacobian.setZero ();
+
+      smoothGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  size_type id = static_cast<size_type> (i);
+	  squaredDistanceGradient (g, points_[i], argument, id);
+	  jacobian.row (id).head (7) = g.head<7> ().transpose ();
+	  jacobian (id, 7 + id) = g[7];
+	}
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixSparse>::
+    impl_jacobian (jacobian_ref jacobian,
+		   const_argument_ref argument) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      // Each row has 8 non-zeros (explicit zeros included), so that
+      // the sparsity pattern never changes between iterations. In
+      // column-major storage, the 7 capsule columns are full and each
+      // auxiliary column has a single non-zero.
+      jacobian.resize (outputSize (), inputSize ());
+      if (jacobian_t::IsRowMajor)
+	jacobian.reserve (Eigen::VectorXi::Constant (jacobian.outerSize (), 8));
+      else
+	{
+	  Eigen::VectorXi sizes
+	    = Eigen::VectorXi::Ones (jacobian.outerSize ());
+	  sizes.head (7).setConstant (static_cast<int> (outputSize ()));
+	  jacobian.reserve (sizes);
+	}
+
+      smoothGradient_t g;
+      for (size_t i = 0; i < points_.size (); ++i)
+	{
+	  size_type id = static_cast<size_type> (i);
+	  squaredDistanceGradient (g, points_[i], argument, id);
+	  for (size_type j = 0; j < 7; ++j)
+	    jacobian.insert (id, j) = g[j];
+	  jacobian.insert (id, 7 + id) = g[7];
+	}
+
+      jacobian.makeCompressed ();
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixDense>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      smoothHessian_t h;
+      squaredDistanceHessian (h, points_[static_cast<size_t> (functionId)],
+			      argument, functionId);
+
+      hessian.setZero ();
+      for (size_type i = 0; i < 8; ++i)
+	for (size_type j = 0; j < 8; ++j)
+	  hessian (globalIndex (i, functionId), globalIndex (j, functionId))
+	    = h (i, j);
+    }
+
+    template <>
+    void GenericSquaredDistanceCapsulePoints<EigenMatrixSparse>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      smoothHessian_t h;
+      squaredDistanceHessian (h, points_[static_cast<size_t> (functionId)],
+			      argument, functionId);
+
+      // The whole 8x8 block is stored to keep a constant structure.
+      hessian.resize (inputSize (), inputSize ());
+      hessian.setZero ();
+      hessian.reserve (64);
+      for (size_type i = 0; i < 8; ++i)
+	for (size_type j = 0; j < 8; ++j)
+	  hessian.insert (globalIndex (i, functionId),
+			  globalIndex (j, functionId)) = h (i, j);
+      hessian.makeCompressed ();
+    }
+
+    // Explicit template instantiations.
+    template class GenericSquaredDistanceCapsulePoints<EigenMatrixDense>;
+    template class GenericSquaredDistanceCapsulePoints<EigenMatrixSparse>;
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_SQUARED_DISTANCE_CAPSULE_POINTS_CC_
@@ -0,0 +1,269 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/stadium-fitter.cc
+ *
+ * \brief Implementation of StadiumFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_STADIUM_FITTER_CC_
+# define ROBOPTIM_CAPSULE_STADIUM_FITTER_CC_
+
+# include <boost/shared_ptr.hpp>
+
+# include <roboptim/capsule/stadium-fitter.hh>
+# include <roboptim/capsule/area.hh>
+# include <roboptim/capsule/distance-stadium-points.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Build and solve the stadium fitting problem.
+      ///
+      /// If no solution is found, the solution falls back to the
+      /// initial parameters.
+      ///
+      /// \tparam T matrix type.
+      /// \return solver status.
+      template <typename T>
+      Fitter::SolverStatus solveStadiumProblem (const polygons_t& polygons,
+				const StadiumFitter& fitter,
+				const std::string& solverName,
+				const_argument_ref initParam,
+				argument_ref solutionParam)
+      {
+	typedef Solver<T> localSolver_t;
+	typedef typename localSolver_t::problem_t problem_t;
+
+	boost::shared_ptr<GenericArea<T> > area (new GenericArea<T> ());
+	problem_t problem (area);
+
+	// The radius must not be negative.
+	problem.argumentBounds ()[4] = Function::makeLowerInterval (0.);
+
+	// Distances must always be negative (points remain inside the
+	// stadium as it shrinks).
+	boost::shared_ptr<GenericDistanceStadiumPoints<T> >
+	  distances (new GenericDistanceStadiumPoints<T> (polygons));
+	size_t nbPoints = distances->points ().size ();
+	Function::intervals_t distanceIntervals
+	  (nbPoints, Function::makeUpperInterval (0.));
+	typename problem_t::scaling_t distanceScaling (nbPoints, 1.);
+	problem.addConstraint (distances, distanceIntervals, distanceScaling);
+
+	problem.startingPoint () = initParam;
+
+	FitterSolver<localSolver_t> fitterSolver (solverName, problem, fitter);
+	localSolver_t& solver = fitterSolver.solver ();
+
+	// The distances are not twice differentiable.
+	solver.parameters ()["ipopt.hessian_approximation"].value
+	  = "limited-memory";
+
+	return fitterSolver.solve (initParam, solutionParam);
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    StadiumFitter::
+    StadiumFitter (const polygons_t& polygons, std::string solver)
+      : polygons_ (polygons),
+	solver_ (solver),
+	initParam_ (vector_t::Zero (5)),
+	solutionParam_ (vector_t::Zero (5)),
+	solverLogFile_ (),
+	verbose_ (false),
+	maxIterations_ (0),
+	maxCpuTime_ (0.),
+	verifyContainment_ (true),
+	radiusInflation_ (0.),
+	useSparseMatrices_ (false),
+	solverStatus_ (Fitter::NOT_SOLVED)
+    {
+    }
+
+    StadiumFitter::
+    ~StadiumFitter ()
+    {
+    }
+
+    const polygons_t& StadiumFitter::
+    polygons () const
+    {
+      return polygons_;
+    }
+
+    void StadiumFitter::
+    polygons (const polygons_t& polygons)
+    {
+      polygons_ = polygons;
+    }
+
+    value_type StadiumFitter::
+    initArea () const
+    {
+      return stadiumArea (initParam_);
+    }
+
+    value_type StadiumFitter::
+    solutionArea () const
+    {
+      return stadiumArea (solutionParam_);
+    }
+
+    const argument_t& StadiumFitter::
+    initParam () const
+    {
+      return initParam_;
+    }
+
+    const argument_t& StadiumFitter::
+    solutionParam () const
+    {
+      return solutionParam_;
+    }
+
+    std::string& StadiumFitter::solverLogFile ()
+    {
+      return solverLogFile_;
+    }
+
+    const std::string& StadiumFitter::solverLogFile () const
+    {
+      return solverLogFile_;
+    }
+
+    bool& StadiumFitter::verbose ()
+    {
+      return verbose_;
+    }
+
+    bool StadiumFitter::verbose () const
+    {
+      return verbose_;
+    }
+
+    size_t& StadiumFitter::maxIterations ()
+    {
+      return maxIterations_;
+    }
+
+    size_t StadiumFitter::maxIterations () const
+    {
+      return maxIterations_;
+    }
+
+    value_type& StadiumFitter::maxCpuTime ()
+    {
+      return maxCpuTime_;
+    }
+
+    value_type StadiumFitter::maxCpuTime () const
+    {
+      return maxCpuTime_;
+    }
+
+    bool& StadiumFitter::verifyContainment ()
+    {
+      return verifyContainment_;
+    }
+
+    bool StadiumFitter::verifyContainment () const
+    {
+      return verifyContainment_;
+    }
+
+    value_type StadiumFitter::radiusInflation () const
+    {
+      return radiusInflation_;
+    }
+
+    bool& StadiumFitter::useSparseMatrices ()
+    {
+      return useSparseMatrices_;
+    }
+
+    bool StadiumFitter::useSparseMatrices () const
+    {
+      return useSparseMatrices_;
+    }
+
+    Fitter::SolverStatus StadiumFitter::solverStatus () const
+    {
+      return solverStatus_;
+    }
+
+    void StadiumFitter::
+    computeBestFitStadium (const_argument_ref initParam)
+    {
+      impl_computeBestFitStadium (polygons_, initParam);
+    }
+
+    void StadiumFitter::
+    computeBestFitStadium (const polygons_t& polygons,
+			   const_argument_ref initParam)
+    {
+      impl_computeBestFitStadium (polygons, initParam);
+    }
+
+    // -------------------PROTECTED FUNCTIONS--------------------
+
+    void StadiumFitter::
+    impl_computeBestFitStadium (const polygons_t& polygons,
+				const_argument_ref initParam)
+    {
+      assert (polygons.size () != 0 && "Empty polygon vector");
+      assert (initParam.size () == 5
+	      && "Incorrect initParam size, expected 5.");
+
+      initParam_ = initParam;
+      argument_t solutionParam (5);
+
+      if (useSparseMatrices_)
+	{
+	  // The sparse Ipopt plugin is named differently.
+	  std::string solverName = solver_;
+	  if (solverName == "ipopt")
+	    solverName = "ipopt-sparse";
+
+	  solverStatus_ = solveStadiumProblem<EigenMatrixSparse>
+	    (polygons, *this, solverName, initParam, solutionParam);
+	}
+      else
+	solverStatus_ = solveStadiumProblem<EigenMatrixDense>
+	  (polygons, *this, solver_, initParam, solutionParam);
+
+      // The solution satisfies the constraints up to the solver
+      // tolerances.
+      radiusInflation_ = 0.;
+      if (verifyContainment_)
+	radiusInflation_ = inflateToContain (solutionParam, polygons);
+
+      solutionParam_ = solutionParam;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_STADIUM_FITTER_CC_
@@ -0,0 +1,197 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/swept-capsule.cc
+ *
+ * \brief Implementation of the swept capsule fitting.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_SWEPT_CAPSULE_CC_
+# define ROBOPTIM_CAPSULE_SWEPT_CAPSULE_CC_
+
+# include <algorithm>
+# include <cmath>
+
+# include <boost/bind.hpp>
+# include <boost/foreach.hpp>
+# include <boost/thread.hpp>
+
+# include <roboptim/capsule/fitter.hh>
+# include <roboptim/capsule/swept-capsule.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Transform points by the poses of a range of samples.
+      ///
+      /// Samples write disjoint parts of the output, so ranges can be
+      /// transformed in parallel.
+      void transformRange (const polyhedron_t& points,
+			   const poses_t& samples,
+			   size_t begin, size_t end,
+			   polyhedron_t& sweptPoints)
+      {
+	for (size_t i = begin; i < end; ++i)
+	  {
+	    const Eigen::Isometry3d& pose = samples[i];
+	    size_t offset = i * points.size ();
+	    for (size_t j = 0; j < points.size (); ++j)
+	      sweptPoints[offset + j] = pose * points[j];
+	  }
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    SweptCapsuleOptions::SweptCapsuleOptions ()
+      : maxStep (0.01),
+	maxSamplesPerInterval (64),
+	conservative (true),
+	optimize (true),
+	solver ("ipopt"),
+	jobs (1)
+    {
+    }
+
+    value_type sampleSweptPoints (const polyhedron_t& points,
+				  const poses_t& poses,
+				  const SweptCapsuleOptions& options,
+				  polyhedron_t& sweptPoints)
+    {
+      assert (!poses.empty () && "Empty motion.");
+      assert (options.maxStep > 0. && "Invalid sampling step.");
+
+      // Largest distance from a point to the link frame origin: it
+      // bounds the displacement due to rotations.
+      value_type maxRadius = 0.;
+      BOOST_FOREACH (const point_t& p, points)
+	maxRadius = std::max (maxRadius, p.norm ());
+
+      // Interpolated poses. The speed of a point is bounded by the
+      // translation speed plus the angular speed times its radius.
+      poses_t samples;
+      value_type maxSampleStep = 0.;
+      for (size_t i = 0; i + 1 < poses.size (); ++i)
+	{
+	  Eigen::Quaterniond q0 (poses[i].linear ());
+	  Eigen::Quaterniond q1 (poses[i + 1].linear ());
+	  vector3_t t0 = poses[i].translation ();
+	  vector3_t t1 = poses[i + 1].translation ();
+
+	  value_type pathLength = (t1 - t0).norm ()
+	    + q0.angularDistance (q1) * maxRadius;
+
+	  size_t n = static_cast<size_t>
+	    (std::ceil (pathLength / options.maxStep));
+	  n = std::max<size_t> (1, std::min (n, options.maxSamplesPerInterval));
+	  maxSampleStep = std::max (maxSampleStep,
+				    pathLength / static_cast<value_type> (n));
+
+	  for (size_t k = 0; k < n; ++k)
+	    {
+	      value_type s = static_cast<value_type> (k)
+		/ static_cast<value_type> (n);
+	      Eigen::Isometry3d sample = Eigen::Isometry3d::Identity ();
+	      sample.linear () = q0.slerp (s, q1).toRotationMatrix ();
+	      sample.translation () = (1. - s) * t0 + s * t1;
+	      samples.push_back (sample);
+	    }
+	}
+      samples.push_back (poses.back ());
+
+      sweptPoints.resize (samples.size () * points.size ());
+
+      size_t jobs = std::max<size_t> (1, std::min (options.jobs,
+						   samples.size ()));
+      if (jobs == 1)
+	transformRange (points, samples, 0, samples.size (), sweptPoints);
+      else
+	{
+	  boost::thread_group workers;
+	  for (size_t i = 0; i < jobs; ++i)
+	    workers.create_thread
+	      (boost::bind (&transformRange, boost::cref (points),
+			    boost::cref (samples),
+			    i * samples.size () / jobs,
+			    (i + 1) * samples.size () / jobs,
+			    boost::ref (sweptPoints)));
+	  workers.join_all ();
+	}
+
+      // Any point of the motion is within half a step of a sample.
+      return 0.5 * maxSampleStep;
+    }
+
+    argument_t fitSweptCapsule (const polyhedrons_t& polyhedrons,
+				const poses_t& poses,
+				const SweptCapsuleOptions& options)
+    {
+      // Only the vertices of the convex hull need to be moved.
+      polyhedrons_t linkPolyhedrons;
+      if (options.optimize)
+	computeConvexPolyhedron (polyhedrons, linkPolyhedrons);
+      else
+	linkPolyhedrons = polyhedrons;
+
+      polyhedron_t linkPoints;
+      convertPolyhedronVectorToPolyhedron (linkPoints, linkPolyhedrons);
+
+      polyhedrons_t swept (1);
+      value_type samplingError = sampleSweptPoints (linkPoints, poses, options,
+						    swept[0]);
+
+      // The samples overlap a lot: their convex hull is much smaller.
+      polyhedrons_t convexPolyhedrons;
+      if (options.optimize)
+	computeConvexPolyhedron (swept, convexPolyhedrons);
+      else
+	convexPolyhedrons.swap (swept);
+
+      point_t P0;
+      point_t P1;
+      value_type r = 0.;
+      argument_t capsule (7);
+      computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
+      convertCapsuleToSolverParam (capsule, P0, P1, r);
+
+      if (options.optimize)
+	{
+	  Fitter fitter (convexPolyhedrons, options.solver);
+	  fitter.verbose () = false;
+	  fitter.solverLogFile () = "";
+	  fitter.computeBestFitCapsule (capsule);
+	  capsule = fitter.solutionParam ();
+	}
+      else
+	inflateToContain (capsule, convexPolyhedrons);
+
+      if (options.conservative)
+	capsule[6] += samplingError;
+
+      return capsule;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_SWEPT_CAPSULE_CC_
@@ -0,0 +1,277 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+
+/**
+ * \file src/tracking-fitter.cc
+ *
+ * \brief Implementation of TrackingFitter.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_TRACKING_FITTER_CC_
+# define ROBOPTIM_CAPSULE_TRACKING_FITTER_CC_
+
+# include <cmath>
+
+# include <boost/foreach.hpp>
+# include <boost/functional/hash.hpp>
+# include <boost/unordered_set.hpp>
+
+# include <roboptim/capsule/tracking-fitter.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      /// \brief Cell of the spatial hash.
+      struct Cell
+      {
+	long x;
+	long y;
+	long z;
+
+	bool operator== (const Cell& other) const
+	{
+	  return x == other.x && y == other.y && z == other.z;
+	}
+      };
+
+      std::size_t hash_value (const Cell& cell)
+      {
+	std::size_t seed = 0;
+	boost::hash_combine (seed, cell.x);
+	boost::hash_combine (seed, cell.y);
+	boost::hash_combine (seed, cell.z);
+	return seed;
+      }
+
+      /// \brief Keep the first point of each cell of a grid anchored
+      /// at origin.
+      void subsample (polyhedron_t& subsampled, const polyhedron_t& points,
+		      const point_t& origin, value_type cellSize)
+      {
+	boost::unordered_set<Cell> cells;
+	cells.rehash (points.size ());
+
+	subsampled.clear ();
+	BOOST_FOREACH (const point_t& p, points)
+	  {
+	    const point_t offset = (p - origin) / cellSize;
+	    Cell cell;
+	    cell.x = static_cast<long> (std::floor (offset[0]));
+	    cell.y = static_cast<long> (std::floor (offset[1]));
+	    cell.z = static_cast<long> (std::floor (offset[2]));
+	    if (cells.insert (cell).second)
+	      subsampled.push_back (p);
+	  }
+      }
+
+      /// \brief Copy a view into a point vector.
+      template <typename S>
+      void copyPoints (polyhedron_t& dst, const PointsView<S>& points)
+      {
+	dst.resize (points.size ());
+	for (size_t i = 0; i < points.size (); ++i)
+	  dst[i] = points[i];
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    value_type subsamplePoints (polyhedron_t& subsampled,
+				const std::vector<point_t>& points,
+				value_type cellSize, size_t maxPoints)
+    {
+      assert (cellSize > 0. && "Invalid cell size.");
+
+      if (points.empty ())
+	{
+	  subsampled.clear ();
+	  return cellSize;
+	}
+
+      // Anchor the grid at the bounding box, half a cell below its
+      // minimum so that regularly spaced points do not lie on cell
+      // boundaries. The origin is kept when the cells are doubled, so
+      // that coarser cells are unions of finer ones.
+      point_t min = points[0];
+      point_t max = points[0];
+      BOOST_FOREACH (const point_t& p, points)
+	{
+	  min = min.cwiseMin (p);
+	  max = max.cwiseMax (p);
+	}
+      const point_t origin = min - point_t::Constant (.5 * cellSize);
+
+      // Once a single cell covers the bounding box, all points are
+      // merged and doubling again is useless.
+      const value_type span = (max - origin).maxCoeff ();
+
+      subsample (subsampled, points, origin, cellSize);
+
+      // Coarser cells only merge points: subsample the result again.
+      polyhedron_t coarser;
+      while (maxPoints > 0 && subsampled.size () > maxPoints
+	     && cellSize <= span)
+	{
+	  cellSize *= 2.;
+	  subsample (coarser, subsampled, origin, cellSize);
+	  subsampled.swap (coarser);
+	}
+
+      return cellSize;
+    }
+
+    TrackingFitter::
+    TrackingFitter (std::string solver)
+      : fitter_ (polyhedrons_t (1), solver),
+	cellSize_ (0.01),
+	maxPoints_ (256),
+	frame_ (1),
+	subsampled_ (1),
+	capsule_ (),
+	frameCount_ (0)
+    {
+      fitter_.verbose () = false;
+      fitter_.solverLogFile () = "";
+      fitter_.maxIterations () = 50;
+      fitter_.fallbacks ().clear ();
+      fitter_.fallbacks ().push_back (Fitter::HEURISTIC);
+    }
+
+    TrackingFitter::
+    ~TrackingFitter ()
+    {
+    }
+
+    Fitter& TrackingFitter::fitter ()
+    {
+      return fitter_;
+    }
+
+    const Fitter& TrackingFitter::fitter () const
+    {
+      return fitter_;
+    }
+
+    value_type& TrackingFitter::cellSize ()
+    {
+      return cellSize_;
+    }
+
+    value_type TrackingFitter::cellSize () const
+    {
+      return cellSize_;
+    }
+
+    size_t& TrackingFitter::maxPoints ()
+    {
+      return maxPoints_;
+    }
+
+    size_t TrackingFitter::maxPoints () const
+    {
+      return maxPoints_;
+    }
+
+    const argument_t& TrackingFitter::
+    update (const std::vector<point_t>& points)
+    {
+      frame_[0] = points;
+      fitFrame ();
+      return capsule_;
+    }
+
+    const argument_t& TrackingFitter::
+    update (const PointsView<float>& points)
+    {
+      copyPoints (frame_[0], points);
+      fitFrame ();
+      return capsule_;
+    }
+
+    const argument_t& TrackingFitter::
+    update (const PointsView<double>& points)
+    {
+      copyPoints (frame_[0], points);
+      fitFrame ();
+      return capsule_;
+    }
+
+    void TrackingFitter::
+    reset ()
+    {
+      capsule_.resize (0);
+      frameCount_ = 0;
+    }
+
+    const argument_t& TrackingFitter::capsule () const
+    {
+      return capsule_;
+    }
+
+    size_t TrackingFitter::frameCount () const
+    {
+      return frameCount_;
+    }
+
+    const polyhedron_t& TrackingFitter::subsampledPoints () const
+    {
+      return subsampled_[0];
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void TrackingFitter::
+    fitFrame ()
+    {
+      assert (!frame_[0].empty () && "Empty frame.");
+
+      if (cellSize_ > 0.)
+	subsamplePoints (subsampled_[0], frame_[0], cellSize_, maxPoints_);
+      else
+	subsampled_[0] = frame_[0];
+
+      // Warm start from the previous frame, made feasible.
+      argument_t initParam (7);
+      if (capsule_.size () == 7)
+	initParam = capsule_;
+      else
+	{
+	  Capsule capsule = capsuleFromPoints (subsampled_[0]);
+	  convertCapsuleToSolverParam (initParam, capsule.P0, capsule.P1,
+				       capsule.radius);
+	}
+      inflateToContain (initParam, subsampled_);
+
+      fitter_.computeBestFitCapsule (subsampled_, initParam);
+      capsule_ = fitter_.solutionParam ();
+
+      // Points dropped by the subsampling must be contained too.
+      inflateToContain (capsule_, frame_);
+
+      ++frameCount_;
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_TRACKING_FITTER_CC_
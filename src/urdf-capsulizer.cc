@@ -0,0 +1,281 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/urdf-capsulizer.cc
+ *
+ * \brief CLI tool replacing the collision geometries of a URDF robot
+ * description with capsules.
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/program_options.hpp>
+#include <boost/thread.hpp>
+
+#include <roboptim/capsule/fitter.hh>
+#include <roboptim/capsule/urdf.hh>
+#include <roboptim/capsule/util.hh>
+
+using namespace roboptim;
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// \brief Links of a model fitted by a pool of workers.
+  class Capsulizer
+  {
+  public:
+    Capsulizer (UrdfModel& model, const std::string& solver)
+      : model_ (model),
+	solver_ (solver),
+	next_ (0),
+	failures_ (0)
+    {
+    }
+
+    /// \brief Fit capsules to all the links of the model.
+    ///
+    /// \param jobs number of workers.
+    /// \return number of links that could not be fitted.
+    size_t run (size_t jobs)
+    {
+      jobs = std::max<size_t> (1, std::min (jobs, model_.links ().size ()));
+
+      boost::thread_group workers;
+      for (size_t i = 0; i < jobs; ++i)
+	workers.create_thread (boost::bind (&Capsulizer::work, this));
+      workers.join_all ();
+
+      return failures_;
+    }
+
+  private:
+    /// \brief Worker loop: fit links until there is none left.
+    void work ()
+    {
+      while (true)
+	{
+	  size_t i;
+	  {
+	    boost::mutex::scoped_lock lock (mutex_);
+	    if (next_ >= model_.links ().size ())
+	      return;
+	    i = next_++;
+	  }
+
+	  process (i);
+	}
+    }
+
+    /// \brief Fit a capsule to the i-th link.
+    void process (size_t i)
+    {
+      const UrdfLink& link = model_.links ()[i];
+
+      try
+	{
+	  // Points are expressed in the link frame, and so is the
+	  // capsule.
+	  polyhedrons_t polyhedrons (1);
+	  readLinkPoints (link, polyhedrons[0]);
+	  if (polyhedrons[0].empty ())
+	    throw std::runtime_error ("no point to encapsulate");
+
+	  polyhedrons_t convexPolyhedrons;
+	  computeConvexPolyhedron (polyhedrons, convexPolyhedrons);
+
+	  point_t P0;
+	  point_t P1;
+	  value_type r = 0.;
+	  argument_t initParam (7);
+	  computeBoundingCapsulePolyhedron (convexPolyhedrons, P0, P1, r);
+	  convertCapsuleToSolverParam (initParam, P0, P1, r);
+
+	  Fitter fitter (convexPolyhedrons, solver_);
+	  fitter.verbose () = false;
+	  fitter.solverLogFile () = "";
+	  fitter.computeBestFitCapsule (initParam);
+
+	  boost::mutex::scoped_lock lock (mutex_);
+	  model_.setCapsule (i, fitter.solutionParam ());
+	  std::cerr << "Link " << link.name << ": radius "
+		    << fitter.solutionParam ()[6] << std::endl;
+	}
+      catch (std::exception& e)
+	{
+	  boost::mutex::scoped_lock lock (mutex_);
+	  std::cerr << "Warning: link " << link.name << " is left unchanged: "
+		    << e.what () << std::endl;
+	  ++failures_;
+	}
+    }
+
+    /// \brief Robot model.
+    UrdfModel& model_;
+
+    /// \brief Nonlinear solver.
+    const std::string& solver_;
+
+    /// \brief Index of the next link to fit.
+    size_t next_;
+
+    /// \brief Number of failed links.
+    size_t failures_;
+
+    boost::mutex mutex_;
+  };
+} // end of anonymous namespace.
+
+int main(int argc, char** argv)
+{
+  try
+    {
+      namespace po = boost::program_options;
+
+      po::options_description desc ("Options");
+      desc.add_options ()
+	("help", "Print this help and exit")
+	("input", po::value<std::string> (), "URDF file")
+	("output", po::value<std::string> (),
+	 "Capsulized URDF file, - or nothing for the standard output")
+	("package", po::value<std::vector<std::string> > ()->multitoken (),
+	 "Package directory, e.g. my_robot=/path/to/my_robot (packages "
+	 "are also looked for in ROS_PACKAGE_PATH)")
+	("geometry", po::value<std::string> ()->default_value ("cylinder"),
+	 "Capsule geometry: cylinder (a cylinder and two spheres) or "
+	 "capsule (non-standard capsule element)")
+	("solver", po::value<std::string> ()->default_value ("ipopt"),
+	 "Nonlinear solver used")
+	("jobs", po::value<unsigned> ()->default_value (1),
+	 "Number of parallel fits, 0 for one per core (the optimizations "
+	 "themselves run one at a time)");
+
+      po::positional_options_description positionalOptions;
+      positionalOptions.add ("input", 1);
+
+      po::variables_map vm;
+
+      try
+	{
+	  po::store (po::command_line_parser (argc, argv)
+		     .options (desc)
+		     .positional (positionalOptions)
+		     .style(
+			    po::command_line_style::unix_style
+			    ^ po::command_line_style::allow_short
+			    )
+		     .run (),
+		     vm);
+
+	  // Display help message
+	  if (vm.count ("help"))
+	    {
+	      std::cout << desc;
+	      return EXIT_SUCCESS;
+	    }
+
+	  if (!vm.count ("input"))
+	    {
+	      std::cerr << "Error: missing URDF file." << std::endl;
+	      return EXIT_FAILURE;
+	    }
+
+	  UrdfModel::CapsuleGeometry geometry;
+	  const std::string& geometryName = vm["geometry"].as<std::string> ();
+	  if (geometryName == "cylinder")
+	    geometry = UrdfModel::CYLINDER_SPHERES;
+	  else if (geometryName == "capsule")
+	    geometry = UrdfModel::CAPSULE;
+	  else
+	    {
+	      std::cerr << "Error: unknown capsule geometry." << std::endl;
+	      return EXIT_FAILURE;
+	    }
+
+	  // Load (optional) package directories
+	  packages_t packages;
+	  if (vm.count ("package"))
+	    {
+	      const std::vector<std::string>& args
+		= vm["package"].as<std::vector<std::string> > ();
+	      for (size_t i = 0; i < args.size (); ++i)
+		{
+		  size_t separator = args[i].find ('=');
+		  if (separator == std::string::npos)
+		    {
+		      std::cerr << "Error: packages should be given as "
+				<< "name=directory." << std::endl;
+		      return EXIT_FAILURE;
+		    }
+		  packages[args[i].substr (0, separator)]
+		    = args[i].substr (separator + 1);
+		}
+	    }
+
+	  size_t jobs = vm["jobs"].as<unsigned> ();
+	  if (jobs == 0)
+	    jobs = boost::thread::hardware_concurrency ();
+
+	  try
+	    {
+	      UrdfModel model (vm["input"].as<std::string> (), packages);
+
+	      Capsulizer capsulizer (model, vm["solver"].as<std::string> ());
+	      capsulizer.run (jobs);
+
+	      if (vm.count ("output") && vm["output"].as<std::string> () != "-")
+		{
+		  const std::string& output = vm["output"].as<std::string> ();
+		  std::ofstream file (output.c_str ());
+		  if (!file)
+		    throw std::runtime_error ("cannot open \"" + output + "\"");
+		  model.write (file, geometry);
+		}
+	      else
+		model.write (std::cout, geometry);
+	    }
+	  catch (std::runtime_error& e)
+	    {
+	      std::cerr << "Error: " << e.what () << std::endl;
+	      return EXIT_FAILURE;
+	    }
+	}
+      catch (boost::program_options::error& e)
+	{
+	  std::cerr << "Error: " << e.what() << std::endl << std::endl;
+
+	  return EXIT_FAILURE;
+	}
+
+    }
+  catch (std::exception& e)
+    {
+      std::cerr << "Unhandled Exception reached the top of main: "
+		<< e.what() << ", application will now exit" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,463 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it
+// and/or modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation, either
+// version 3 of the License, or (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be
+// useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+// of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with roboptim-capsule.  If not, see
+// <http://www.gnu.org/licenses/>.
+
+/**
+ * \file src/urdf.cc
+ *
+ * \brief Implementation of UrdfModel.
+ */
+
+#ifndef ROBOPTIM_CAPSULE_URDF_CC_
+# define ROBOPTIM_CAPSULE_URDF_CC_
+
+# include <cmath>
+# include <cstdlib>
+# include <fstream>
+# include <iostream>
+# include <sstream>
+# include <stdexcept>
+
+# include <boost/filesystem.hpp>
+# include <boost/foreach.hpp>
+# include <boost/property_tree/xml_parser.hpp>
+
+# include <roboptim/capsule/mesh-reader.hh>
+# include <roboptim/capsule/urdf.hh>
+# include <roboptim/capsule/util.hh>
+
+namespace roboptim
+{
+  namespace capsule
+  {
+    namespace
+    {
+      typedef boost::property_tree::ptree ptree;
+
+      /// \brief Number of sides of the prisms circumscribed to
+      /// cylinders.
+      const int cylinderSides = 16;
+
+      /// \brief Parse a vector attribute, e.g. "0 0.1 0".
+      vector3_t parseVector (const std::string& s)
+      {
+	std::istringstream ss (s);
+	vector3_t v;
+	if (!(ss >> v[0] >> v[1] >> v[2]))
+	  throw std::runtime_error ("invalid vector \"" + s + "\"");
+	return v;
+      }
+
+      /// \brief Format a vector attribute.
+      std::string formatVector (const vector3_t& v)
+      {
+	std::ostringstream ss;
+	ss.precision (12);
+	ss << v[0] << " " << v[1] << " " << v[2];
+	return ss.str ();
+      }
+
+      /// \brief Format a scalar attribute.
+      std::string formatScalar (value_type x)
+      {
+	std::ostringstream ss;
+	ss.precision (12);
+	ss << x;
+	return ss.str ();
+      }
+
+      /// \brief Parse the optional <origin xyz="" rpy=""/> child of an
+      /// element. URDF angles are fixed-axis roll, pitch and yaw.
+      Eigen::Isometry3d parseOrigin (const ptree& element)
+      {
+	vector3_t xyz = parseVector
+	  (element.get<std::string> ("origin.<xmlattr>.xyz", "0 0 0"));
+	vector3_t rpy = parseVector
+	  (element.get<std::string> ("origin.<xmlattr>.rpy", "0 0 0"));
+
+	Eigen::Isometry3d origin = Eigen::Isometry3d::Identity ();
+	origin.translation () = xyz;
+	origin.linear ()
+	  = (Eigen::AngleAxisd (rpy[2], vector3_t::UnitZ ())
+	     * Eigen::AngleAxisd (rpy[1], vector3_t::UnitY ())
+	     * Eigen::AngleAxisd (rpy[0], vector3_t::UnitX ()))
+	  .toRotationMatrix ();
+	return origin;
+      }
+
+      /// \brief Build an <origin/> element.
+      ptree makeOrigin (const vector3_t& xyz, const vector3_t& rpy)
+      {
+	ptree origin;
+	origin.put ("<xmlattr>.xyz", formatVector (xyz));
+	origin.put ("<xmlattr>.rpy", formatVector (rpy));
+	return origin;
+      }
+
+      /// \brief Build a <collision/> element.
+      ptree makeCollision (const std::string& name, const ptree& origin,
+			   const std::string& shape, const ptree& attributes)
+      {
+	ptree collision;
+	collision.put ("<xmlattr>.name", name);
+	collision.add_child ("origin", origin);
+	collision.add_child ("geometry." + shape, attributes);
+	return collision;
+      }
+
+      /// \brief Parse the geometry of a collision or visual element.
+      ///
+      /// \return false if the geometry is not supported.
+      bool parseGeometry (UrdfGeometry& geometry, const ptree& element,
+			  const std::string& directory,
+			  const packages_t& packages)
+      {
+	geometry.origin = parseOrigin (element);
+
+	if (boost::optional<const ptree&> mesh
+	    = element.get_child_optional ("geometry.mesh"))
+	  {
+	    geometry.type = UrdfGeometry::MESH;
+	    geometry.fileName = resolveUrdfPath
+	      (mesh->get<std::string> ("<xmlattr>.filename"),
+	       directory, packages);
+	    geometry.size = parseVector
+	      (mesh->get<std::string> ("<xmlattr>.scale", "1 1 1"));
+	    return true;
+	  }
+
+	if (boost::optional<const ptree&> box
+	    = element.get_child_optional ("geometry.box"))
+	  {
+	    geometry.type = UrdfGeometry::BOX;
+	    geometry.size = parseVector
+	      (box->get<std::string> ("<xmlattr>.size"));
+	    return true;
+	  }
+
+	if (boost::optional<const ptree&> cylinder
+	    = element.get_child_optional ("geometry.cylinder"))
+	  {
+	    geometry.type = UrdfGeometry::CYLINDER;
+	    geometry.size[0] = cylinder->get<value_type> ("<xmlattr>.radius");
+	    geometry.size[1] = cylinder->get<value_type> ("<xmlattr>.length");
+	    geometry.size[2] = 0.;
+	    return true;
+	  }
+
+	return false;
+      }
+
+      /// \brief Parse the geometries of a link of a given kind
+      /// ("collision" or "visual").
+      ///
+      /// \return false if a geometry is not supported.
+      bool parseGeometries (UrdfLink& link, const ptree& element,
+			    const std::string& kind,
+			    const std::string& directory,
+			    const packages_t& packages)
+      {
+	BOOST_FOREACH (const ptree::value_type& child, element)
+	  {
+	    if (child.first != kind)
+	      continue;
+
+	    UrdfGeometry geometry;
+	    if (!parseGeometry (geometry, child.second, directory, packages))
+	      return false;
+	    link.geometries.push_back (geometry);
+	  }
+	return true;
+      }
+    } // end of anonymous namespace.
+
+    // -------------------PUBLIC FUNCTIONS-----------------------
+
+    std::string resolveUrdfPath (const std::string& uri,
+				 const std::string& directory,
+				 const packages_t& packages)
+    {
+      namespace fs = boost::filesystem;
+
+      const std::string packagePrefix = "package://";
+      const std::string filePrefix = "file://";
+
+      if (uri.compare (0, packagePrefix.size (), packagePrefix) == 0)
+	{
+	  std::string path = uri.substr (packagePrefix.size ());
+	  size_t slash = path.find ('/');
+	  std::string package = path.substr (0, slash);
+	  std::string relative
+	    = (slash == std::string::npos) ? "" : path.substr (slash + 1);
+
+	  packages_t::const_iterator it = packages.find (package);
+	  if (it != packages.end ())
+	    return (fs::path (it->second) / relative).string ();
+
+	  // Packages are looked for in the ROS_PACKAGE_PATH directories
+	  // (not recursively).
+	  if (const char* rosPackagePath = std::getenv ("ROS_PACKAGE_PATH"))
+	    {
+	      std::istringstream ss (rosPackagePath);
+	      std::string root;
+	      while (std::getline (ss, root, ':'))
+		{
+		  fs::path candidate = fs::path (root) / package;
+		  if (!root.empty () && fs::is_directory (candidate))
+		    return (candidate / relative).string ();
+		}
+	    }
+
+	  throw std::runtime_error ("cannot find package \"" + package + "\"");
+	}
+
+      if (uri.compare (0, filePrefix.size (), filePrefix) == 0)
+	return uri.substr (filePrefix.size ());
+
+      fs::path path (uri);
+      if (path.is_relative () && !directory.empty ())
+	path = fs::path (directory) / path;
+      return path.string ();
+    }
+
+    void readLinkPoints (const UrdfLink& link, polyhedron_t& points)
+    {
+      BOOST_FOREACH (const UrdfGeometry& geometry, link.geometries)
+	{
+	  switch (geometry.type)
+	    {
+	    case UrdfGeometry::MESH:
+	      {
+		polyhedron_t vertices;
+		readMeshPoints (geometry.fileName, MESH_UNKNOWN, vertices);
+
+		points.reserve (points.size () + vertices.size ());
+		BOOST_FOREACH (const point_t& p, vertices)
+		  points.push_back (geometry.origin
+				    * point_t (geometry.size.cwiseProduct (p)));
+		break;
+	      }
+	    case UrdfGeometry::BOX:
+	      {
+		for (int i = 0; i < 8; ++i)
+		  {
+		    point_t corner (i & 1 ? 0.5 : -0.5,
+				    i & 2 ? 0.5 : -0.5,
+				    i & 4 ? 0.5 : -0.5);
+		    points.push_back (geometry.origin
+				      * point_t (geometry.size.cwiseProduct
+						 (corner)));
+		  }
+		break;
+	      }
+	    case UrdfGeometry::CYLINDER:
+	      {
+		// Circumscribed prism: its apothem is the cylinder radius.
+		value_type radius = geometry.size[0]
+		  / std::cos (M_PI / cylinderSides);
+		value_type halfLength = 0.5 * geometry.size[1];
+
+		for (int i = 0; i < cylinderSides; ++i)
+		  {
+		    value_type angle = 2. * M_PI * i / cylinderSides;
+		    value_type x = radius * std::cos (angle);
+		    value_type y = radius * std::sin (angle);
+		    points.push_back (geometry.origin
+				      * point_t (x, y, -halfLength));
+		    points.push_back (geometry.origin
+				      * point_t (x, y, halfLength));
+		  }
+		break;
+	      }
+	    }
+	}
+    }
+
+    UrdfModel::UrdfModel (const std::string& fileName,
+			  const packages_t& packages)
+    {
+      std::ifstream file (fileName.c_str ());
+      if (!file)
+	throw std::runtime_error ("cannot open \"" + fileName + "\"");
+
+      parse (file, boost::filesystem::path (fileName).parent_path ().string (),
+	     packages);
+    }
+
+    UrdfModel::UrdfModel (std::istream& is, const std::string& directory,
+			  const packages_t& packages)
+    {
+      parse (is, directory, packages);
+    }
+
+    std::string UrdfModel::name () const
+    {
+      return tree_.get<std::string> ("robot.<xmlattr>.name", "");
+    }
+
+    const std::vector<UrdfLink>& UrdfModel::links () const
+    {
+      return links_;
+    }
+
+    void UrdfModel::setCapsule (size_t link, const_argument_ref capsuleParam)
+    {
+      assert (link < links_.size () && "Invalid link index.");
+      assert (capsuleParam.size () == 7
+	      && "Incorrect capsuleParam size, expected 7.");
+
+      capsules_[link] = capsuleParam;
+    }
+
+    void UrdfModel::write (std::ostream& os, CapsuleGeometry geometry) const
+    {
+      std::map<std::string, argument_t> capsules;
+      for (size_t i = 0; i < links_.size (); ++i)
+	if (capsules_[i].size () == 7)
+	  capsules[links_[i].name] = capsules_[i];
+
+      ptree tree = tree_;
+      BOOST_FOREACH (ptree::value_type& child, tree.get_child ("robot"))
+	{
+	  if (child.first != "link")
+	    continue;
+
+	  std::string linkName
+	    = child.second.get<std::string> ("<xmlattr>.name", "");
+	  std::map<std::string, argument_t>::const_iterator
+	    it = capsules.find (linkName);
+	  if (it == capsules.end ())
+	    continue;
+
+	  point_t endPoint1;
+	  point_t endPoint2;
+	  value_type radius;
+	  convertSolverParamToCapsule (endPoint1, endPoint2, radius,
+				       it->second);
+
+	  // Cylinders and capsules are centered on their origin, along
+	  // their z axis.
+	  vector3_t axis = endPoint2 - endPoint1;
+	  value_type length = axis.norm ();
+	  Eigen::Quaterniond rotation = Eigen::Quaterniond::Identity ();
+	  if (length > 0.)
+	    rotation.setFromTwoVectors (vector3_t::UnitZ (), axis / length);
+	  vector3_t ypr = rotation.toRotationMatrix ().eulerAngles (2, 1, 0);
+	  vector3_t rpy (ypr[2], ypr[1], ypr[0]);
+	  ptree axisOrigin = makeOrigin (0.5 * (endPoint1 + endPoint2), rpy);
+
+	  child.second.erase ("collision");
+
+	  ptree sphere;
+	  sphere.put ("<xmlattr>.radius", formatScalar (radius));
+
+	  if (geometry == CAPSULE)
+	    {
+	      ptree capsule;
+	      capsule.put ("<xmlattr>.radius", formatScalar (radius));
+	      capsule.put ("<xmlattr>.length", formatScalar (length));
+	      child.second.add_child
+		("collision", makeCollision (linkName + "_capsule",
+					     axisOrigin, "capsule", capsule));
+	    }
+	  else if (length > 0.)
+	    {
+	      ptree cylinder;
+	      cylinder.put ("<xmlattr>.radius", formatScalar (radius));
+	      cylinder.put ("<xmlattr>.length", formatScalar (length));
+	      child.second.add_child
+		("collision", makeCollision (linkName + "_capsule_cylinder",
+					     axisOrigin, "cylinder", cylinder));
+	      child.second.add_child
+		("collision", makeCollision (linkName + "_capsule_sphere1",
+					     makeOrigin (endPoint1,
+							 vector3_t::Zero ()),
+					     "sphere", sphere));
+	      child.second.add_child
+		("collision", makeCollision (linkName + "_capsule_sphere2",
+					     makeOrigin (endPoint2,
+							 vector3_t::Zero ()),
+					     "sphere", sphere));
+	    }
+	  else
+	    {
+	      child.second.add_child
+		("collision", makeCollision (linkName + "_capsule_sphere",
+					     axisOrigin, "sphere", sphere));
+	    }
+	}
+
+      boost::property_tree::write_xml
+	(os, tree, boost::property_tree::xml_writer_make_settings<std::string>
+	 (' ', 2));
+    }
+
+    // -------------------PRIVATE FUNCTIONS----------------------
+
+    void UrdfModel::parse (std::istream& is, const std::string& directory,
+			   const packages_t& packages)
+    {
+      try
+	{
+	  boost::property_tree::read_xml
+	    (is, tree_, boost::property_tree::xml_parser::trim_whitespace);
+	}
+      catch (boost::property_tree::xml_parser_error& e)
+	{
+	  throw std::runtime_error (e.what ());
+	}
+
+      boost::optional<const ptree&> robot
+	= static_cast<const ptree&> (tree_).get_child_optional ("robot");
+      if (!robot)
+	throw std::runtime_error ("missing robot element");
+
+      try
+	{
+	  BOOST_FOREACH (const ptree::value_type& child, *robot)
+	    {
+	      if (child.first != "link")
+		continue;
+
+	      UrdfLink link;
+	      link.name = child.second.get<std::string> ("<xmlattr>.name");
+
+	      // Links with an unsupported geometry (e.g. a sphere) keep
+	      // their collision geometry: ignoring a part would give a
+	      // capsule that does not contain the link.
+	      bool supported = parseGeometries (link, child.second, "collision",
+						directory, packages);
+	      if (supported && link.geometries.empty ())
+		supported = parseGeometries (link, child.second, "visual",
+					     directory, packages);
+
+	      if (supported && !link.geometries.empty ())
+		links_.push_back (link);
+	    }
+	}
+      catch (boost::property_tree::ptree_error& e)
+	{
+	  throw std::runtime_error (e.what ());
+	}
+
+      capsules_.resize (links_.size ());
+    }
+
+  } // end of namespace capsule.
+} // end of namespace roboptim.
+
+#endif //! ROBOPTIM_CAPSULE_URDF_CC_
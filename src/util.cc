@@ -19,88 +19,641 @@
 #ifndef ROBOPTIM_CAPSULE_UTIL_CC_
 # define ROBOPTIM_CAPSULE_UTIL_CC_
 
+# include <algorithm>
+# include <cmath>
 # include <iostream>
 # include <set>
+# include <sstream>
 # include <limits>
 
 # include <boost/foreach.hpp>
+# include <boost/bind.hpp>
+# include <boost/thread.hpp>
 
 # include <roboptim/capsule/util.hh>
+# include <roboptim/capsule/arena.hh>
 
 namespace roboptim
 {
   namespace capsule
   {
 
-    polyhedron_t convexHullFromPoints (const std::vector<point_t>& points)
+    namespace
     {
-      polyhedron_t convexPolyhedron;
+      /// \brief qhull uses a global state, so convex hulls are computed
+      /// one at a time.
+      boost::mutex qhullMutex;
+
+      template <typename P>
+      polyhedron_t computeConvexHull (const P& points)
+      {
+	polyhedron_t convexPolyhedron;
 
 # ifdef HAVE_QHULL
-      int numpoints = static_cast<int> (points.size ());
-      int dim = 3;
+	int numpoints = static_cast<int> (points.size ());
+	int dim = 3;
+
+	// The coordinates copy only lives during the call.
+	ArenaScope scope;
+	std::vector<value_type, ArenaAllocator<value_type> >
+	  rboxpoints (static_cast<size_t> (dim * numpoints), 0.,
+		      ArenaAllocator<value_type> (scope.arena ()));
+	size_t iter = 0;
+
+	for (size_t i = 0; i < points.size (); ++i)
+	  {
+	    point_t point = points[i];
+	    rboxpoints[iter++] = point[0];
+	    rboxpoints[iter++] = point[1];
+	    rboxpoints[iter++] = point[2];
+	  }
+
+	// Compute the convex hull with qhull
+	boost::mutex::scoped_lock lock (qhullMutex);
+	char flags[25];
+	sprintf (flags, "qhull Qc Qt Qi");
+	int exitcode = qh_new_qhull (dim, numpoints,
+				     rboxpoints.data (), 0,
+				     flags, NULL, NULL);
+
+	if (exitcode != 0)
+	  {
+	    // Return empty polyhedron
+	    return convexPolyhedron;
+	  }
+
+	// Get the list of points
+	convexPolyhedron.clear ();
+	vertexT* vertex = qh vertex_list;
+
+	// TODO: find how to get the number of vertices on the convex
+	// hull with qhull.
+
+	FORALLvertices {
+	  // qh_pointid (vertex->point) is the point id of the vertex
+	  //int id = qh_pointid (vertex->point);
+	  // vertex->point is the coordinates of the vertex
+	  convexPolyhedron.push_back(point_t (vertex->point[0],
+					      vertex->point[1],
+					      vertex->point[2]));
+	}
+
+	// TODO: only call this once
+	//qh_freeqhull (!qh_ALL);
+# else
+	std::cerr << "Qhull not found, cannot compute the convex hull."
+		  << std::endl;
+# endif //! HAVE_QHULL
+	// Return the convex hull as a polyhedron
+	return convexPolyhedron;
+      }
+
+
+      /// \brief Number of points of the chunks of the reductions.
+      ///
+      /// Chunks, not threads, fix the order of the floating-point
+      /// operations, so that results are identical whatever the number
+      /// of threads.
+      const size_t reductionChunkSize = 1024;
+
+      /// \brief Reduce the chunks first, first + stride, ... of a
+      /// point range.
+      template <typename F>
+      void reduceChunkRange (const F& reduce, size_t nbPoints,
+			     size_t first, size_t stride,
+			     std::vector<typename F::result_t>& partials)
+      {
+	for (size_t i = first; i < partials.size (); i += stride)
+	  partials[i] = reduce (i * reductionChunkSize,
+				std::min (nbPoints,
+					  (i + 1) * reductionChunkSize));
+      }
+
+      /// \brief Deterministic parallel reduction over points.
+      ///
+      /// Each chunk is reduced sequentially, then partial results are
+      /// combined pairwise along a fixed tree.
+      ///
+      /// \tparam F reduction, with a result_t type, a
+      /// result_t operator() (size_t begin, size_t end) const reducing
+      /// a range of points, and a static result_t combine (const
+      /// result_t&, const result_t&).
+      template <typename F>
+      typename F::result_t reduceChunks (const F& reduce, size_t nbPoints,
+					 size_t jobs)
+      {
+	typedef typename F::result_t result_t;
+
+	size_t nbChunks = std::max<size_t>
+	  (1, (nbPoints + reductionChunkSize - 1) / reductionChunkSize);
+	std::vector<result_t> partials (nbChunks);
+
+	jobs = std::max<size_t> (1, std::min (jobs, nbChunks));
+	if (jobs == 1)
+	  reduceChunkRange (reduce, nbPoints, 0, 1, partials);
+	else
+	  {
+	    boost::thread_group workers;
+	    for (size_t i = 0; i < jobs; ++i)
+	      workers.create_thread
+		(boost::bind (&reduceChunkRange<F>, boost::cref (reduce),
+			      nbPoints, i, jobs, boost::ref (partials)));
+	    workers.join_all ();
+	  }
+
+	for (size_t step = 1; step < nbChunks; step *= 2)
+	  for (size_t i = 0; i + step < nbChunks; i += 2 * step)
+	    partials[i] = F::combine (partials[i], partials[i + step]);
+
+	return partials[0];
+      }
+
+      /// \brief Sum of points.
+      template <typename P>
+      struct PointSum
+      {
+	typedef point_t result_t;
+
+	explicit PointSum (const P& points)
+	  : points_ (points)
+	{
+	}
+
+	result_t operator() (size_t begin, size_t end) const
+	{
+	  point_t sum (0., 0., 0.);
+	  for (size_t i = begin; i < end; ++i)
+	    sum += points_[i];
+	  return sum;
+	}
+
+	static result_t combine (const result_t& a, const result_t& b)
+	{
+	  return a + b;
+	}
+
+	const P& points_;
+      };
+
+      /// \brief Sum of the second moments of points around a center
+      /// (xx, yy, zz, xy, xz, yz).
+      template <typename P>
+      struct MomentSum
+      {
+	typedef Eigen::Matrix<value_type, 6, 1, Eigen::DontAlign> result_t;
+
+	MomentSum (const P& points, const point_t& center)
+	  : points_ (points),
+	    center_ (center)
+	{
+	}
+
+	result_t operator() (size_t begin, size_t end) const
+	{
+	  result_t sum = result_t::Zero ();
+	  for (size_t i = begin; i < end; ++i)
+	    {
+	      // translate points so center of mass is at origin
+	      point_t p = points_[i] - center_;
+	      sum[0] += p[0] * p[0];
+	      sum[1] += p[1] * p[1];
+	      sum[2] += p[2] * p[2];
+	      sum[3] += p[0] * p[1];
+	      sum[4] += p[0] * p[2];
+	      sum[5] += p[1] * p[2];
+	    }
+	  return sum;
+	}
+
+	static result_t combine (const result_t& a, const result_t& b)
+	{
+	  return a + b;
+	}
+
+	const P& points_;
+	point_t center_;
+      };
+
+      /// \brief Extreme projections of points along a direction.
+      template <typename P>
+      struct ExtremeProjections
+      {
+	struct result_t
+	{
+	  result_t ()
+	    : minproj (std::numeric_limits<double>::max ()),
+	      maxproj (-std::numeric_limits<double>::max ()),
+	      imin (0),
+	      imax (0)
+	  {
+	  }
+
+	  double minproj;
+	  double maxproj;
+	  size_t imin;
+	  size_t imax;
+	};
+
+	ExtremeProjections (const P& points, const vector3_t& dir)
+	  : points_ (points),
+	    dir_ (dir)
+	{
+	}
+
+	result_t operator() (size_t begin, size_t end) const
+	{
+	  result_t r;
+	  for (size_t i = begin; i < end; ++i)
+	    {
+	      // Project vector from origin to point onto direction vector
+	      double proj = points_[i].dot (dir_);
+	      // Keep track of least distant point along direction vector
+	      if (proj < r.minproj)
+		{
+		  r.minproj = proj;
+		  r.imin = i;
+		}
+	      // Keep track of most distant point along direction vector
+	      if (proj > r.maxproj)
+		{
+		  r.maxproj = proj;
+		  r.imax = i;
+		}
+	    }
+	  return r;
+	}
+
+	/// Ties keep the first point, as the sequential loop.
+	static result_t combine (const result_t& a, const result_t& b)
+	{
+	  result_t r = a;
+	  if (b.minproj < a.minproj)
+	    {
+	      r.minproj = b.minproj;
+	      r.imin = b.imin;
+	    }
+	  if (b.maxproj > a.maxproj)
+	    {
+	      r.maxproj = b.maxproj;
+	      r.imax = b.imax;
+	    }
+	  return r;
+	}
+
+	const P& points_;
+	vector3_t dir_;
+      };
+
+      /// \brief Largest squared distance from points to a line.
+      template <typename P>
+      struct MaxSquaredDistanceToLine
+      {
+	typedef value_type result_t;
+
+	/// \param dir unit direction of the line.
+	MaxSquaredDistanceToLine (const P& points, const point_t& linePoint,
+				  const vector3_t& dir)
+	  : points_ (points),
+	    linePoint_ (linePoint),
+	    dir_ (dir)
+	{
+	}
+
+	result_t operator() (size_t begin, size_t end) const
+	{
+	  value_type h2 = 0.;
+	  for (size_t i = begin; i < end; ++i)
+	    h2 = std::max (h2, dir_.cross (points_[i] - linePoint_)
+			   .squaredNorm ());
+	  return h2;
+	}
+
+	static result_t combine (const result_t& a, const result_t& b)
+	{
+	  return std::max (a, b);
+	}
+
+	const P& points_;
+	point_t linePoint_;
+	vector3_t dir_;
+      };
+
+      /// \brief Tightest cap positions along a line for a radius.
+      ///
+      /// A point at axial coordinate t and distance h from the line is
+      /// in the capsule (or stadium) of radius r iff the segment is
+      /// within w = sqrt (r^2 - h^2) of t, i.e. start <= t + w and
+      /// end >= t - w. Both bounds are a minimum and a maximum over the
+      /// points, which do not depend on their order.
+      ///
+      /// h^2 is given directly (e.g. from a cross product): computing
+      /// it as |d|^2 - t^2 cancels for points far along the line.
+      struct CapInterval
+      {
+	CapInterval ()
+	  : start (std::numeric_limits<value_type>::max ()),
+	    end (-std::numeric_limits<value_type>::max ())
+	{
+	}
+
+	/// \param t axial coordinate of the point.
+	/// \param h2 squared distance from the point to the line.
+	/// \param r2 squared radius.
+	void add (value_type t, value_type h2, value_type r2)
+	{
+	  value_type w = std::sqrt (std::max (0., r2 - h2));
+	  start = std::min (start, t + w);
+	  end = std::max (end, t - w);
+	}
+
+	static CapInterval combine (const CapInterval& a,
+				    const CapInterval& b)
+	{
+	  CapInterval r;
+	  r.start = std::min (a.start, b.start);
+	  r.end = std::max (a.end, b.end);
+	  return r;
+	}
 
-      std::vector<value_type> rboxpoints (dim * numpoints);
-      size_t iter = 0;
+	/// \brief Resolve crossed bounds: a sphere (or disk) contains
+	/// the points, and both caps are placed in the middle.
+	void close ()
+	{
+	  if (start > end)
+	    start = end = 0.5 * (start + end);
+	}
 
-      for (std::vector<point_t>::const_iterator
-	     point = points.begin (); point != points.end (); ++point)
+	value_type start;
+	value_type end;
+      };
+
+      /// \brief Cap positions of a capsule, reduced over points (see
+      /// CapInterval).
+      template <typename P>
+      struct CapBounds
+      {
+	typedef CapInterval result_t;
+
+	/// \param dir unit direction of the line.
+	CapBounds (const P& points, const point_t& linePoint,
+		   const vector3_t& dir, value_type radius)
+	  : points_ (points),
+	    linePoint_ (linePoint),
+	    dir_ (dir),
+	    r2_ (radius * radius)
 	{
-	  rboxpoints[iter++] = (*point)[0];
-	  rboxpoints[iter++] = (*point)[1];
-	  rboxpoints[iter++] = (*point)[2];
 	}
 
-      // Compute the convex hull with qhull
-      char flags[25];
-      sprintf (flags, "qhull Qc Qt Qi");
-      int exitcode = qh_new_qhull (dim, numpoints,
-				   rboxpoints.data (), 0,
-				   flags, NULL, NULL);
+	result_t operator() (size_t begin, size_t end) const
+	{
+	  result_t r;
+	  for (size_t i = begin; i < end; ++i)
+	    {
+	      vector3_t d = points_[i] - linePoint_;
+	      r.add (dir_.dot (d), dir_.cross (d).squaredNorm (), r2_);
+	    }
+	  return r;
+	}
 
-      if (exitcode != 0)
+	static result_t combine (const result_t& a, const result_t& b)
 	{
-	  // Return empty polyhedron
-	  return convexPolyhedron;
+	  return CapInterval::combine (a, b);
 	}
 
-      // Get the list of points
-      convexPolyhedron.clear ();
-      vertexT* vertex = qh vertex_list;
+	const P& points_;
+	point_t linePoint_;
+	vector3_t dir_;
+	value_type r2_;
+      };
 
-      // TODO: find how to get the number of vertices on the convex
-      // hull with qhull.
 
-      FORALLvertices {
-	// qh_pointid (vertex->point) is the point id of the vertex
-	//int id = qh_pointid (vertex->point);
-	// vertex->point is the coordinates of the vertex
-	convexPolyhedron.push_back(point_t (vertex->point[0],
-					    vertex->point[1],
-					    vertex->point[2]));
+      template <typename P>
+      point_t computeCenter (const P& points, size_t jobs)
+      {
+	point_t c = reduceChunks (PointSum<P> (points), points.size (), jobs);
+	return c / static_cast<value_type> (points.size ());
       }
 
-      // TODO: only call this once
-      //qh_freeqhull (!qh_ALL);
-# else
-      std::cerr << "Qhull not found, cannot compute the convex hull."
-		<< std::endl;
-# endif //! HAVE_QHULL
-      // Return the convex hull as a polyhedron
-      return convexPolyhedron;
+
+      template <typename P>
+      Eigen::Matrix3d computeCovariance (const P& points, const point_t& c,
+					 size_t jobs)
+      {
+	value_type oon = 1.0 / (value_type)points.size();
+
+	// compute covariance elements
+	typename MomentSum<P>::result_t e
+	  = reduceChunks (MomentSum<P> (points, c), points.size (), jobs);
+
+	// fill in the covariance matrix elements
+	Eigen::Matrix3d cov;
+
+	cov (0,0) = e[0] * oon;
+	cov (1,1) = e[1] * oon;
+	cov (2,2) = e[2] * oon;
+	cov (0,1) = cov (1,0) = e[3] * oon;
+	cov (0,2) = cov (2,0) = e[4] * oon;
+	cov (1,2) = cov (2,1) = e[5] * oon;
+
+	return cov;
+      }
+
+
+      template <typename P>
+      Eigen::Matrix3d computeCovariance (const P& points, size_t jobs)
+      {
+	// compute the center of mass of the points
+	return computeCovariance (points, computeCenter (points, jobs), jobs);
+      }
+
+
+      // Returns indices imin and imax into pt[] array of the least and
+      // most, respectively, distant points along the direction dir
+      template <typename P>
+      void computeExtremePoints (vector3_t dir, const P& points,
+				 int& imin, int& imax, size_t jobs)
+      {
+	typename ExtremeProjections<P>::result_t r
+	  = reduceChunks (ExtremeProjections<P> (points, dir),
+			  points.size (), jobs);
+	if (points.size () == 0)
+	  return;
+
+	imin = static_cast<int> (r.imin);
+	imax = static_cast<int> (r.imax);
+      }
+
+
+      template <typename P>
+      Capsule computeCapsule (const P& points, size_t jobs)
+      {
+	assert (points.size () > 0
+		&& "Cannot compute capsule for empty polyhedron.");
+
+	// The cylinder axis will be (average point, largest spread
+	// direction). However, a better point could be found with a more
+	// complicated algorithm, thus reducing the volume of the capsule.
+	point_t average = computeCenter (points, jobs);
+
+	// Create the covariance matrix for PCA
+	Eigen::Matrix3d covariance = computeCovariance (points, average, jobs);
+
+	// Compute eigenvectors and eigenvalues
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
+	es.compute (covariance,Eigen::ComputeEigenvectors);
+
+	Eigen::Matrix3d eigenVectors = es.eigenvectors ();
+	Eigen::Matrix3d eigenValues = es.eigenvalues ().asDiagonal ();
+
+	// Find the largest eigenvalue and the corresponding direction
+	// (largest spread)
+	unsigned maxc, minc;
+	maxc = minc = 0;
+	value_type absev, maxev, minev;
+	maxev = minev = std::fabs (eigenValues (0,0));
+
+	if ((absev = std::fabs (eigenValues (1,1))) > maxev)
+	  {
+	    maxc = 1;
+	    maxev = absev;
+	  }
+	else
+	  {
+	    minc = 1;
+	    minev = absev;
+	  }
+
+	if ((absev = std::fabs (eigenValues (2,2))) > maxev)
+	  {
+	    maxc = 2;
+	    maxev = absev;
+	  }
+	else if (minev > absev)
+	  {
+	    minc = 2;
+	    minev = absev;
+	  }
+
+	vector3_t dirLargestSpread = eigenVectors.col (maxc);
+	dirLargestSpread.normalize ();
+
+	// Find the correct radius for the capsule.
+	value_type radius = std::sqrt (reduceChunks
+	  (MaxSquaredDistanceToLine<P> (points, average, dirLargestSpread),
+	   points.size (), jobs));
+
+	// Place the end points as close as possible: each point bounds
+	// them in closed form (see CapBounds).
+	CapInterval bounds = reduceChunks
+	  (CapBounds<P> (points, average, dirLargestSpread, radius),
+	   points.size (), jobs);
+	bounds.close ();
+
+	point_t start = average + bounds.start * dirLargestSpread;
+	point_t end = average + bounds.end * dirLargestSpread;
+
+	Capsule capsule;
+	capsule.P0 = start;
+	capsule.P1 = end;
+	capsule.radius = radius;
+
+	return capsule;
+      }
+
+      /// \brief Order point indices by the coordinates of the points.
+      struct LexicographicIndexLess
+      {
+	explicit LexicographicIndexLess (const polyhedron_t& points)
+	  : points_ (points)
+	{
+	}
+
+	static bool less (const point_t& a, const point_t& b)
+	{
+	  return std::lexicographical_compare (a.data (), a.data () + 3,
+					       b.data (), b.data () + 3);
+	}
+
+	bool operator() (size_t i, size_t j) const
+	{
+	  return less (points_[i], points_[j]);
+	}
+
+	bool operator() (size_t i, const point_t& p) const
+	{
+	  return less (points_[i], p);
+	}
+
+	const polyhedron_t& points_;
+      };
+
+      /// \brief Order planar points by their coordinates.
+      bool lexicographicLess (const point2_t& a, const point2_t& b)
+      {
+	return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+      }
+
+      /// \brief Twice the signed area of triangle (o, a, b), positive
+      /// for a counter-clockwise turn.
+      value_type cross (const point2_t& o, const point2_t& a,
+			const point2_t& b)
+      {
+	return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+      }
+    } // end of anonymous namespace.
+
+    polyhedron_t convexHullFromPoints (const std::vector<point_t>& points)
+    {
+      return computeConvexHull (points);
     }
 
 
+    polyhedron_t convexHullFromPoints (const PointsView<float>& points)
+    {
+      return computeConvexHull (points);
+    }
+
+
+    polyhedron_t convexHullFromPoints (const PointsView<double>& points)
+    {
+      return computeConvexHull (points);
+    }
+
+
+    // Explicit template instantiations: the inline geometry core stays
+    // exported for float and double.
+# define ROBOPTIM_CAPSULE_INSTANTIATE_GEOMETRY(S)			\
+    template S distancePointToSegment<S> (const Eigen::Matrix<S,3,1>&,	\
+					  const Eigen::Matrix<S,3,1>&,	\
+					  const Eigen::Matrix<S,3,1>&);	\
+    template Eigen::Matrix<S,3,1>					\
+    projectionOnSegment<S> (const Eigen::Matrix<S,3,1>&,		\
+			    const Eigen::Matrix<S,3,1>&,		\
+			    const Eigen::Matrix<S,3,1>&);		\
+    template S								\
+    projectionParameterOnSegment<S> (const Eigen::Matrix<S,3,1>&,	\
+				     const Eigen::Matrix<S,3,1>&,	\
+				     const Eigen::Matrix<S,3,1>&);	\
+    template S distancePointToLine<S> (const Eigen::Matrix<S,3,1>&,	\
+				       const Eigen::Matrix<S,3,1>&,	\
+				       const Eigen::Matrix<S,3,1>&);	\
+    template S distancePointToCapsule<S> (const GenericCapsule<S>&,	\
+					  const Eigen::Matrix<S,3,1>&);	\
+    template bool capsuleContainsPoint<S> (const GenericCapsule<S>&,	\
+					   const Eigen::Matrix<S,3,1>&); \
+    template S capsuleVolume<S> (const GenericCapsule<S>&)
+
+    ROBOPTIM_CAPSULE_INSTANTIATE_GEOMETRY (float);
+    ROBOPTIM_CAPSULE_INSTANTIATE_GEOMETRY (double);
+
+# undef ROBOPTIM_CAPSULE_INSTANTIATE_GEOMETRY
+
+
     value_type distancePointToSegment (const point_t& p,
                                        const point_t& a,
                                        const point_t& b)
     {
-      value_type d_ab = (b-a).norm ();
-
-      // If the segment is a point, i.e. a = b
-      if (d_ab < 1e-6) return (a-p).norm ();
-
-      return (p - projectionOnSegment (p, a, b)).norm ();
+      return distancePointToSegment<value_type> (p, a, b);
     }
 
 
@@ -108,16 +661,15 @@ namespace roboptim
                                  const point_t& a,
                                  const point_t& b)
     {
-      value_type d_ab = (b-a).norm ();
+      return projectionOnSegment<value_type> (p, a, b);
+    }
 
-      // If the segment is a point, i.e. a = b
-      if (d_ab < 1e-6) return a;
 
-      // We note q the projection of p on the line (a,b)
-      value_type d_aq = (p-a).dot (b-a)/d_ab;
-      if (d_aq > d_ab) return b;
-      else if (d_aq < 0.) return a;
-      else return a + d_aq * (b-a).normalized ();
+    value_type projectionParameterOnSegment (const point_t& p,
+                                             const point_t& a,
+                                             const point_t& b)
+    {
+      return projectionParameterOnSegment<value_type> (p, a, b);
     }
 
 
@@ -125,48 +677,106 @@ namespace roboptim
                                     const point_t& linePoint,
                                     const vector3_t& dir)
     {
-      assert (dir.norm () > 0.);
-      return (dir.cross (linePoint - point)).norm () / dir.norm ();
+      return distancePointToLine<value_type> (point, linePoint, dir);
     }
 
 
     Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points)
     {
-      value_type oon = 1.0 / (value_type)points.size();
-      point_t c(0., 0., 0.);
-      value_type e00, e11, e22, e01, e02, e12;
+      return computeCovariance (points, 1);
+    }
 
-      // compute the center of mass of the points
-      for (size_t i = 0; i < points.size (); ++i)
-	c += points[i];
-      c *= oon;
+    Eigen::Matrix3d covarianceMatrix (const std::vector<point_t>& points,
+				      size_t jobs)
+    {
+      return computeCovariance (points, jobs);
+    }
 
-      // compute covariance elements
-      e00 = e11 = e22 = e01 = e02 = e12 = 0.0;
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  // translate points so center of mass is at origin
-	  point_t p = points[i] - c;
-	  // compute covariance of translated points
-	  e00 += p[0] * p[0];
-	  e11 += p[1] * p[1];
-	  e22 += p[2] * p[2];
-	  e01 += p[0] * p[1];
-	  e02 += p[0] * p[2];
-	  e12 += p[1] * p[2];
-        }
+    value_type maxDistanceToSegment (const polyhedrons_t& polyhedrons,
+				     const point_t& a, const point_t& b)
+    {
+      vector3_t axis = b - a;
+      value_type squaredLength = axis.squaredNorm ();
+      value_type invSquaredLength
+	= (squaredLength > 0.) ? 1. / squaredLength : 0.;
 
-      // fill in the covariance matrix elements
-      Eigen::Matrix3d cov;
+      value_type maxSquaredDistance = 0.;
+      for (size_t i = 0; i < polyhedrons.size (); ++i)
+	{
+	  const polyhedron_t& points = polyhedrons[i];
+	  for (size_t j = 0; j < points.size (); ++j)
+	    {
+	      vector3_t w = points[j] - a;
+	      value_type t = w.dot (axis) * invSquaredLength;
+	      t = std::min (1., std::max (0., t));
+	      maxSquaredDistance = std::max (maxSquaredDistance,
+					     (w - t * axis).squaredNorm ());
+	    }
+	}
 
-      cov (0,0) = e00 * oon;
-      cov (1,1) = e11 * oon;
-      cov (2,2) = e22 * oon;
-      cov (0,1) = cov (1,0) = e01 * oon;
-      cov (0,2) = cov (2,0) = e02 * oon;
-      cov (1,2) = cov (2,1) = e12 * oon;
+      return std::sqrt (maxSquaredDistance);
+    }
 
-      return cov;
+    value_type inflateToContain (argument_ref capsuleParam,
+				 const polyhedrons_t& polyhedrons)
+    {
+      assert (capsuleParam.size () == 7
+	      && "Incorrect capsuleParam size, expected 7.");
+
+      point_t endPoint1 = capsuleParam.segment<3> (0);
+      point_t endPoint2 = capsuleParam.segment<3> (3);
+
+      // A few ulps cover the rounding errors of the distances.
+      value_type radius = maxDistanceToSegment (polyhedrons,
+						endPoint1, endPoint2)
+	* (1. + 16. * std::numeric_limits<value_type>::epsilon ());
+
+      value_type inflation = std::max (0., radius - capsuleParam[6]);
+      capsuleParam[6] += inflation;
+      return inflation;
+    }
+
+    void fitCapsuleAlongAxis (argument_ref capsuleParam,
+			      const polyhedrons_t& polyhedrons,
+			      const point_t& linePoint,
+			      const vector3_t& direction)
+    {
+      assert (capsuleParam.size () == 7
+	      && "Incorrect capsuleParam size, expected 7.");
+      assert (direction.norm () > 0. && "Null axis direction.");
+
+      vector3_t u = direction.normalized ();
+
+      // Radius: largest distance to the line.
+      value_type squaredRadius = 0.;
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	BOOST_FOREACH (const point_t& p, polyhedron)
+	squaredRadius = std::max (squaredRadius,
+				  u.cross (p - linePoint).squaredNorm ());
+
+      // Each point bounds the end points (see CapInterval).
+      CapInterval bounds;
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+	BOOST_FOREACH (const point_t& p, polyhedron)
+	{
+	  vector3_t w = p - linePoint;
+	  bounds.add (u.dot (w), u.cross (w).squaredNorm (), squaredRadius);
+	}
+      bounds.close ();
+
+      capsuleParam.segment<3> (0) = linePoint + bounds.start * u;
+      capsuleParam.segment<3> (3) = linePoint + bounds.end * u;
+      capsuleParam[6] = std::sqrt (squaredRadius);
+    }
+
+    value_type capsuleVolume (const_argument_ref param)
+    {
+      assert (param.size () == 7 && "Incorrect param size, expected 7.");
+
+      value_type length = (param.segment<3> (3) - param.segment<3> (0)).norm ();
+      value_type radius = param[6];
+
+      return M_PI * radius * radius * (4. / 3. * radius + length);
     }
 
 
@@ -176,172 +786,69 @@ namespace roboptim
 				      const std::vector<point_t>& points,
 				      int& imin, int& imax)
     {
-      double minproj = std::numeric_limits<double>::max ();
-      double maxproj = -minproj;
-
-      for (size_t i = 0; i < points.size(); ++i)
-        {
-	  // Project vector from origin to point onto direction vector
-	  double proj = points[i].dot (dir);
-	  // Keep track of least distant point along direction vector
-	  if (proj < minproj) {
-	    minproj = proj;
-	    imin = static_cast<int> (i);
-	  }
-	  // Keep track of most distant point along direction vector
-	  if (proj > maxproj) {
-	    maxproj = proj;
-	    imax = static_cast<int> (i);
-	  }
-        }
+      computeExtremePoints (dir, points, imin, imax, 1);
+    }
+
+
+    void extremePointsAlongDirection (vector3_t dir,
+				      const std::vector<point_t>& points,
+				      int& imin, int& imax, size_t jobs)
+    {
+      computeExtremePoints (dir, points, imin, imax, jobs);
     }
 
 
     Capsule capsuleFromPoints (const std::vector<point_t>& points)
+    {
+      return computeCapsule (points, 1);
+    }
+
+
+    Capsule capsuleFromPoints (const std::vector<point_t>& points, size_t jobs)
+    {
+      return computeCapsule (points, jobs);
+    }
+
+
+    Capsule capsuleFromPoints (const PointsView<float>& points)
+    {
+      return computeCapsule (points, 1);
+    }
+
+
+    Capsule capsuleFromPoints (const PointsView<float>& points, size_t jobs)
+    {
+      return computeCapsule (points, jobs);
+    }
+
+
+    Capsule capsuleFromPoints (const PointsView<double>& points)
+    {
+      return computeCapsule (points, 1);
+    }
+
+
+    Capsule capsuleFromPoints (const PointsView<double>& points, size_t jobs)
+    {
+      return computeCapsule (points, jobs);
+    }
+
+
+    Capsulef capsuleFromPoints (const std::vector<pointf_t>& points)
+    {
+      return capsuleFromPoints (points, 1);
+    }
+
+
+    Capsulef capsuleFromPoints (const std::vector<pointf_t>& points,
+				size_t jobs)
     {
       assert (points.size () > 0
-              && "Cannot compute capsule for empty polyhedron.");
-
-      // Create the covariance matrix for PCA
-      Eigen::Matrix3d covariance = covarianceMatrix (points);
-
-      // Compute eigenvectors and eigenvalues
-      Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es;
-      es.compute (covariance,Eigen::ComputeEigenvectors);
-
-      Eigen::Matrix3d eigenVectors = es.eigenvectors ();
-      Eigen::Matrix3d eigenValues = es.eigenvalues ().asDiagonal ();
-
-      // Find the largest eigenvalue and the corresponding direction
-      // (largest spread)
-      unsigned maxc, minc;
-      maxc = minc = 0;
-      value_type absev, maxev, minev;
-      maxev = minev = std::fabs (eigenValues (0,0));
-
-      if ((absev = std::fabs (eigenValues (1,1))) > maxev)
-        {
-	  maxc = 1;
-	  maxev = absev;
-        }
-      else
-        {
-	  minc = 1;
-	  minev = absev;
-        }
-
-      if ((absev = std::fabs (eigenValues (2,2))) > maxev)
-        {
-	  maxc = 2;
-	  maxev = absev;
-        }
-      else if (minev > absev)
-        {
-	  minc = 2;
-	  minev = absev;
-        }
-
-      vector3_t dirLargestSpread = eigenVectors.col (maxc);
-      dirLargestSpread.normalize ();
-
-      // Find the most extreme points along the largest spread direction.
-      // Those points will help to find the length of the capsule.
-      int iminLargestSpread = 0;
-      int imaxLargestSpread = 0;
-      extremePointsAlongDirection (dirLargestSpread, points,
-                                   iminLargestSpread, imaxLargestSpread);
-      point_t minptLargestSpread = points[iminLargestSpread];
-      point_t maxptLargestSpread = points[imaxLargestSpread];
-
-      // Compute the start point
-      // The cylinder axis will be (average point, largest spread direction).
-      // However, a better point could be found with a more complicated
-      // algorithm, thus reducing the volume of the capsule.
-      point_t average (0., 0., 0.);
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  average += points[i];
-        }
-      average /= static_cast<value_type> (points.size ());
+	      && "Cannot compute capsule for empty polyhedron.");
 
-      // Find the correct radius for the capsule.
-      value_type radius = 0;
-      for (size_t i = 0; i < points.size (); ++i)
-        {
-	  value_type dist = distancePointToLine
-	    (points[i], average, dirLargestSpread);
-	  if (dist > radius) radius = dist;
-        }
-
-      // Find the correct length for the capsule (cylinder part)
-      value_type length = (maxptLargestSpread - minptLargestSpread).norm ();
-
-      // Length used to find the correct center position on the direction axis
-      value_type maxLengthFromAverage
-	= std::fabs((maxptLargestSpread - average).dot (dirLargestSpread));
-      point_t center = average + (maxLengthFromAverage - 0.5 * length)
-	* dirLargestSpread;
-
-      // Optimization of the volume
-      // - We determine the points located at
-      //   both extremities (+/-)(0.5 * length - radius)
-      // - For all of those points, we look for the start/endpoint position
-      //   that will minimize the capsule volume.
-      std::vector<point_t> nearStartPoints;
-      std::vector<point_t> nearEndPoints;
-      point_t start = center - (0.5 * length - radius) * dirLargestSpread;
-      point_t end = center + (0.5 * length - radius) * dirLargestSpread;
-
-      for(size_t i = 0; i < points.size (); ++i)
-        {
-	  // if located near the start boundary
-	  value_type dirDist = dirLargestSpread.dot (points[i] - center);
-	  if (-dirDist >  0.5 * length - radius)
-	    nearStartPoints.push_back(points[i]);
-	  // else if located near the end boundary
-	  else if (dirDist > 0.5 * length - radius)
-	    nearEndPoints.push_back(points[i]);
-        }
-
-      // we move the position of the start point to include all points in its
-      // vicinity
-      for (size_t i = 0; i < nearStartPoints.size (); ++i)
-        {
-	  if ((nearStartPoints[i] - start).norm () > radius)
-            {
-	      // using pythagore theorem
-	      value_type h = distancePointToLine (nearStartPoints[i],
-						  center, dirLargestSpread);
-	      value_type l = (nearStartPoints[i] - start)
-		.dot (-dirLargestSpread);
-	      if (l - sqrt(radius * radius - h * h) > 0)
-		start -= (l - sqrt(radius * radius - h * h))
-		  * dirLargestSpread;
-            }
-        }
-
-      // we move the position of the end point to include all points in its
-      // vicinity
-      for (size_t i = 0; i < nearEndPoints.size (); ++i)
-        {
-	  if ((nearEndPoints[i] - end).norm () > radius)
-            {
-	      // using pythagore theorem
-	      value_type l = (nearEndPoints[i] - end).dot (dirLargestSpread);
-	      value_type h = distancePointToLine (nearEndPoints[i],
-						  center, dirLargestSpread);
-	      if (l - std::sqrt (radius * radius - h * h) > 0)
-		end += (l - std::sqrt (radius * radius - h * h))
-		  * dirLargestSpread;
-            }
-        }
-
-      Capsule capsule;
-      capsule.P0 = start;
-      capsule.P1 = end;
-      capsule.radius = radius;
-
-      return capsule;
+      // Float points are packed: sums are accumulated in double.
+      PointsView<float> view (points[0].data (), points.size ());
+      return computeCapsule (view, jobs).cast<float> ();
     }
 
 
@@ -388,11 +895,90 @@ namespace roboptim
       assert (polyhedrons.size () !=0 && "Empty polyhedron vector.");
       assert (polyhedron.size () == 0 && "Union polyhedron must be empty.");
 
-      BOOST_FOREACH (polyhedron_t poly, polyhedrons)
+      polyhedron.reserve (countPoints (polyhedrons));
+      BOOST_FOREACH (const polyhedron_t& poly, polyhedrons)
+	polyhedron.insert (polyhedron.end (), poly.begin (), poly.end ());
+    }
+
+
+    size_t countPoints (const polyhedrons_t& polyhedrons)
+    {
+      size_t nbPoints = 0;
+      BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
 	{
-	  BOOST_FOREACH (point_t point, poly)
-	    polyhedron.push_back (point);
+	  nbPoints += polyhedron.size ();
 	}
+
+      return nbPoints;
+    }
+
+
+    PointId pointIdFromIndex (const polyhedrons_t& polyhedrons, size_t index)
+    {
+      PointId id;
+      id.polyhedron = 0;
+      id.point = index;
+
+      while (id.polyhedron < polyhedrons.size ()
+	     && id.point >= polyhedrons[id.polyhedron].size ())
+	id.point -= polyhedrons[id.polyhedron++].size ();
+
+      assert (id.polyhedron < polyhedrons.size () && "Invalid point index.");
+      return id;
+    }
+
+
+    size_t indexFromPointId (const polyhedrons_t& polyhedrons,
+			     const PointId& id)
+    {
+      assert (id.polyhedron < polyhedrons.size ()
+	      && id.point < polyhedrons[id.polyhedron].size ()
+	      && "Invalid point identity.");
+
+      size_t index = id.point;
+      for (size_t i = 0; i < id.polyhedron; ++i)
+	index += polyhedrons[i].size ();
+      return index;
+    }
+
+
+    void matchPoints (std::vector<PointId>& ids,
+		      const polyhedron_t& points,
+		      const polyhedrons_t& polyhedrons)
+    {
+      polyhedron_t candidates;
+      convertPolyhedronVectorToPolyhedron (candidates, polyhedrons);
+
+      // Global indices sorted by coordinates, then by index so that the
+      // first identical point is found.
+      std::vector<size_t> order (candidates.size ());
+      for (size_t i = 0; i < order.size (); ++i)
+	order[i] = i;
+      LexicographicIndexLess less (candidates);
+      std::stable_sort (order.begin (), order.end (), less);
+
+      ids.resize (points.size ());
+      for (size_t i = 0; i < points.size (); ++i)
+	{
+	  std::vector<size_t>::const_iterator it
+	    = std::lower_bound (order.begin (), order.end (), points[i], less);
+	  if (it != order.end () && candidates[*it] == points[i])
+	    ids[i] = pointIdFromIndex (polyhedrons, *it);
+	  else
+	    {
+	      ids[i].polyhedron = polyhedrons.size ();
+	      ids[i].point = 0;
+	    }
+	}
+    }
+
+
+    std::string constraintName (const PointId& id)
+    {
+      std::stringstream name;
+      name << "distance to point " << id.point
+	   << " of polyhedron " << id.polyhedron;
+      return name.str ();
     }
 
 
@@ -454,6 +1040,200 @@ namespace roboptim
       convexPolyhedrons.push_back (convexPolyhedron);
     }
 
+
+    value_type distancePointToSegment (const point2_t& p,
+				       const point2_t& a,
+				       const point2_t& b)
+    {
+      value_type t = projectionParameterOnSegment (p, a, b);
+      return (a + t * (b - a) - p).norm ();
+    }
+
+
+    value_type projectionParameterOnSegment (const point2_t& p,
+					     const point2_t& a,
+					     const point2_t& b)
+    {
+      value_type d_ab = (b-a).norm ();
+
+      // Segment is a point.
+      if (d_ab < 1e-6) return 0.;
+
+      value_type t = (p-a).dot (b-a)/(d_ab * d_ab);
+      if (t > 1.) return 1.;
+      else if (t < 0.) return 0.;
+      return t;
+    }
+
+
+    polygon_t convexHullFromPoints (const polygon_t& points)
+    {
+      polygon_t sorted (points);
+      std::sort (sorted.begin (), sorted.end (), lexicographicLess);
+      sorted.erase (std::unique (sorted.begin (), sorted.end ()),
+		    sorted.end ());
+
+      if (sorted.size () < 3)
+	return sorted;
+
+      // Andrew's monotone chain: lower hull, then upper hull. The last
+      // point of each chain is the first one of the other.
+      polygon_t hull (2 * sorted.size ());
+      size_t k = 0;
+      for (size_t i = 0; i < sorted.size (); ++i)
+	{
+	  while (k >= 2 && cross (hull[k - 2], hull[k - 1], sorted[i]) <= 0.)
+	    --k;
+	  hull[k++] = sorted[i];
+	}
+      for (size_t i = sorted.size () - 1, lower = k + 1; i > 0; --i)
+	{
+	  while (k >= lower
+		 && cross (hull[k - 2], hull[k - 1], sorted[i - 1]) <= 0.)
+	    --k;
+	  hull[k++] = sorted[i - 1];
+	}
+
+      hull.resize (k - 1);
+      return hull;
+    }
+
+
+    size_t countPoints (const polygons_t& polygons)
+    {
+      size_t nbPoints = 0;
+      BOOST_FOREACH (const polygon_t& polygon, polygons)
+	nbPoints += polygon.size ();
+
+      return nbPoints;
+    }
+
+
+    void
+    computeConvexPolygon (const polygons_t& polygons,
+			  polygons_t& convexPolygons)
+    {
+      assert (polygons.size () !=0 && "Empty polygon vector.");
+      assert (convexPolygons.size() == 0
+	      && "Convex polygon vector must be empty.");
+
+      polygon_t points;
+      points.reserve (countPoints (polygons));
+      BOOST_FOREACH (const polygon_t& polygon, polygons)
+	points.insert (points.end (), polygon.begin (), polygon.end ());
+
+      assert (points.size() > 0 && "Polygon merging failed.");
+
+      convexPolygons.push_back (convexHullFromPoints (points));
+    }
+
+
+    Stadium stadiumFromPoints (const polygon_t& points)
+    {
+      assert (points.size () > 0
+	      && "Cannot compute stadium for empty polygon.");
+
+      point2_t average = point2_t::Zero ();
+      BOOST_FOREACH (const point2_t& p, points)
+	average += p;
+      average /= static_cast<value_type> (points.size ());
+
+      Eigen::Matrix2d covariance = Eigen::Matrix2d::Zero ();
+      BOOST_FOREACH (const point2_t& p, points)
+	covariance += (p - average) * (p - average).transpose ();
+
+      // Eigenvalues are sorted in increasing order: the last
+      // eigenvector is the largest spread direction.
+      Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> es (covariance);
+      vector2_t u = es.eigenvectors ().col (1).normalized ();
+      vector2_t v (-u[1], u[0]);
+
+      value_type squaredRadius = 0.;
+      BOOST_FOREACH (const point2_t& p, points)
+	{
+	  value_type h = v.dot (p - average);
+	  squaredRadius = std::max (squaredRadius, h * h);
+	}
+
+      // Each point bounds the end points, as for capsules (see
+      // CapInterval).
+      CapInterval bounds;
+      BOOST_FOREACH (const point2_t& p, points)
+	{
+	  value_type h = v.dot (p - average);
+	  bounds.add (u.dot (p - average), h * h, squaredRadius);
+	}
+      bounds.close ();
+
+      Stadium stadium;
+      stadium.P0 = average + bounds.start * u;
+      stadium.P1 = average + bounds.end * u;
+      stadium.radius = std::sqrt (squaredRadius);
+
+      return stadium;
+    }
+
+
+    value_type stadiumArea (const_argument_ref param)
+    {
+      assert (param.size () == 5 && "Incorrect param size, expected 5.");
+
+      value_type length = (param.segment<2> (2) - param.segment<2> (0)).norm ();
+      value_type radius = param[4];
+
+      return radius * (2. * length + M_PI * radius);
+    }
+
+
+    value_type inflateToContain (argument_ref stadiumParam,
+				 const polygons_t& polygons)
+    {
+      assert (stadiumParam.size () == 5
+	      && "Incorrect param size, expected 5.");
+
+      point2_t endPoint1 = stadiumParam.segment<2> (0);
+      point2_t endPoint2 = stadiumParam.segment<2> (2);
+
+      value_type radius = 0.;
+      BOOST_FOREACH (const polygon_t& polygon, polygons)
+	BOOST_FOREACH (const point2_t& p, polygon)
+	radius = std::max (radius,
+			   distancePointToSegment (p, endPoint1, endPoint2));
+
+      // A few ulps cover the rounding errors of the distances.
+      radius *= 1. + 16. * std::numeric_limits<value_type>::epsilon ();
+
+      value_type inflation = std::max (0., radius - stadiumParam[4]);
+      stadiumParam[4] += inflation;
+      return inflation;
+    }
+
+
+    void convertStadiumToSolverParam (argument_ref dst,
+				      const point2_t& endPoint1,
+				      const point2_t& endPoint2,
+				      const value_type& radius)
+    {
+      dst.resize (5);
+
+      dst.segment<2> (0) = endPoint1;
+      dst.segment<2> (2) = endPoint2;
+      dst[4] = radius;
+    }
+
+
+    void convertSolverParamToStadium (point2_t& endPoint1,
+				      point2_t& endPoint2,
+				      value_type& radius,
+				      const_argument_ref src)
+    {
+      assert (src.size () == 5 && "Incorrect src size, expected 5.");
+
+      endPoint1 = src.segment<2> (0);
+      endPoint2 = src.segment<2> (2);
+      radius = src[4];
+    }
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
@@ -33,35 +33,123 @@ namespace roboptim
 {
   namespace capsule
   {
+    namespace
+    {
+      typedef Eigen::Matrix<value_type, 7, 7> capsuleHessian_t;
+
+      /// \brief Smoothed segment length and its derivative data.
+      ///
+      /// With \f$d = e_1 - e_2\f$ and \f$s = \sqrt{\|d\|^2 +
+      /// \epsilon^2}\f$, the length is \f$L = s - \epsilon\f$. It is
+      /// the usual length for \f$\epsilon = 0\f$, and is smooth at
+      /// \f$d = 0\f$ for \f$\epsilon > 0\f$.
+      struct SmoothLength
+      {
+	SmoothLength (const_argument_ref argument, value_type epsilon)
+	  : d (argument.segment<3> (0) - argument.segment<3> (3)),
+	    s (std::sqrt (d.squaredNorm () + epsilon * epsilon)),
+	    length (s - epsilon)
+	{
+	}
+
+	/// \brief Gradient of the length with respect to e1, i.e.
+	/// d / s. For a zero-length segment without smoothing, the null
+	/// subgradient is returned.
+	vector3_t gradient () const
+	{
+	  if (s > 0.)
+	    return d / s;
+	  return vector3_t::Zero ();
+	}
+
+	/// \brief Hessian of the length with respect to e1.
+	Eigen::Matrix3d hessian () const
+	{
+	  if (s > 0.)
+	    return (Eigen::Matrix3d::Identity ()
+		    - d * d.transpose () / (s * s)) / s;
+	  return Eigen::Matrix3d::Zero ();
+	}
+
+	vector3_t d;
+	value_type s;
+	value_type length;
+      };
+
+      /// \brief Hessian of the volume with respect to the capsule
+      /// parameters.
+      void volumeHessian (capsuleHessian_t& hessian,
+			  const_argument_ref argument,
+			  value_type epsilon)
+      {
+	SmoothLength l (argument, epsilon);
+	value_type r = argument[6];
+	vector3_t u = l.gradient ();
+
+	Eigen::Matrix3d endPointBlock = M_PI * r * r * l.hessian ();
+
+	hessian.block<3,3> (0, 0) = endPointBlock;
+	hessian.block<3,3> (3, 3) = endPointBlock;
+	hessian.block<3,3> (0, 3) = -endPointBlock;
+	hessian.block<3,3> (3, 0) = -endPointBlock;
+
+	hessian.block<3,1> (0, 6) = 2. * M_PI * r * u;
+	hessian.block<3,1> (3, 6) = -2. * M_PI * r * u;
+	hessian.block<1,3> (6, 0) = hessian.block<3,1> (0, 6).transpose ();
+	hessian.block<1,3> (6, 3) = hessian.block<3,1> (3, 6).transpose ();
+
+	hessian (6, 6) = 2. * M_PI * l.length + 8. * M_PI * r;
+      }
+    } // end of anonymous namespace.
+
     // -------------------PUBLIC FUNCTIONS-----------------------
 
-    Volume::
-    Volume (std::string name)
-      : roboptim::DifferentiableFunction (7, 1, name)
+    template <typename T>
+    GenericVolume<T>::
+    GenericVolume (std::string name)
+      : roboptim::GenericTwiceDifferentiableFunction<T> (7, 1, name),
+	lengthSmoothing_ (0.)
+    {
+    }
+
+    template <typename T>
+    GenericVolume<T>::
+    GenericVolume (size_type inputSize, std::string name,
+		   value_type lengthSmoothing)
+      : roboptim::GenericTwiceDifferentiableFunction<T> (inputSize, 1, name),
+	lengthSmoothing_ (lengthSmoothing)
     {
+      assert (inputSize >= 7 && "Wrong input size, expected at least 7.");
+      assert (lengthSmoothing >= 0.
+	      && "Invalid length smoothing, expected non-negative value.");
     }
 
-    Volume::
-    ~Volume ()
+    template <typename T>
+    GenericVolume<T>::
+    ~GenericVolume ()
     {
     }
 
+    template <typename T>
+    typename GenericVolume<T>::value_type GenericVolume<T>::
+    lengthSmoothing () const
+    {
+      return lengthSmoothing_;
+    }
+
     // -------------------PROTECTED FUNCTIONS--------------------
 
-    void Volume::
+    template <typename T>
+    void GenericVolume<T>::
     impl_compute (result_ref result, const_argument_ref argument) const
     {
-      assert (argument.size () == 7 && "Wrong argument size, expected 7.");
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
 
       result.setZero ();
 
       // Compute capsule volume.
-      value_type length = sqrt ((argument[0] - argument[3])
-				* (argument[0] - argument[3])
-				+ (argument[1] - argument[4])
-				* (argument[1] - argument[4])
-				+ (argument[2] - argument[5])
-				* (argument[2] - argument[5]));
+      value_type length = SmoothLength (argument, lengthSmoothing_).length;
 
       result[0] = length * M_PI * argument[6] * argument[6]
 	+ 4. / 3. * M_PI * argument[6] * argument[6] * argument[6];
@@ -69,47 +157,75 @@ namespace roboptim
       return;
     }
 
-    void Volume::
+    template <typename T>
+    void GenericVolume<T>::
     impl_gradient (gradient_ref gradient,
 		   const_argument_ref argument,
 		   size_type functionId) const
     {
       assert (functionId == 0);
-      assert (argument.size () == 7 &&  "Wrong argument size, expected 7.");
+      assert (argument.size () == this->inputSize ()
+	      && "Wrong argument size.");
 
       gradient.setZero ();
 
-      value_type length = sqrt ((argument[0] - argument[3])
-				* (argument[0] - argument[3])
-				+ (argument[1] - argument[4])
-				* (argument[1] - argument[4])
-				+ (argument[2] - argument[5])
-				* (argument[2] - argument[5]));
+      SmoothLength l (argument, lengthSmoothing_);
+      vector3_t u = l.gradient ();
 
-      gradient[0] = 1 / length * (argument[0] - argument[3])
-      	* M_PI * argument[6] * argument[6];
+      for (size_type i = 0; i < 3; ++i)
+	{
+	  gradient.coeffRef (i) = u[i] * M_PI * argument[6] * argument[6];
+	  gradient.coeffRef (3 + i) = -u[i] * M_PI * argument[6] * argument[6];
+	}
 
-      gradient[1] = 1 / length * (argument[1] - argument[4])
-	* M_PI * argument[6] * argument[6];
-
-      gradient[2] = 1 / length * (argument[2] - argument[5])
-	* M_PI * argument[6] * argument[6];
+      gradient.coeffRef (6) = l.length * 2 * M_PI * argument[6]
+      	+ 4 * M_PI * argument[6] * argument[6];
 
-      gradient[3] = 1 / length * (argument[3] - argument[0])
-	* M_PI * argument[6] * argument[6];
+      return;
+    }
 
-      gradient[4] = 1 / length * (argument[4] - argument[1])
-	* M_PI * argument[6] * argument[6];
+    template <>
+    void GenericVolume<EigenMatrixDense>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == inputSize () && "Wrong argument size.");
 
-      gradient[5] = 1 / length * (argument[5] - argument[2])
-	* M_PI * argument[6] * argument[6];
+      capsuleHessian_t h;
+      volumeHessian (h, argument, lengthSmoothing_);
 
-      gradient[6] = length * 2 * M_PI * argument[6]
-      	+ 4 * M_PI * argument[6] * argument[6];
+      hessian.setZero ();
+      hessian.topLeftCorner<7,7> () = h;
+    }
 
-      return;
+    template <>
+    void GenericVolume<EigenMatrixSparse>::
+    impl_hessian (hessian_ref hessian,
+		  const_argument_ref argument,
+		  size_type functionId) const
+    {
+      assert (functionId == 0);
+      assert (argument.size () == inputSize () && "Wrong argument size.");
+
+      capsuleHessian_t h;
+      volumeHessian (h, argument, lengthSmoothing_);
+
+      // The whole 7x7 block is stored to keep a constant structure.
+      hessian.resize (inputSize (), inputSize ());
+      hessian.setZero ();
+      hessian.reserve (49);
+      for (size_type i = 0; i < 7; ++i)
+	for (size_type j = 0; j < 7; ++j)
+	  hessian.insert (i, j) = h (i, j);
+      hessian.makeCompressed ();
     }
 
+    // Explicit template instantiations.
+    template class GenericVolume<EigenMatrixDense>;
+    template class GenericVolume<EigenMatrixSparse>;
+
   } // end of namespace capsule.
 } // end of namespace roboptim.
 
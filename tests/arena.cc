@@ -0,0 +1,111 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE arena
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread.hpp>
+
+#include "roboptim/capsule/arena.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  void getThreadArena (Arena** arena)
+  {
+    *arena = &threadArena ();
+  }
+}
+
+BOOST_AUTO_TEST_CASE (arena_allocation)
+{
+  Arena arena (1024);
+  BOOST_CHECK_EQUAL (arena.capacity (), 0u);
+
+  // Allocations are aligned and do not overlap.
+  char* a = static_cast<char*> (arena.allocate (3, 1));
+  char* b = static_cast<char*> (arena.allocate (8, 64));
+  BOOST_CHECK_EQUAL (reinterpret_cast<size_t> (b) % 64, 0u);
+  BOOST_CHECK (b >= a + 3);
+  BOOST_CHECK_EQUAL (arena.capacity (), 1024u);
+
+  // Large allocations get their own block.
+  arena.allocate (4096, 8);
+  BOOST_CHECK_EQUAL (arena.capacity (), 1024u + 4096u + 8u);
+
+  // Rewinding reuses the blocks.
+  {
+    ArenaScope scope (arena);
+    void* c = arena.allocate (16, 8);
+    Arena::Marker marker = arena.mark ();
+    {
+      ArenaScope inner (arena);
+      arena.allocate (512, 8);
+    }
+    BOOST_CHECK_EQUAL (arena.mark ().block, marker.block);
+    BOOST_CHECK_EQUAL (arena.mark ().offset, marker.offset);
+    BOOST_CHECK (c != 0);
+  }
+
+  size_t capacity = arena.capacity ();
+  arena.reset ();
+  BOOST_CHECK_EQUAL (arena.allocate (3, 1), a);
+  BOOST_CHECK_EQUAL (arena.capacity (), capacity);
+
+  arena.release ();
+  BOOST_CHECK_EQUAL (arena.capacity (), 0u);
+}
+
+BOOST_AUTO_TEST_CASE (arena_allocator)
+{
+  Arena arena (256);
+
+  for (int k = 0; k < 3; ++k)
+    {
+      ArenaScope scope (arena);
+      std::vector<double, ArenaAllocator<double> >
+	values ((ArenaAllocator<double> (arena)));
+      for (int i = 0; i < 100; ++i)
+	values.push_back (i);
+      BOOST_CHECK_EQUAL (values[99], 99.);
+    }
+
+  // Repeated scopes do not grow the arena.
+  size_t capacity = arena.capacity ();
+  {
+    ArenaScope scope (arena);
+    std::vector<double, ArenaAllocator<double> >
+      values (100, 1., ArenaAllocator<double> (arena));
+  }
+  BOOST_CHECK_EQUAL (arena.capacity (), capacity);
+}
+
+BOOST_AUTO_TEST_CASE (arena_thread)
+{
+  // Each thread has its own arena.
+  Arena* other = 0;
+  boost::thread thread (boost::bind (&getThreadArena, &other));
+  thread.join ();
+
+  BOOST_CHECK (other != 0);
+  BOOST_CHECK (other != &threadArena ());
+  BOOST_CHECK_EQUAL (&threadArena (), &threadArena ());
+}
@@ -0,0 +1,174 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE axis-parameterization
+
+#include <boost/make_shared.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+
+#include "roboptim/capsule/axis-parameterization.hh"
+#include "roboptim/capsule/axis-parameterized-function.hh"
+#include "roboptim/capsule/axis-volume.hh"
+#include "roboptim/capsule/distance-capsule-points.hh"
+#include "roboptim/capsule/volume.hh"
+
+using boost::test_tools::output_test_stream;
+
+BOOST_AUTO_TEST_CASE (axis_parameterization)
+{
+  using namespace roboptim::capsule;
+
+  AxisParameterization parameterization (vector3_t (1., 0.2, -0.3));
+
+  // The reference frame is a rotation.
+  const Eigen::Matrix3d& frame = parameterization.frame ();
+  BOOST_CHECK_SMALL ((frame.transpose () * frame
+		      - Eigen::Matrix3d::Identity ()).norm (), 1e-12);
+  BOOST_CHECK_CLOSE (frame.determinant (), 1., 1e-6);
+
+  // End points -> axis -> end points.
+  argument_t endPoints (7);
+  endPoints << 0.3, -0.1, 0.2, -0.4, 0.5, 0.1, 0.7;
+
+  argument_t axisParam (7);
+  parameterization.fromEndPoints (axisParam, endPoints);
+  BOOST_CHECK_CLOSE (axisParam[5],
+		     0.5 * (endPoints.segment<3> (3)
+			    - endPoints.segment<3> (0)).norm (), 1e-6);
+  BOOST_CHECK_EQUAL (axisParam[6], endPoints[6]);
+
+  argument_t result (7);
+  parameterization.toEndPoints (result, axisParam);
+  BOOST_CHECK_SMALL ((result - endPoints).norm (), 1e-12);
+
+  // Zero-length segment.
+  argument_t sphere (7);
+  sphere << 0.1, 0.2, 0.3, 0.1, 0.2, 0.3, 0.5;
+  parameterization.fromEndPoints (axisParam, sphere);
+  BOOST_CHECK_EQUAL (axisParam[5], 0.);
+  parameterization.toEndPoints (result, axisParam);
+  BOOST_CHECK_SMALL ((result - sphere).norm (), 1e-12);
+
+  // Jacobian against finite differences.
+  argument_t x (7);
+  x << 0.1, -0.2, 0.3, 0.4, -0.6, 0.8, 0.5;
+  AxisParameterization::jacobian_t jacobian;
+  parameterization.jacobian (jacobian, x);
+
+  value_type step = 1e-6;
+  argument_t xp (7), yp (7), ym (7);
+  for (size_type j = 0; j < 7; ++j)
+    {
+      xp = x;
+      xp[j] += step;
+      parameterization.toEndPoints (yp, xp);
+      xp[j] -= 2. * step;
+      parameterization.toEndPoints (ym, xp);
+      BOOST_CHECK_SMALL ((jacobian.col (j)
+			  - (yp - ym) / (2. * step)).norm (), 1e-6);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (axis_volume)
+{
+  using namespace roboptim::capsule;
+
+  AxisParameterization parameterization (vector3_t (0., 0., 1.));
+
+  argument_t endPoints (7);
+  endPoints << 0.1, 0., 0., -0.1, 0.2, 0.3, 0.6;
+  argument_t argument (7);
+  parameterization.fromEndPoints (argument, endPoints);
+
+  // Same volume as with end points.
+  AxisVolume volume;
+  Volume endPointsVolume;
+  BOOST_CHECK_CLOSE (volume (argument)[0], endPointsVolume (endPoints)[0],
+		     1e-6);
+  BOOST_CHECK_EQUAL (checkGradient (volume, 0, argument, 1e-6), true);
+
+  // Hessian against finite differences of the gradient.
+  AxisVolume::hessian_t hessian = volume.hessian (argument);
+  value_type step = 1e-6;
+  argument_t xp (7);
+  for (size_type j = 0; j < 7; ++j)
+    {
+      xp = argument;
+      xp[j] += step;
+      vector_t gp = volume.gradient (xp, 0);
+      xp[j] -= 2. * step;
+      vector_t gm = volume.gradient (xp, 0);
+      BOOST_CHECK_SMALL ((hessian.col (j) - (gp - gm) / (2. * step)).norm (),
+			 1e-5);
+    }
+
+  SparseAxisVolume sparseVolume;
+  SparseAxisVolume::hessian_t sparseHessian (7, 7);
+  sparseVolume.hessian (sparseHessian, argument);
+  BOOST_CHECK_EQUAL (sparseHessian.nonZeros (), 4);
+  BOOST_CHECK_SMALL ((matrix_t (sparseHessian) - hessian).norm (), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (axis_parameterized_function)
+{
+  using namespace roboptim::capsule;
+
+  polyhedron_t polyhedron;
+  polyhedron.push_back (point_t (0.5, 0.2, -0.1));
+  polyhedron.push_back (point_t (-0.4, 0.1, 0.3));
+  polyhedron.push_back (point_t (0.05, 0.3, 0.1));
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  AxisParameterization parameterization (vector3_t (1., 0., 0.));
+
+  boost::shared_ptr<DistanceCapsulePoints>
+    distances (new DistanceCapsulePoints (polyhedrons));
+  boost::shared_ptr<SparseDistanceCapsulePoints>
+    sparseDistances (new SparseDistanceCapsulePoints (polyhedrons));
+  AxisParameterizedFunction function (distances, parameterization);
+  SparseAxisParameterizedFunction sparseFunction (sparseDistances,
+						  parameterization);
+
+  argument_t endPoints (7);
+  endPoints << 0.2, 0., 0.05, -0.2, 0.05, 0., 0.8;
+  argument_t argument (7);
+  parameterization.fromEndPoints (argument, endPoints);
+
+  // Same values as with end points.
+  BOOST_CHECK_SMALL (((*distances) (endPoints) - function (argument)).norm (),
+		     1e-12);
+  BOOST_CHECK_SMALL ((sparseFunction (argument) - function (argument)).norm (),
+		     1e-12);
+
+  for (size_type i = 0; i < function.outputSize (); ++i)
+    BOOST_CHECK_EQUAL (checkGradient (function, static_cast<int> (i),
+				      argument, 1e-6), true);
+
+  // Dense and sparse Jacobians match, and the sparse structure is
+  // constant.
+  AxisParameterizedFunction::jacobian_t jacobian = function.jacobian (argument);
+  SparseAxisParameterizedFunction::jacobian_t
+    sparseJacobian (sparseFunction.outputSize (), 7);
+  sparseFunction.jacobian (sparseJacobian, argument);
+  BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (), 7 * function.outputSize ());
+  BOOST_CHECK_SMALL ((matrix_t (sparseJacobian) - jacobian).norm (), 1e-12);
+}
@@ -56,3 +56,70 @@ BOOST_AUTO_TEST_CASE (capsule_volume)
   bool isGoodGradient = checkGradient (volumeFunction, 0, argument);
   BOOST_CHECK_EQUAL (isGoodGradient, true);
 }
+
+BOOST_AUTO_TEST_CASE (capsule_volume_hessian)
+{
+  using namespace roboptim::capsule;
+
+  Volume volumeFunction ("capsule volume");
+  SparseVolume sparseVolumeFunction ("capsule volume");
+
+  argument_t argument (7);
+  argument << 0.1, -0.2, -1., 0.3, 0.1, 1.2, 0.8;
+
+  // Compare the Hessian with finite differences of the gradient.
+  Volume::hessian_t hessian = volumeFunction.hessian (argument);
+  value_type step = 1e-6;
+  for (size_type j = 0; j < 7; ++j)
+    {
+      argument_t x = argument;
+      x[j] += step;
+      vector_t gPlus = volumeFunction.gradient (x);
+      x[j] -= 2. * step;
+      vector_t gMinus = volumeFunction.gradient (x);
+
+      vector_t fdColumn = (gPlus - gMinus) / (2. * step);
+      BOOST_CHECK_SMALL ((hessian.col (j) - fdColumn).norm (), 1e-5);
+    }
+
+  // The Hessian is symmetric.
+  BOOST_CHECK_SMALL ((hessian - hessian.transpose ()).norm (), 1e-12);
+
+  // Sparse and dense Hessians match.
+  SparseVolume::hessian_t sparseHessian (7, 7);
+  sparseVolumeFunction.hessian (sparseHessian, argument);
+  BOOST_CHECK_SMALL ((matrix_t (sparseHessian) - hessian).norm (), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (capsule_volume_zero_length)
+{
+  using namespace roboptim::capsule;
+
+  // Spherical capsule: both end points are equal.
+  argument_t argument (7);
+  argument << 0.1, -0.2, 0.3, 0.1, -0.2, 0.3, 0.5;
+
+  value_type sphereVolume = 4. / 3. * M_PI * std::pow (0.5, 3);
+
+  // Without smoothing, the volume is exact and the gradient finite.
+  Volume volumeFunction ("capsule volume");
+  BOOST_CHECK_CLOSE (volumeFunction (argument)[0], sphereVolume, 1e-6);
+  vector_t gradient = volumeFunction.gradient (argument);
+  BOOST_CHECK (gradient.allFinite ());
+
+  // With smoothing, the volume is differentiable at zero length.
+  Volume smoothVolumeFunction (7, "capsule volume", 1e-3);
+  BOOST_CHECK_CLOSE (smoothVolumeFunction (argument)[0], sphereVolume, 1e-6);
+  BOOST_CHECK_EQUAL (checkGradient (smoothVolumeFunction, 0, argument),
+		     true);
+
+  Volume::hessian_t hessian = smoothVolumeFunction.hessian (argument);
+  BOOST_CHECK (hessian.allFinite ());
+
+  // Smoothing only slightly changes the volume of long capsules.
+  argument[3] += 1.;
+  BOOST_CHECK_CLOSE (smoothVolumeFunction (argument)[0],
+		     volumeFunction (argument)[0], 1e-1);
+  BOOST_CHECK_EQUAL (checkGradient (smoothVolumeFunction, 0, argument),
+		     true);
+}
@@ -83,3 +83,24 @@ BOOST_AUTO_TEST_CASE (distance_capsule_polyhedron)
 			 true);
     }
 }
+
+BOOST_AUTO_TEST_CASE (distance_capsule_point_name)
+{
+  using namespace roboptim::capsule;
+
+  PointId id;
+  id.polyhedron = 1;
+  id.point = 3;
+
+  // The name is not stored, it is built from the point identity.
+  DistanceCapsulePoint distanceFunction (point_t (1., 0., 0.), id);
+  BOOST_CHECK (distanceFunction.getName ().empty ());
+  BOOST_CHECK_EQUAL (distanceFunction.name (), constraintName (id));
+
+  output_test_stream output;
+  distanceFunction.print (output);
+  BOOST_CHECK (output.is_equal (constraintName (id)));
+
+  DistanceCapsulePoint namedFunction (point_t (1., 0., 0.), "named");
+  BOOST_CHECK_EQUAL (namedFunction.name (), "named");
+}
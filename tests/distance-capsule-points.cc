@@ -0,0 +1,106 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE distance-capsule-points
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+
+#include "roboptim/capsule/distance-capsule-point.hh"
+#include "roboptim/capsule/distance-capsule-points.hh"
+
+using boost::test_tools::output_test_stream;
+
+BOOST_AUTO_TEST_CASE (distance_capsule_points)
+{
+  using namespace roboptim::capsule;
+
+  // Build cubic polyhedron.
+  polyhedron_t polyhedron;
+  value_type halfLength = 0.5;
+
+  polyhedron.push_back (point_t (-halfLength, -halfLength, -halfLength));
+  polyhedron.push_back (point_t (-halfLength, -halfLength, halfLength));
+  polyhedron.push_back (point_t (-halfLength, halfLength, -halfLength));
+  polyhedron.push_back (point_t (-halfLength, halfLength, halfLength));
+  polyhedron.push_back (point_t (halfLength, -halfLength, -halfLength));
+  polyhedron.push_back (point_t (halfLength, -halfLength, halfLength));
+  polyhedron.push_back (point_t (halfLength, halfLength, -halfLength));
+  polyhedron.push_back (point_t (halfLength, halfLength, halfLength));
+  // Points projecting inside the segment.
+  polyhedron.push_back (point_t (0.05, 0.3, 0.1));
+  polyhedron.push_back (point_t (-0.02, -0.1, 0.4));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  // Compute distance for capsule given by argument.
+  argument_t argument (7);
+
+  // First end point.
+  argument[0] = 0.1;
+  argument[1] = 0.;
+  argument[2] = 0.;
+  // Second end point.
+  argument[3] = -0.1;
+  argument[4] = 0.;
+  argument[5] = 0.;
+  // Radius.
+  argument[6] = sqrt (3) / 2;
+
+  DistanceCapsulePoints distances (polyhedrons);
+  SparseDistanceCapsulePoints sparseDistances (polyhedrons);
+
+  BOOST_CHECK_EQUAL (distances.outputSize (),
+		     static_cast<size_type> (polyhedron.size ()));
+
+  vector_t result = distances (argument);
+  vector_t sparseResult = sparseDistances (argument);
+
+  for (size_t i = 0; i < polyhedron.size (); ++i)
+    {
+      size_type id = static_cast<size_type> (i);
+
+      // Stacked distances match the single point function.
+      DistanceCapsulePoint distanceFunction (polyhedron[i]);
+      BOOST_CHECK_CLOSE (result[id], distanceFunction (argument)[0], 1e-6);
+      BOOST_CHECK_CLOSE (sparseResult[id], result[id], 1e-6);
+
+      BOOST_CHECK_EQUAL (checkGradient (distances, static_cast<int> (id),
+					argument, 1e-6), true);
+    }
+
+  // The dense Jacobian matches the gradients.
+  DistanceCapsulePoints::jacobian_t jacobian = distances.jacobian (argument);
+  for (size_type i = 0; i < distances.outputSize (); ++i)
+    {
+      vector_t gradient = distances.gradient (argument, i);
+      BOOST_CHECK_SMALL ((jacobian.row (i).transpose () - gradient).norm (),
+			 1e-12);
+    }
+
+  // The sparse Jacobian has a constant structure: 7 non-zeros per row.
+  SparseDistanceCapsulePoints::jacobian_t
+    sparseJacobian (sparseDistances.outputSize (), 7);
+  sparseDistances.jacobian (sparseJacobian, argument);
+  BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (),
+		     7 * sparseDistances.outputSize ());
+  BOOST_CHECK_SMALL ((matrix_t (sparseJacobian) - jacobian).norm (), 1e-12);
+}
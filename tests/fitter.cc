@@ -17,6 +17,8 @@
 
 #define BOOST_TEST_MODULE fitter
 
+#include <cmath>
+
 #include <boost/test/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
 
@@ -92,6 +94,42 @@ BOOST_AUTO_TEST_CASE (fitter)
   BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[5], 0.,epsilon);
   BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[6], 0.77191705555821011, epsilon)
 
+  // By symmetry, all the corners support the capsule. They are mapped
+  // back to the original polyhedron.
+  fitter_cube.activeTolerance () = 1e-2;
+  fitter_cube.computeBestFitCapsule (initParam);
+  const Fitter::supportPoints_t& supports = fitter_cube.supportPoints ();
+  BOOST_CHECK_EQUAL (supports.size (), 8u);
+
+  polyhedron_t supportPoints;
+  for (size_t i = 0; i < supports.size (); ++i)
+    supportPoints.push_back (convexPolyhedrons[supports[i].id.polyhedron]
+			     [supports[i].id.point]);
+  std::vector<PointId> ids;
+  matchPoints (ids, supportPoints, polyhedrons);
+  for (size_t i = 0; i < ids.size (); ++i)
+    BOOST_CHECK_EQUAL (ids[i].polyhedron, 0u);
+
+  // The smooth formulation should reach the same capsule.
+  Fitter fitter_smooth (convexPolyhedrons);
+  fitter_smooth.constraintType () = Fitter::SQUARED_DISTANCE;
+  fitter_smooth.computeBestFitCapsule (initParam);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_smooth.solutionVolume (),
+			     fitter_cube.solutionVolume (), epsilon);
+
+  // Same with exact Hessians.
+  fitter_smooth.useExactHessian () = true;
+  fitter_smooth.computeBestFitCapsule (initParam);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_smooth.solutionVolume (),
+			     fitter_cube.solutionVolume (), epsilon);
+
+  // Same with the axis parameterization.
+  Fitter fitter_axis (convexPolyhedrons);
+  fitter_axis.parameterization () = Fitter::AXIS;
+  fitter_axis.computeBestFitCapsule (initParam);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_axis.solutionVolume (),
+			     fitter_cube.solutionVolume (), epsilon);
+
   polyhedrons.clear ();
   convexPolyhedrons.clear ();
 
@@ -115,3 +153,250 @@ BOOST_AUTO_TEST_CASE (fitter)
   fitter_rect.computeBestFitCapsule (initParam);
   std::cout << fitter_rect << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE (fitter_sphere)
+{
+  using namespace roboptim::capsule;
+
+  // Octahedron: the best fitting capsule is the unit sphere, i.e. a
+  // capsule with a zero-length segment.
+  polyhedron_t polyhedron;
+  polyhedron.push_back (point_t (1., 0., 0.));
+  polyhedron.push_back (point_t (-1., 0., 0.));
+  polyhedron.push_back (point_t (0., 1., 0.));
+  polyhedron.push_back (point_t (0., -1., 0.));
+  polyhedron.push_back (point_t (0., 0., 1.));
+  polyhedron.push_back (point_t (0., 0., -1.));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius = 0.;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  Fitter fitter (polyhedrons);
+  fitter.lengthSmoothing () = 1e-3;
+  fitter.computeBestFitCapsule (initParam);
+  std::cout << fitter << std::endl;
+
+  double epsilon = 1e-1;
+  argument_t solutionParam = fitter.solutionParam ();
+  BOOST_CHECK_SMALL ((solutionParam.segment<3> (0)
+		      - solutionParam.segment<3> (3)).norm (), epsilon);
+  BOOST_CHECK_SMALL_OR_CLOSE(solutionParam[6], 1., epsilon);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_sparse)
+{
+  using namespace roboptim::capsule;
+
+  // Box elongated along x, with an offset corner so that the solution
+  // is unique.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 1.5 : -1.5,
+				   (i & 2) ? 0.4 : -0.4,
+				   (i & 4) ? 0.3 : -0.3));
+  polyhedron.push_back (point_t (0.2, 0.1, 0.45));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius = 0.;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  Fitter fitter_dense (polyhedrons);
+  fitter_dense.computeBestFitCapsule (initParam);
+
+  // The stacked constraint with a sparse solver reaches the same
+  // capsule, with both formulations.
+  Fitter fitter_sparse (polyhedrons);
+  fitter_sparse.useSparseMatrices () = true;
+  fitter_sparse.computeBestFitCapsule (initParam);
+
+  double epsilon = 1e-2;
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_sparse.solutionVolume (),
+			     fitter_dense.solutionVolume (), epsilon);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_sparse.solutionParam ()[6],
+			     fitter_dense.solutionParam ()[6], epsilon);
+
+  fitter_sparse.constraintType () = Fitter::SQUARED_DISTANCE;
+  fitter_sparse.computeBestFitCapsule (initParam);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_sparse.solutionVolume (),
+			     fitter_dense.solutionVolume (), epsilon);
+
+  // Same with the axis parameterization.
+  fitter_sparse.constraintType () = Fitter::DISTANCE;
+  fitter_sparse.parameterization () = Fitter::AXIS;
+  fitter_sparse.computeBestFitCapsule (initParam);
+  BOOST_CHECK_SMALL_OR_CLOSE(fitter_sparse.solutionVolume (),
+			     fitter_dense.solutionVolume (), epsilon);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_containment)
+{
+  using namespace roboptim::capsule;
+
+  // Points on a helix around the x axis.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 60; ++i)
+    {
+      value_type t = 0.3 * i;
+      polyhedron.push_back (point_t (0.05 * i, 0.4 * std::cos (t),
+				     0.3 * std::sin (t)));
+    }
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius = 0.;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  Fitter fitter (polyhedrons);
+  fitter.computeBestFitCapsule (initParam);
+
+  // The verified solution contains every input point, whatever the
+  // solver tolerances.
+  BOOST_CHECK (fitter.verifyContainment ());
+  BOOST_CHECK_GE (fitter.radiusInflation (), 0.);
+
+  argument_t solutionParam = fitter.solutionParam ();
+  point_t p0 = solutionParam.segment<3> (0);
+  point_t p1 = solutionParam.segment<3> (3);
+  for (size_t i = 0; i < polyhedron.size (); ++i)
+    BOOST_CHECK_LE (distancePointToSegment (polyhedron[i], p0, p1),
+		    solutionParam[6]);
+
+  // Without verification, the radius is the solver one.
+  fitter.verifyContainment () = false;
+  fitter.computeBestFitCapsule (initParam);
+  BOOST_CHECK_EQUAL (fitter.radiusInflation (), 0.);
+}
+
+BOOST_AUTO_TEST_CASE (fitter_support_points)
+{
+  using namespace roboptim::capsule;
+
+  // Box elongated along x, with points inside.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 1. : -1.,
+				   (i & 2) ? 0.25 : -0.25,
+				   (i & 4) ? 0.25 : -0.25));
+  polyhedron.push_back (point_t (0., 0., 0.));
+  polyhedron.push_back (point_t (0.5, 0.1, -0.1));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius = 0.;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  Fitter fitter (polyhedrons);
+  fitter.activeTolerance () = 1e-2;
+  fitter.computeBestFitCapsule (initParam);
+
+  // One multiplier per point.
+  BOOST_CHECK_EQUAL (fitter.multipliers ().size (),
+		     static_cast<size_type> (countPoints (polyhedrons)));
+
+  // Support points lie on the surface, up to the tolerance, and the
+  // interior points never support the capsule.
+  const Fitter::supportPoints_t& supports = fitter.supportPoints ();
+  BOOST_CHECK (!supports.empty ());
+
+  value_type r = fitter.solutionParam ()[6];
+  for (size_t i = 0; i < supports.size (); ++i)
+    {
+      const Fitter::SupportPoint& support = supports[i];
+      BOOST_CHECK_LT (support.id.point, 8u);
+      BOOST_CHECK_GE (support.distance, (1. - fitter.activeTolerance ()) * r);
+      BOOST_CHECK_LE (support.distance, r);
+      BOOST_CHECK_EQUAL (support.multiplier,
+			 fitter.multipliers ()
+			 [static_cast<size_type>
+			  (indexFromPointId (polyhedrons, support.id))]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (fitter_fallback)
+{
+  using namespace roboptim::capsule;
+
+  // Box elongated along x.
+  polyhedron_t polyhedron;
+  for (int i = 0; i < 8; ++i)
+    polyhedron.push_back (point_t ((i & 1) ? 2. : -2.,
+				   (i & 2) ? 0.5 : -0.5,
+				   (i & 4) ? 0.5 : -0.5));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  point_t endPoint1, endPoint2;
+  value_type radius = 0.;
+  computeBoundingCapsulePolyhedron (polyhedrons, endPoint1, endPoint2, radius);
+
+  argument_t initParam (7);
+  convertCapsuleToSolverParam (initParam, endPoint1, endPoint2, radius);
+
+  // A single iteration is not enough: every optimization fails, and the
+  // chain ends with the heuristic.
+  Fitter fitter (polyhedrons);
+  fitter.maxIterations () = 1;
+  fitter.verbose () = false;
+  fitter.solverLogFile () = "";
+  fitter.computeBestFitCapsule (initParam);
+
+  const Fitter::attempts_t& attempts = fitter.attempts ();
+  BOOST_REQUIRE_EQUAL (attempts.size (), 5u);
+  BOOST_CHECK_EQUAL (attempts[0].step, Fitter::INITIAL_SOLVE);
+  BOOST_CHECK (attempts[0].status == Fitter::NO_SOLUTION
+	       || attempts[0].status == Fitter::SOLVER_FAILED);
+  BOOST_CHECK_EQUAL (attempts[1].step, Fitter::PERTURBED_START);
+  BOOST_CHECK_EQUAL (attempts[2].step, Fitter::OTHER_PARAMETERIZATION);
+
+  // No fallback solver: the step is skipped, but recorded.
+  BOOST_CHECK_EQUAL (attempts[3].step, Fitter::OTHER_SOLVER);
+  BOOST_CHECK_EQUAL (attempts[3].status, Fitter::NOT_SOLVED);
+  BOOST_CHECK_EQUAL (attempts[4].step, Fitter::HEURISTIC);
+  BOOST_CHECK_EQUAL (attempts[4].status, Fitter::HEURISTIC_SOLUTION);
+  BOOST_CHECK_EQUAL (fitter.solverStatus (), Fitter::HEURISTIC_SOLUTION);
+
+  argument_t solutionParam = fitter.solutionParam ();
+  BOOST_CHECK_LE (maxDistanceToSegment (polyhedrons,
+					solutionParam.segment<3> (0),
+					solutionParam.segment<3> (3)),
+		  solutionParam[6]);
+  BOOST_CHECK_LE (fitter.solutionVolume (), fitter.initVolume ());
+
+  // When the perturbed start fails too, the solution is the initial
+  // guess, not the perturbed capsule.
+  fitter.fallbacks ().clear ();
+  fitter.fallbacks ().push_back (Fitter::PERTURBED_START);
+  fitter.computeBestFitCapsule (initParam);
+
+  BOOST_REQUIRE_EQUAL (fitter.attempts ().size (), 2u);
+  BOOST_CHECK (fitter.solverStatus () == Fitter::NO_SOLUTION
+	       || fitter.solverStatus () == Fitter::SOLVER_FAILED);
+  BOOST_CHECK_SMALL ((fitter.solutionParam ().head (6)
+		      - initParam.head (6)).norm (), 1e-12);
+  BOOST_CHECK_GE (fitter.solutionParam ()[6], initParam[6]);
+  BOOST_CHECK_LE (fitter.solutionParam ()[6], 1.001 * initParam[6]);
+}
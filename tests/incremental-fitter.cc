@@ -0,0 +1,91 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE incremental-fitter
+
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/incremental-fitter.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+BOOST_AUTO_TEST_CASE (incremental_fitter_edits)
+{
+  // Points of a capsule along x, with radius 0.1.
+  polyhedron_t points;
+  points.push_back (point_t (-0.6, 0., 0.));
+  points.push_back (point_t (0.6, 0., 0.));
+  points.push_back (point_t (0., 0.1, 0.));
+  points.push_back (point_t (0., -0.1, 0.));
+  points.push_back (point_t (0., 0., 0.1));
+  points.push_back (point_t (0., 0., -0.1));
+  points.push_back (point_t (0.2, 0.02, 0.));
+
+  argument_t capsule (7);
+  convertCapsuleToSolverParam (capsule, point_t (-0.5, 0., 0.),
+			       point_t (0.5, 0., 0.), 0.1);
+
+  IncrementalFitter fitter (points, capsule);
+  BOOST_CHECK_EQUAL (fitter.size (), points.size ());
+  BOOST_CHECK (!fitter.needsRefit ());
+  BOOST_CHECK_EQUAL (fitter.activePoints ().size (), 6u);
+
+  // Interior edits keep the capsule.
+  size_t id = fitter.addPoint (point_t (0.1, 0.05, 0.));
+  BOOST_CHECK_EQUAL (id, points.size ());
+  BOOST_CHECK (fitter.contains (id));
+  BOOST_CHECK (!fitter.needsRefit ());
+
+  fitter.movePoint (6, point_t (-0.2, 0., 0.03));
+  BOOST_CHECK (!fitter.needsRefit ());
+  BOOST_CHECK_EQUAL (fitter.point (6), point_t (-0.2, 0., 0.03));
+
+  fitter.removePoint (id);
+  BOOST_CHECK (!fitter.contains (id));
+  BOOST_CHECK (!fitter.needsRefit ());
+  BOOST_CHECK_EQUAL (fitter.size (), points.size ());
+
+  BOOST_CHECK (!fitter.update ());
+  BOOST_CHECK_EQUAL (fitter.refitCount (), 0u);
+  BOOST_CHECK_EQUAL (fitter.capsule (), capsule);
+
+  // Removing an active point may shrink the capsule.
+  fitter.removePoint (2);
+  BOOST_CHECK (fitter.needsRefit ());
+}
+
+BOOST_AUTO_TEST_CASE (incremental_fitter_outside)
+{
+  polyhedron_t points;
+  points.push_back (point_t (-0.5, 0., 0.));
+  points.push_back (point_t (0.5, 0., 0.));
+
+  argument_t capsule (7);
+  convertCapsuleToSolverParam (capsule, point_t (-0.5, 0., 0.),
+			       point_t (0.5, 0., 0.), 0.1);
+
+  // A point outside the capsule makes it infeasible.
+  IncrementalFitter fitter (points, capsule);
+  fitter.addPoint (point_t (0., 0.2, 0.));
+  BOOST_CHECK (fitter.needsRefit ());
+
+  // Without a capsule, the first update fits it.
+  IncrementalFitter fresh (points);
+  BOOST_CHECK (fresh.needsRefit ());
+  BOOST_CHECK_EQUAL (fresh.capsule ().size (), 0);
+}
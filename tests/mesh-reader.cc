@@ -0,0 +1,263 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE mesh-reader
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/mesh-reader.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  // Append little-endian values to a binary buffer.
+  void writeUInt32 (std::string& s, boost::uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i)
+      s += static_cast<char> ((value >> (8 * i)) & 0xff);
+  }
+
+  void writeFloat32 (std::string& s, float value)
+  {
+    boost::uint32_t bits;
+    std::memcpy (&bits, &value, 4);
+    writeUInt32 (s, bits);
+  }
+
+  void writeFloat64 (std::string& s, double value)
+  {
+    boost::uint64_t bits;
+    std::memcpy (&bits, &value, 8);
+    for (int i = 0; i < 8; ++i)
+      s += static_cast<char> ((bits >> (8 * i)) & 0xff);
+  }
+
+  polyhedron_t read (const std::string& data, MeshFormat format)
+  {
+    std::istringstream ss (data, std::ios::in | std::ios::binary);
+    polyhedron_t points;
+    readMeshPoints (ss, format, points);
+    return points;
+  }
+}
+
+BOOST_AUTO_TEST_CASE (mesh_format)
+{
+  BOOST_CHECK_EQUAL (meshFormatFromName ("part.STL"), MESH_STL);
+  BOOST_CHECK_EQUAL (meshFormatFromName ("dir.v2/part.obj"), MESH_OBJ);
+  BOOST_CHECK_EQUAL (meshFormatFromName ("ply"), MESH_PLY);
+  BOOST_CHECK_EQUAL (meshFormatFromName ("scan.xyz"), MESH_XYZ);
+  BOOST_CHECK_EQUAL (meshFormatFromName ("-"), MESH_UNKNOWN);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_stl)
+{
+  // ASCII: the first facet is split across the binary header size.
+  std::string ascii =
+    "solid test\n"
+    "  facet normal 0 0 1\n"
+    "    outer loop\n"
+    "      vertex 0 0 0\n"
+    "      vertex 1.5 0 0\n"
+    "      vertex 0 2.25 -1e-1\n"
+    "    endloop\n"
+    "  endfacet\n"
+    "endsolid test\n";
+  polyhedron_t points = read (ascii, MESH_STL);
+  BOOST_REQUIRE_EQUAL (points.size (), 3);
+  BOOST_CHECK_EQUAL (points[1][0], 1.5);
+  BOOST_CHECK_EQUAL (points[2][1], 2.25);
+  BOOST_CHECK_EQUAL (points[2][2], -0.1);
+
+  // ASCII, with a name filling the binary header.
+  std::string longName = "solid " + std::string (100, 'x') + "\n"
+    + ascii.substr (ascii.find ('\n') + 1);
+  points = read (longName, MESH_STL);
+  BOOST_REQUIRE_EQUAL (points.size (), 3);
+  BOOST_CHECK_EQUAL (points[1][0], 1.5);
+
+  // Binary, with a header starting with "solid".
+  std::string binary ("solid binary header");
+  binary.resize (80, ' ');
+  writeUInt32 (binary, 2);
+  for (int f = 0; f < 2; ++f)
+    {
+      for (int i = 0; i < 3; ++i)
+	writeFloat32 (binary, 0.f);
+      for (int v = 0; v < 3; ++v)
+	for (int i = 0; i < 3; ++i)
+	  writeFloat32 (binary, static_cast<float> (f * 9 + v * 3 + i));
+      binary += std::string (2, '\0');
+    }
+  points = read (binary, MESH_STL);
+  BOOST_REQUIRE_EQUAL (points.size (), 6);
+  BOOST_CHECK_EQUAL (points[5][2], 17.);
+
+  binary.resize (binary.size () - 10);
+  BOOST_CHECK_THROW (read (binary, MESH_STL), std::runtime_error);
+
+  // The facet count of the header is not trusted.
+  binary.resize (80);
+  writeUInt32 (binary, 0xffffffff);
+  BOOST_CHECK_THROW (read (binary, MESH_STL), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_obj)
+{
+  std::string obj =
+    "# comment\n"
+    "v 1 2 3\n"
+    "vn 0 0 1\n"
+    "vt 0.5 0.5\n"
+    "  v\t-1 -2 -3 1.0\r\n"
+    "f 1 2 3\n";
+  polyhedron_t points = read (obj, MESH_OBJ);
+  BOOST_REQUIRE_EQUAL (points.size (), 2);
+  BOOST_CHECK_EQUAL (points[0], point_t (1., 2., 3.));
+  BOOST_CHECK_EQUAL (points[1], point_t (-1., -2., -3.));
+
+  BOOST_CHECK_THROW (read ("v 1 a 3\n", MESH_OBJ), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_ply)
+{
+  std::string ascii =
+    "ply\n"
+    "format ascii 1.0\n"
+    "comment test\n"
+    "element vertex 2\n"
+    "property float z\n"
+    "property float x\n"
+    "property float y\n"
+    "element face 1\n"
+    "property list uchar int vertex_indices\n"
+    "end_header\n"
+    "3 1 2\n"
+    "6 4 5\n"
+    "3 0 1 1\n";
+  polyhedron_t points = read (ascii, MESH_PLY);
+  BOOST_REQUIRE_EQUAL (points.size (), 2);
+  BOOST_CHECK_EQUAL (points[0], point_t (1., 2., 3.));
+  BOOST_CHECK_EQUAL (points[1], point_t (4., 5., 6.));
+
+  // Binary, with an extra vertex property.
+  std::string binary =
+    "ply\r\n"
+    "format binary_little_endian 1.0\r\n"
+    "element vertex 2\r\n"
+    "property double x\r\n"
+    "property double y\r\n"
+    "property double z\r\n"
+    "property uchar red\r\n"
+    "end_header\n";
+  for (int v = 0; v < 2; ++v)
+    {
+      for (int i = 0; i < 3; ++i)
+	writeFloat64 (binary, 0.5 * (3 * v + i));
+      binary += static_cast<char> (255);
+    }
+  points = read (binary, MESH_PLY);
+  BOOST_REQUIRE_EQUAL (points.size (), 2);
+  BOOST_CHECK_EQUAL (points[1], point_t (1.5, 2., 2.5));
+
+  // The vertex count of the header is not trusted.
+  std::string huge =
+    "ply\n"
+    "format binary_little_endian 1.0\n"
+    "element vertex 18446744073709551615\n"
+    "property double x\n"
+    "property double y\n"
+    "property double z\n"
+    "end_header\n";
+  writeFloat64 (huge, 1.);
+  BOOST_CHECK_THROW (read (huge, MESH_PLY), std::runtime_error);
+
+  BOOST_CHECK_THROW (read ("off\n", MESH_PLY), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_xyz)
+{
+  std::string xyz;
+  for (int i = 0; i < 6; ++i)
+    writeFloat64 (xyz, 0.25 * i);
+  polyhedron_t points = read (xyz, MESH_XYZ);
+  BOOST_REQUIRE_EQUAL (points.size (), 2);
+  BOOST_CHECK_EQUAL (points[1], point_t (0.75, 1., 1.25));
+
+  // Points are appended.
+  std::istringstream ss (xyz, std::ios::in | std::ios::binary);
+  readMeshPoints (ss, MESH_XYZ, points);
+  BOOST_CHECK_EQUAL (points.size (), 4);
+
+  xyz.resize (xyz.size () - 1);
+  BOOST_CHECK_THROW (read (xyz, MESH_XYZ), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (mesh_reader_batch)
+{
+  namespace fs = boost::filesystem;
+
+  fs::path directory ("mesh-reader-test-batch");
+  fs::remove_all (directory);
+  fs::create_directory (directory);
+
+  const char* files[] = { "b.obj", "a.STL", "notes.txt", "manifest" };
+  for (size_t i = 0; i < 4; ++i)
+    {
+      std::ofstream file ((directory / files[i]).string ().c_str ());
+    }
+  fs::create_directory (directory / "c.ply");
+
+  // Only regular files with a mesh extension, sorted.
+  std::vector<std::string> inputs = listMeshFiles (directory.string ());
+  BOOST_REQUIRE_EQUAL (inputs.size (), 2);
+  BOOST_CHECK_EQUAL (inputs[0], (directory / "a.STL").string ());
+  BOOST_CHECK_EQUAL (inputs[1], (directory / "b.obj").string ());
+
+  BOOST_CHECK_THROW (listMeshFiles ((directory / "b.obj").string ()),
+		     std::runtime_error);
+
+  // Comments and blank lines are skipped, relative paths are resolved
+  // from the manifest directory.
+  fs::path manifest = directory / "manifest";
+  {
+    std::ofstream file (manifest.string ().c_str ());
+    file << "# parts\n"
+	 << "\n"
+	 << "  b.obj \r\n"
+	 << "sub/a.stl\n"
+	 << "/abs/c.ply\n";
+  }
+  inputs = readManifest (manifest.string ());
+  BOOST_REQUIRE_EQUAL (inputs.size (), 3);
+  BOOST_CHECK_EQUAL (inputs[0], (directory / "b.obj").string ());
+  BOOST_CHECK_EQUAL (inputs[1], (directory / "sub/a.stl").string ());
+  BOOST_CHECK_EQUAL (inputs[2], "/abs/c.ply");
+
+  BOOST_CHECK_THROW (readManifest ((directory / "missing").string ()),
+		     std::runtime_error);
+
+  fs::remove_all (directory);
+}
@@ -0,0 +1,206 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE multi-capsule
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/multi-capsule.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// Add the corners of a box to a polyhedron.
+  void addBox (polyhedron_t& polyhedron, const point_t& min,
+	       const point_t& max)
+  {
+    for (int i = 0; i < 8; ++i)
+      polyhedron.push_back (point_t (i & 1 ? max[0] : min[0],
+				     i & 2 ? max[1] : min[1],
+				     i & 4 ? max[2] : min[2]));
+  }
+
+  /// Check that every point is in at least one capsule.
+  bool covered (const polyhedron_t& polyhedron,
+		const std::vector<argument_t>& capsules)
+  {
+    BOOST_FOREACH (const point_t& p, polyhedron)
+      {
+	bool inside = false;
+	BOOST_FOREACH (const argument_t& capsule, capsules)
+	  {
+	    point_t endPoint1;
+	    point_t endPoint2;
+	    value_type radius;
+	    convertSolverParamToCapsule (endPoint1, endPoint2, radius, capsule);
+	    inside = inside || (distancePointToSegment (p, endPoint1, endPoint2)
+				<= radius + 1e-9);
+	  }
+	if (!inside)
+	  return false;
+      }
+    return true;
+  }
+}
+
+BOOST_AUTO_TEST_CASE (multi_capsule_straight)
+{
+  polyhedrons_t polyhedrons (1);
+  for (int i = 0; i <= 10; ++i)
+    addBox (polyhedrons[0], point_t (0.1 * i, -0.05, -0.05),
+	    point_t (0.1 * i, 0.05, 0.05));
+
+  MultiCapsuleOptions options;
+  options.optimize = false;
+
+  // Splitting a straight bar only adds caps.
+  std::vector<argument_t> capsules = fitCapsules (polyhedrons, options);
+  BOOST_CHECK_EQUAL (capsules.size (), 1u);
+  BOOST_CHECK (covered (polyhedrons[0], capsules));
+}
+
+BOOST_AUTO_TEST_CASE (multi_capsule_bent)
+{
+  // L-shaped link.
+  polyhedrons_t polyhedrons (1);
+  for (int i = 0; i <= 10; ++i)
+    {
+      addBox (polyhedrons[0], point_t (0.1 * i, -0.05, -0.05),
+	      point_t (0.1 * i, 0.05, 0.05));
+      addBox (polyhedrons[0], point_t (-0.05, 0.1 * i, -0.05),
+	      point_t (0.05, 0.1 * i, 0.05));
+    }
+
+  MultiCapsuleOptions options;
+  options.optimize = false;
+  options.jobs = 2;
+
+  std::vector<argument_t> capsules = fitCapsules (polyhedrons, options);
+  BOOST_CHECK_GE (capsules.size (), 2u);
+  BOOST_CHECK_LE (capsules.size (), options.maxCapsules);
+  BOOST_CHECK (covered (polyhedrons[0], capsules));
+
+  value_type totalVolume = 0.;
+  for (size_t i = 0; i < capsules.size (); ++i)
+    {
+      totalVolume += capsuleVolume (capsules[i]);
+      if (i > 0)
+	BOOST_CHECK_GE (capsuleVolume (capsules[i - 1]),
+			capsuleVolume (capsules[i]));
+    }
+
+  options.maxCapsules = 1;
+  std::vector<argument_t> single = fitCapsules (polyhedrons, options);
+  BOOST_REQUIRE_EQUAL (single.size (), 1u);
+  BOOST_CHECK_LT (totalVolume, options.volumeRatio * capsuleVolume (single[0]));
+}
+
+BOOST_AUTO_TEST_CASE (capsule_hierarchy)
+{
+  // U-shaped link.
+  polyhedrons_t polyhedrons (1);
+  for (int i = 0; i <= 10; ++i)
+    {
+      addBox (polyhedrons[0], point_t (0.1 * i, -0.05, -0.05),
+	      point_t (0.1 * i, 0.05, 0.05));
+      addBox (polyhedrons[0], point_t (-0.05, 0.1 * i, -0.05),
+	      point_t (0.05, 0.1 * i, 0.05));
+      addBox (polyhedrons[0], point_t (0.95, 0.1 * i, -0.05),
+	      point_t (1.05, 0.1 * i, 0.05));
+    }
+
+  MultiCapsuleOptions options;
+  options.optimize = false;
+
+  CapsuleHierarchy hierarchy (polyhedrons, 3, options);
+  BOOST_REQUIRE (!hierarchy.empty ());
+  BOOST_CHECK_LE (hierarchy.depth (), 3u);
+  BOOST_CHECK_GE (hierarchy.depth (), 1u);
+
+  // The root is the single capsule fit.
+  options.maxCapsules = 1;
+  std::vector<argument_t> single = fitCapsules (polyhedrons, options);
+  BOOST_CHECK_SMALL ((hierarchy.node (0).capsule - single[0]).norm (), 1e-12);
+  BOOST_CHECK_EQUAL (hierarchy.node (0).parent, -1);
+
+  // Every level covers the points, with a decreasing volume.
+  value_type previousVolume = capsuleVolume (single[0]);
+  for (size_t level = 1; level <= hierarchy.depth (); ++level)
+    {
+      std::vector<argument_t> capsules = hierarchy.level (level);
+      BOOST_CHECK (covered (polyhedrons[0], capsules));
+
+      value_type volume = 0.;
+      for (size_t i = 0; i < capsules.size (); ++i)
+	volume += capsuleVolume (capsules[i]);
+      BOOST_CHECK_LT (volume, previousVolume);
+      previousVolume = volume;
+    }
+
+  // Serialization round trip.
+  CapsuleHierarchy::hierarchies_t hierarchies;
+  hierarchies.push_back (std::make_pair ("link", hierarchy));
+  hierarchies.push_back (std::make_pair ("", CapsuleHierarchy ()));
+
+  std::stringstream ss (std::ios::in | std::ios::out | std::ios::binary);
+  writeCapsuleHierarchies (ss, hierarchies);
+
+  CapsuleHierarchy::hierarchies_t loaded;
+  readCapsuleHierarchies (ss, loaded);
+  BOOST_REQUIRE_EQUAL (loaded.size (), 2u);
+  BOOST_CHECK_EQUAL (loaded[0].first, "link");
+  BOOST_CHECK (loaded[1].second.empty ());
+  BOOST_REQUIRE_EQUAL (loaded[0].second.size (), hierarchy.size ());
+  for (size_t i = 0; i < hierarchy.size (); ++i)
+    {
+      const CapsuleHierarchyNode& node = loaded[0].second.node (i);
+      BOOST_CHECK_EQUAL (node.parent, hierarchy.node (i).parent);
+      BOOST_CHECK_EQUAL (node.depth, hierarchy.node (i).depth);
+      BOOST_CHECK (node.children == hierarchy.node (i).children);
+      BOOST_CHECK_EQUAL ((node.capsule - hierarchy.node (i).capsule).norm (),
+			 0.);
+    }
+
+  std::stringstream truncated (ss.str ().substr (0, ss.str ().size () - 4));
+  loaded.clear ();
+  BOOST_CHECK_THROW (readCapsuleHierarchies (truncated, loaded),
+		     std::runtime_error);
+
+  // The parent of the root must be -1.
+  CapsuleHierarchy root;
+  root.addNode (argument_t::Zero (7), -1);
+  hierarchies.assign (1, std::make_pair ("root", root));
+  std::stringstream rootStream (std::ios::in | std::ios::out
+				| std::ios::binary);
+  writeCapsuleHierarchies (rootStream, hierarchies);
+  std::string data = rootStream.str ();
+  size_t position = data.find (std::string (4, '\xff'));
+  BOOST_REQUIRE (position != std::string::npos);
+  data[position] = '\xfb';
+
+  std::stringstream invalidRoot (data);
+  loaded.clear ();
+  BOOST_CHECK_THROW (readCapsuleHierarchies (invalidRoot, loaded),
+		     std::runtime_error);
+}
@@ -0,0 +1,134 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE point-cloud
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/point-cloud.hh"
+#include "roboptim/capsule/mesh-reader.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  polyhedrons_t makeParts ()
+  {
+    polyhedrons_t polyhedrons (2);
+    for (int i = 0; i < 20; ++i)
+      polyhedrons[0].push_back (point_t (0.1 * i, 0.05 * (i % 3), 0.25));
+    for (int i = 0; i < 5; ++i)
+      polyhedrons[1].push_back (point_t (-0.5, 0.5 * i, 0.125 * i));
+    return polyhedrons;
+  }
+}
+
+BOOST_AUTO_TEST_CASE (point_cloud_file)
+{
+  polyhedrons_t polyhedrons = makeParts ();
+  std::string fileName = "point-cloud-test.rcpc";
+
+  {
+    std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary);
+    writePointCloud (file, polyhedrons);
+  }
+
+  {
+    PointCloudFile cloud (fileName);
+    BOOST_CHECK_EQUAL (cloud.scalarSize (), 8);
+    BOOST_CHECK_EQUAL (cloud.size (), 25);
+    BOOST_REQUIRE_EQUAL (cloud.nbParts (), 2);
+    BOOST_CHECK_EQUAL (cloud.partBegin (1), 20);
+    BOOST_CHECK_EQUAL (cloud.partSize (1), 5);
+
+    // Views give back the exact points.
+    PointsView<double> part = cloud.doublePoints (1);
+    for (size_t i = 0; i < part.size (); ++i)
+      BOOST_CHECK_EQUAL (part[i], polyhedrons[1][i]);
+
+    polyhedrons_t copy;
+    cloud.polyhedrons (copy);
+    BOOST_CHECK (copy == polyhedrons);
+
+    // Same capsule as with a point vector.
+    polyhedron_t points;
+    convertPolyhedronVectorToPolyhedron (points, polyhedrons);
+    Capsule expected = capsuleFromPoints (points);
+    Capsule capsule = capsuleFromPoints (cloud.doublePoints ());
+    BOOST_CHECK_SMALL ((capsule.P0 - expected.P0).norm (), 1e-12);
+    BOOST_CHECK_SMALL ((capsule.P1 - expected.P1).norm (), 1e-12);
+    BOOST_CHECK_SMALL (capsule.radius - expected.radius, 1e-12);
+  }
+
+  // Single precision.
+  {
+    std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary);
+    writePointCloud (file, polyhedrons, true);
+  }
+
+  {
+    PointCloudFile cloud (fileName);
+    BOOST_CHECK_EQUAL (cloud.scalarSize (), 4);
+    PointsView<float> points = cloud.floatPoints (0);
+    BOOST_REQUIRE_EQUAL (points.size (), 20);
+    BOOST_CHECK_SMALL ((points[7] - polyhedrons[0][7]).norm (), 1e-6);
+  }
+
+  // Truncated file.
+  {
+    std::ostringstream ss;
+    writePointCloud (ss, polyhedrons);
+    std::string data = ss.str ();
+    std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary);
+    file.write (data.data (), static_cast<std::streamsize> (data.size () - 8));
+  }
+  BOOST_CHECK_THROW (PointCloudFile cloud (fileName), std::runtime_error);
+
+  std::remove (fileName.c_str ());
+  BOOST_CHECK_THROW (PointCloudFile cloud (fileName), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (point_cloud_stream)
+{
+  polyhedrons_t polyhedrons = makeParts ();
+
+  std::stringstream ss (std::ios::in | std::ios::out | std::ios::binary);
+  writePointCloud (ss, polyhedrons);
+  std::string data = ss.str ();
+
+  polyhedrons_t copy;
+  readPointCloud (ss, copy);
+  BOOST_CHECK (copy == polyhedrons);
+
+  // Through the mesh reader, parts are merged.
+  std::istringstream is (data, std::ios::in | std::ios::binary);
+  polyhedron_t points;
+  readMeshPoints (is, meshFormatFromName ("part.rcpc"), points);
+  BOOST_CHECK_EQUAL (points.size (), 25);
+  BOOST_CHECK_EQUAL (points[24], polyhedrons[1][4]);
+
+  // Invalid magic number.
+  data[0] = 'X';
+  std::istringstream invalid (data, std::ios::in | std::ios::binary);
+  BOOST_CHECK_THROW (readPointCloud (invalid, copy), std::runtime_error);
+}
@@ -0,0 +1,194 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE result-writer
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/result-writer.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  FitResult makeResult ()
+  {
+    FitResult result;
+    result.name = "dir/a \"b\",c.stl";
+    result.initParam.resize (7);
+    result.initParam << 0., 0., 0., 1., 0., 0., 1.;
+    result.solutionParam.resize (7);
+    result.solutionParam << 0., 0., 0., 0., 0., 0., 0.5;
+    result.status = Fitter::SOLUTION_FOUND;
+
+    // The initial optimization failed.
+    Fitter::Attempt attempt;
+    attempt.step = Fitter::INITIAL_SOLVE;
+    attempt.status = Fitter::NO_SOLUTION;
+    result.attempts.push_back (attempt);
+    attempt.step = Fitter::PERTURBED_START;
+    attempt.status = Fitter::SOLUTION_FOUND;
+    result.attempts.push_back (attempt);
+    result.loadTime = 0.25;
+    result.solveTime = 1.5;
+    result.nbHullPoints = 8;
+    return result;
+  }
+
+  // Read little-endian values from a binary buffer.
+  boost::uint64_t readUnsigned (const std::string& s, size_t& pos, size_t n)
+  {
+    boost::uint64_t value = 0;
+    for (size_t i = 0; i < n; ++i)
+      value |= static_cast<boost::uint64_t>
+	(static_cast<unsigned char> (s[pos + i])) << (8 * i);
+    pos += n;
+    return value;
+  }
+
+  double readFloat64 (const std::string& s, size_t& pos)
+  {
+    boost::uint64_t bits = readUnsigned (s, pos, 8);
+    double value;
+    std::memcpy (&value, &bits, 8);
+    return value;
+  }
+}
+
+BOOST_AUTO_TEST_CASE (result_writer_format)
+{
+  ResultWriter::Format format = ResultWriter::TEXT;
+  BOOST_CHECK (parseResultFormat ("JSON", format));
+  BOOST_CHECK_EQUAL (format, ResultWriter::JSON);
+  BOOST_CHECK (parseResultFormat ("csv", format));
+  BOOST_CHECK_EQUAL (format, ResultWriter::CSV);
+  BOOST_CHECK (!parseResultFormat ("xml", format));
+  BOOST_CHECK_EQUAL (format, ResultWriter::CSV);
+
+  argument_t param (7);
+  param << 0., 0., 0., 0., 0., 2., 1.;
+  BOOST_CHECK_CLOSE (capsuleVolume (param), M_PI * (4. / 3. + 2.), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (result_writer_json)
+{
+  std::stringstream ss;
+  ResultWriter writer (ss, ResultWriter::JSON);
+
+  writer.write (makeResult ());
+
+  FitResult failed;
+  failed.name = "broken.stl";
+  failed.error = "no point to encapsulate";
+  writer.write (failed);
+
+  std::string line;
+  std::getline (ss, line);
+  BOOST_CHECK_EQUAL (line.substr (0, 40),
+		     "{\"name\":\"dir/a \\\"b\\\",c.stl\",\"status\":\"so");
+  BOOST_CHECK (line.find ("\"solution\":{\"p0\":[0,0,0],\"p1\":[0,0,0],"
+			  "\"radius\":0.5,") != std::string::npos);
+  BOOST_CHECK (line.find ("\"hull_points\":8,\"error\":null}")
+	       != std::string::npos);
+  BOOST_CHECK (line.find ("\"attempts\":[{\"step\":\"initial_solve\","
+			  "\"status\":\"no_solution\"},{\"step\":"
+			  "\"perturbed_start\",\"status\":\"solution_found\"}]")
+	       != std::string::npos);
+
+  std::getline (ss, line);
+  BOOST_CHECK_EQUAL (line,
+		     "{\"name\":\"broken.stl\",\"status\":\"not_solved\","
+		     "\"attempts\":[],\"initial\":null,\"solution\":null,\"load_time\":0,"
+		     "\"solve_time\":0,\"hull_points\":0,"
+		     "\"error\":\"no point to encapsulate\"}");
+  BOOST_CHECK (!std::getline (ss, line));
+}
+
+BOOST_AUTO_TEST_CASE (result_writer_csv)
+{
+  std::stringstream ss;
+  ResultWriter writer (ss, ResultWriter::CSV);
+  writer.write (makeResult ());
+
+  std::string header;
+  std::string line;
+  std::getline (ss, header);
+  std::getline (ss, line);
+
+  BOOST_CHECK_EQUAL (header.substr (0, 12), "name,status,");
+
+  // Same number of columns, the quoted name contains a comma.
+  BOOST_CHECK_EQUAL (line.substr (0, 16), "\"dir/a \"\"b\"\",c.s");
+  size_t headerColumns = 0;
+  for (size_t i = 0; i < header.size (); ++i)
+    headerColumns += (header[i] == ',');
+  size_t lineColumns = 0;
+  for (size_t i = 0; i < line.size (); ++i)
+    lineColumns += (line[i] == ',');
+  BOOST_CHECK_EQUAL (lineColumns, headerColumns + 1);
+  BOOST_CHECK_EQUAL (line.substr (line.size () - 69),
+		     ",0.25,1.5,8,,initial_solve:no_solution;"
+		     "perturbed_start:solution_found");
+}
+
+BOOST_AUTO_TEST_CASE (result_writer_binary)
+{
+  std::stringstream ss (std::ios::in | std::ios::out | std::ios::binary);
+  ResultWriter writer (ss, ResultWriter::BINARY);
+  FitResult result = makeResult ();
+  writer.write (result);
+
+  std::string data = ss.str ();
+  BOOST_REQUIRE_GE (data.size (), 12u);
+  BOOST_CHECK_EQUAL (data.substr (0, 8), "RCRESULT");
+
+  size_t pos = 8;
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4), 2u);
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4),
+		     static_cast<boost::uint64_t> (Fitter::SOLUTION_FOUND));
+  size_t nameLength = static_cast<size_t> (readUnsigned (data, pos, 4));
+  BOOST_CHECK_EQUAL (data.substr (pos, nameLength), result.name);
+  pos += nameLength;
+
+  for (int i = 0; i < 7; ++i)
+    BOOST_CHECK_EQUAL (readFloat64 (data, pos), result.initParam[i]);
+  for (int i = 0; i < 7; ++i)
+    BOOST_CHECK_EQUAL (readFloat64 (data, pos), result.solutionParam[i]);
+  BOOST_CHECK_CLOSE (readFloat64 (data, pos), capsuleVolume (result.initParam),
+		     1e-12);
+  BOOST_CHECK_CLOSE (readFloat64 (data, pos),
+		     capsuleVolume (result.solutionParam), 1e-12);
+  BOOST_CHECK_EQUAL (readFloat64 (data, pos), 0.25);
+  BOOST_CHECK_EQUAL (readFloat64 (data, pos), 1.5);
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 8), 8u);
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4), 0u);
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4), 2u);
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4),
+		     static_cast<boost::uint64_t> (Fitter::INITIAL_SOLVE));
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4),
+		     static_cast<boost::uint64_t> (Fitter::NO_SOLUTION));
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4),
+		     static_cast<boost::uint64_t> (Fitter::PERTURBED_START));
+  BOOST_CHECK_EQUAL (readUnsigned (data, pos, 4),
+		     static_cast<boost::uint64_t> (Fitter::SOLUTION_FOUND));
+  BOOST_CHECK_EQUAL (pos, data.size ());
+}
@@ -0,0 +1,121 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE squared-distance-capsule-points
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/output_test_stream.hpp>
+
+#include <roboptim/core/io.hh>
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+
+#include "roboptim/capsule/util.hh"
+#include "roboptim/capsule/squared-distance-capsule-points.hh"
+
+using boost::test_tools::output_test_stream;
+
+BOOST_AUTO_TEST_CASE (squared_distance_capsule_points)
+{
+  using namespace roboptim::capsule;
+
+  // Build cubic polyhedron.
+  polyhedron_t polyhedron;
+  value_type halfLength = 0.5;
+
+  polyhedron.push_back (point_t (-halfLength, -halfLength, -halfLength));
+  polyhedron.push_back (point_t (-halfLength, -halfLength, halfLength));
+  polyhedron.push_back (point_t (-halfLength, halfLength, -halfLength));
+  polyhedron.push_back (point_t (-halfLength, halfLength, halfLength));
+  polyhedron.push_back (point_t (halfLength, -halfLength, -halfLength));
+  polyhedron.push_back (point_t (halfLength, -halfLength, halfLength));
+  polyhedron.push_back (point_t (halfLength, halfLength, -halfLength));
+  polyhedron.push_back (point_t (halfLength, halfLength, halfLength));
+  polyhedron.push_back (point_t (0.05, 0.3, 0.1));
+
+  polyhedrons_t polyhedrons;
+  polyhedrons.push_back (polyhedron);
+
+  // Capsule parameters.
+  argument_t capsuleParam (7);
+  point_t endPoint1 (0.1, 0., 0.);
+  point_t endPoint2 (-0.1, 0., 0.);
+  value_type radius = sqrt (3) / 2;
+  convertCapsuleToSolverParam (capsuleParam, endPoint1, endPoint2, radius);
+
+  SquaredDistanceCapsulePoints distances (polyhedrons);
+  SparseSquaredDistanceCapsulePoints sparseDistances (polyhedrons);
+
+  size_type n = static_cast<size_type> (polyhedron.size ());
+  BOOST_CHECK_EQUAL (distances.inputSize (), 7 + n);
+  BOOST_CHECK_EQUAL (distances.outputSize (), n);
+
+  // With the projections as auxiliary variables, the constraints are
+  // the squared distances to the segment minus the squared radius.
+  argument_t argument (distances.inputSize ());
+  distances.startingPoint (argument, capsuleParam);
+  vector_t result = distances (argument);
+
+  for (size_type i = 0; i < n; ++i)
+    {
+      value_type d = distancePointToSegment (polyhedron[i],
+					     endPoint1, endPoint2);
+      BOOST_CHECK_CLOSE (result[i], d * d - radius * radius, 1e-6);
+      BOOST_CHECK_EQUAL (checkGradient (distances, static_cast<int> (i),
+					argument, 1e-6), true);
+    }
+
+  // Check gradients away from the projections as well.
+  argument.tail (n).setConstant (0.3);
+  for (size_type i = 0; i < n; ++i)
+    BOOST_CHECK_EQUAL (checkGradient (distances, static_cast<int> (i),
+				      argument, 1e-6), true);
+
+  // Each row depends on the capsule parameters and one projection
+  // parameter.
+  SparseSquaredDistanceCapsulePoints::jacobian_t
+    sparseJacobian (n, sparseDistances.inputSize ());
+  sparseDistances.jacobian (sparseJacobian, argument);
+  BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (), 8 * n);
+  BOOST_CHECK_SMALL ((matrix_t (sparseJacobian)
+		      - distances.jacobian (argument)).norm (), 1e-12);
+
+  // Compare the Hessians with finite differences of the gradients.
+  value_type step = 1e-6;
+  for (size_type i = 0; i < n; ++i)
+    {
+      SquaredDistanceCapsulePoints::hessian_t
+	hessian = distances.hessian (argument, i);
+
+      for (size_type j = 0; j < distances.inputSize (); ++j)
+	{
+	  argument_t x = argument;
+	  x[j] += step;
+	  vector_t gPlus = distances.gradient (x, i);
+	  x[j] -= 2. * step;
+	  vector_t gMinus = distances.gradient (x, i);
+
+	  vector_t fdColumn = (gPlus - gMinus) / (2. * step);
+	  BOOST_CHECK_SMALL ((hessian.col (j) - fdColumn).norm (), 1e-5);
+	}
+
+      SparseSquaredDistanceCapsulePoints::hessian_t
+	sparseHessian (distances.inputSize (), distances.inputSize ());
+      sparseDistances.hessian (sparseHessian, argument, i);
+      BOOST_CHECK_EQUAL (sparseHessian.nonZeros (), 64);
+      BOOST_CHECK_SMALL ((matrix_t (sparseHessian) - hessian).norm (), 1e-12);
+    }
+}
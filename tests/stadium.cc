@@ -0,0 +1,220 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE stadium
+
+#include <cmath>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <roboptim/core/decorator/finite-difference-gradient.hh>
+
+#include "roboptim/capsule/area.hh"
+#include "roboptim/capsule/distance-stadium-points.hh"
+#include "roboptim/capsule/stadium-fitter.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// Planar points of a rectangle with interior points.
+  polygon_t rectanglePoints ()
+  {
+    polygon_t points;
+    points.push_back (point2_t (-1., -0.2));
+    points.push_back (point2_t (1., -0.2));
+    points.push_back (point2_t (1., 0.2));
+    points.push_back (point2_t (-1., 0.2));
+    points.push_back (point2_t (0.3, 0.1));
+    points.push_back (point2_t (0.3, -0.1));
+    points.push_back (point2_t (-0.5, 0.));
+    points.push_back (point2_t (0., -0.2));
+    points.push_back (point2_t (0., 0.2));
+    return points;
+  }
+} // end of anonymous namespace.
+
+BOOST_AUTO_TEST_CASE (stadium_convex_hull)
+{
+  polygon_t hull = convexHullFromPoints (rectanglePoints ());
+
+  // Interior and collinear points are removed, the corners are given
+  // counter-clockwise from the lowest-leftmost one.
+  BOOST_REQUIRE_EQUAL (hull.size (), 4);
+  BOOST_CHECK (hull[0] == point2_t (-1., -0.2));
+  BOOST_CHECK (hull[1] == point2_t (1., -0.2));
+  BOOST_CHECK (hull[2] == point2_t (1., 0.2));
+  BOOST_CHECK (hull[3] == point2_t (-1., 0.2));
+
+  // Degenerate inputs give their distinct points.
+  polygon_t pair;
+  pair.push_back (point2_t (1., 2.));
+  pair.push_back (point2_t (1., 2.));
+  pair.push_back (point2_t (0., 0.));
+  BOOST_CHECK_EQUAL (convexHullFromPoints (pair).size (), 2);
+
+  polygons_t polygons (2);
+  polygons[0] = rectanglePoints ();
+  polygons[1].push_back (point2_t (2., 0.));
+  polygons_t convexPolygons;
+  computeConvexPolygon (polygons, convexPolygons);
+  BOOST_REQUIRE_EQUAL (convexPolygons.size (), 1);
+  BOOST_CHECK_EQUAL (convexPolygons[0].size (), 5);
+  BOOST_CHECK_EQUAL (countPoints (polygons), 10);
+}
+
+BOOST_AUTO_TEST_CASE (stadium_from_points)
+{
+  polygon_t points = rectanglePoints ();
+  Stadium stadium = stadiumFromPoints (points);
+
+  // The axis is the long side of the rectangle, and the corners lie on
+  // the caps.
+  value_type radius = 0.2;
+  value_type halfLength = 1. - std::sqrt (radius * radius - 0.2 * 0.2);
+  BOOST_CHECK_CLOSE (stadium.radius, radius, 1e-6);
+  BOOST_CHECK_CLOSE ((stadium.P1 - stadium.P0).norm (), 2. * halfLength,
+		     1e-6);
+
+  argument_t param (5);
+  convertStadiumToSolverParam (param, stadium.P0, stadium.P1, stadium.radius);
+  BOOST_CHECK_CLOSE (stadiumArea (param),
+		     4. * radius * halfLength + M_PI * radius * radius, 1e-6);
+
+  BOOST_FOREACH (const point2_t& p, points)
+    BOOST_CHECK_LE (distancePointToSegment (p, stadium.P0, stadium.P1),
+		    stadium.radius * (1. + 1e-12));
+
+  // Shrinking the radius is undone by the containment check.
+  polygons_t polygons (1, points);
+  param[4] = 0.1;
+  BOOST_CHECK_CLOSE (inflateToContain (param, polygons), 0.1, 1e-6);
+
+  point2_t endPoint1, endPoint2;
+  value_type r;
+  convertSolverParamToStadium (endPoint1, endPoint2, r, param);
+  BOOST_CHECK (endPoint1 == stadium.P0);
+  BOOST_CHECK (endPoint2 == stadium.P1);
+  BOOST_CHECK_GE (r, radius);
+}
+
+BOOST_AUTO_TEST_CASE (stadium_area)
+{
+  argument_t param (5);
+  param << 0.3, -0.1, -0.2, 0.4, 0.25;
+
+  Area area;
+  SparseArea sparseArea;
+
+  value_type length = std::sqrt (0.5 * 0.5 + 0.5 * 0.5);
+  BOOST_CHECK_CLOSE (area (param)[0],
+		     0.25 * (2. * length + M_PI * 0.25), 1e-6);
+  BOOST_CHECK_CLOSE (sparseArea (param)[0], area (param)[0], 1e-6);
+  BOOST_CHECK_CLOSE (area (param)[0], stadiumArea (param), 1e-6);
+
+  BOOST_CHECK_EQUAL (checkGradient (area, 0, param, 1e-6), true);
+
+  // The Hessian matches finite differences of the gradient.
+  Area::hessian_t hessian = area.hessian (param);
+  value_type epsilon = 1e-6;
+  for (size_type j = 0; j < 5; ++j)
+    {
+      argument_t shifted = param;
+      shifted[j] += epsilon;
+      vector_t column = (area.gradient (shifted) - area.gradient (param))
+	/ epsilon;
+      BOOST_CHECK_SMALL ((hessian.col (j) - column).norm (), 1e-4);
+    }
+
+  SparseArea::hessian_t sparseHessian (5, 5);
+  sparseArea.hessian (sparseHessian, param);
+  BOOST_CHECK_EQUAL (sparseHessian.nonZeros (), 25);
+  BOOST_CHECK_SMALL ((matrix_t (sparseHessian) - hessian).norm (), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (stadium_distances)
+{
+  polygons_t polygons (1, rectanglePoints ());
+  const polygon_t& points = polygons[0];
+
+  argument_t param (5);
+  param << -0.6, 0.05, 0.7, -0.05, 0.3;
+
+  DistanceStadiumPoints distances (polygons);
+  SparseDistanceStadiumPoints sparseDistances (polygons);
+  BOOST_CHECK_EQUAL (distances.inputSize (), 5);
+  BOOST_CHECK_EQUAL (distances.outputSize (),
+		     static_cast<size_type> (points.size ()));
+
+  vector_t result = distances (param);
+  vector_t sparseResult = sparseDistances (param);
+  for (size_t i = 0; i < points.size (); ++i)
+    {
+      size_type id = static_cast<size_type> (i);
+      BOOST_CHECK_CLOSE (result[id] + param[4],
+			 distancePointToSegment (points[i],
+						 param.segment<2> (0),
+						 param.segment<2> (2)),
+			 1e-6);
+      BOOST_CHECK_CLOSE (sparseResult[id], result[id], 1e-6);
+      BOOST_CHECK_EQUAL (checkGradient (distances, static_cast<int> (id),
+					param, 1e-6), true);
+    }
+
+  // The sparse Jacobian has a constant structure: 5 non-zeros per row.
+  DistanceStadiumPoints::jacobian_t jacobian = distances.jacobian (param);
+  SparseDistanceStadiumPoints::jacobian_t
+    sparseJacobian (sparseDistances.outputSize (), 5);
+  sparseDistances.jacobian (sparseJacobian, param);
+  BOOST_CHECK_EQUAL (sparseJacobian.nonZeros (),
+		     5 * sparseDistances.outputSize ());
+  BOOST_CHECK_SMALL ((matrix_t (sparseJacobian) - jacobian).norm (), 1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (stadium_fitter)
+{
+  // Rectangular footprint: the best fitting stadium has the short side
+  // of the rectangle as diameter.
+  polygon_t polygon;
+  polygon.push_back (point2_t (-0.5, -0.2));
+  polygon.push_back (point2_t (0.5, -0.2));
+  polygon.push_back (point2_t (0.5, 0.2));
+  polygon.push_back (point2_t (-0.5, 0.2));
+
+  polygons_t polygons;
+  polygons.push_back (polygon);
+
+  polygons_t convexPolygons;
+  computeConvexPolygon (polygons, convexPolygons);
+  Stadium stadium = stadiumFromPoints (convexPolygons[0]);
+
+  argument_t initParam (5);
+  convertStadiumToSolverParam (initParam, stadium.P0, stadium.P1,
+			       stadium.radius);
+
+  StadiumFitter fitter (convexPolygons);
+  fitter.computeBestFitStadium (initParam);
+
+  BOOST_CHECK_LE (fitter.solutionArea (), fitter.initArea () + 1e-6);
+  BOOST_FOREACH (const point2_t& p, polygon)
+    BOOST_CHECK_LE (distancePointToSegment (p,
+					    fitter.solutionParam ().segment<2> (0),
+					    fitter.solutionParam ().segment<2> (2)),
+		    fitter.solutionParam ()[4]);
+}
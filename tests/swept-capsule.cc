@@ -0,0 +1,121 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE swept-capsule
+
+#include <cmath>
+
+#include <boost/foreach.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/swept-capsule.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  /// Corners of a box centered at the origin.
+  polyhedron_t box (value_type halfLength)
+  {
+    polyhedron_t polyhedron;
+    for (int i = 0; i < 8; ++i)
+      polyhedron.push_back (point_t (i & 1 ? halfLength : -halfLength,
+				     i & 2 ? halfLength : -halfLength,
+				     i & 4 ? halfLength : -halfLength));
+    return polyhedron;
+  }
+
+  /// Pose rotated around the z axis.
+  Eigen::Isometry3d pose (const vector3_t& translation, value_type angle)
+  {
+    Eigen::Isometry3d p = Eigen::Isometry3d::Identity ();
+    p.linear () = Eigen::AngleAxisd (angle, vector3_t::UnitZ ())
+      .toRotationMatrix ();
+    p.translation () = translation;
+    return p;
+  }
+}
+
+BOOST_AUTO_TEST_CASE (swept_capsule_sampling)
+{
+  polyhedron_t points = box (0.1);
+  poses_t poses;
+  poses.push_back (pose (vector3_t::Zero (), 0.));
+  poses.push_back (pose (vector3_t (1., 0., 0.), 0.));
+
+  SweptCapsuleOptions options;
+  options.maxStep = 0.1;
+
+  // A 1 m translation with 0.1 m steps gives 10 intervals.
+  polyhedron_t sweptPoints;
+  value_type error = sampleSweptPoints (points, poses, options, sweptPoints);
+  BOOST_CHECK_EQUAL (sweptPoints.size (), 11 * points.size ());
+  BOOST_CHECK_CLOSE (error, 0.05, 1e-9);
+  BOOST_CHECK_SMALL ((sweptPoints.back () - (points.back ()
+					     + vector3_t (1., 0., 0.))).norm (),
+		     1e-12);
+
+  // The number of samples is bounded.
+  options.maxSamplesPerInterval = 4;
+  error = sampleSweptPoints (points, poses, options, sweptPoints);
+  BOOST_CHECK_EQUAL (sweptPoints.size (), 5 * points.size ());
+  BOOST_CHECK_CLOSE (error, 0.125, 1e-9);
+
+  // Parallel transforms give the same points.
+  polyhedron_t parallelPoints;
+  options.jobs = 3;
+  sampleSweptPoints (points, poses, options, parallelPoints);
+  BOOST_CHECK_EQUAL (parallelPoints.size (), sweptPoints.size ());
+  for (size_t i = 0; i < sweptPoints.size (); ++i)
+    BOOST_CHECK_EQUAL ((parallelPoints[i] - sweptPoints[i]).norm (), 0.);
+
+  // A single pose is not interpolated.
+  poses.pop_back ();
+  error = sampleSweptPoints (points, poses, options, sweptPoints);
+  BOOST_CHECK_EQUAL (sweptPoints.size (), points.size ());
+  BOOST_CHECK_EQUAL (error, 0.);
+}
+
+BOOST_AUTO_TEST_CASE (swept_capsule_containment)
+{
+  polyhedrons_t polyhedrons (1, box (0.1));
+  poses_t poses;
+  poses.push_back (pose (vector3_t::Zero (), 0.));
+  poses.push_back (pose (vector3_t (0.5, 0.2, 0.), 0.5 * M_PI));
+  poses.push_back (pose (vector3_t (1., 0., 0.1), M_PI));
+
+  SweptCapsuleOptions options;
+  options.optimize = false;
+  options.maxStep = 0.05;
+
+  point_t endPoint1;
+  point_t endPoint2;
+  value_type radius;
+  argument_t capsule = fitSweptCapsule (polyhedrons, poses, options);
+  convertSolverParamToCapsule (endPoint1, endPoint2, radius, capsule);
+
+  // Densely sampled motion stays in the capsule.
+  SweptCapsuleOptions dense;
+  dense.maxStep = 1e-3;
+  dense.maxSamplesPerInterval = 10000;
+  polyhedron_t sweptPoints;
+  sampleSweptPoints (polyhedrons[0], poses, dense, sweptPoints);
+  BOOST_FOREACH (const point_t& p, sweptPoints)
+    BOOST_CHECK_LE (distancePointToSegment (p, endPoint1, endPoint2),
+		    radius + 1e-9);
+}
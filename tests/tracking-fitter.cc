@@ -0,0 +1,92 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE tracking-fitter
+
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/tracking-fitter.hh"
+
+using namespace roboptim::capsule;
+
+BOOST_AUTO_TEST_CASE (tracking_fitter_subsampling)
+{
+  // 10x10x10 grid with a 0.01 step, each point twice.
+  polyhedron_t points;
+  for (int k = 0; k < 2; ++k)
+    for (int i = 0; i < 1000; ++i)
+      points.push_back (point_t (0.005 + 0.01 * (i % 10),
+				 0.005 + 0.01 * ((i / 10) % 10),
+				 0.005 + 0.01 * (i / 100)));
+
+  // One point per cell, the first one.
+  polyhedron_t subsampled;
+  value_type cellSize = subsamplePoints (subsampled, points, 0.01, 0);
+  BOOST_CHECK_EQUAL (cellSize, 0.01);
+  BOOST_CHECK_EQUAL (subsampled.size (), 1000u);
+  BOOST_CHECK_EQUAL (subsampled.front (), points.front ());
+
+  // Cells are doubled until the points fit.
+  cellSize = subsamplePoints (subsampled, points, 0.01, 200);
+  BOOST_CHECK_EQUAL (cellSize, 0.02);
+  BOOST_CHECK_EQUAL (subsampled.size (), 125u);
+
+  cellSize = subsamplePoints (subsampled, points, 0.01, 1);
+  BOOST_CHECK_EQUAL (subsampled.size (), 1u);
+  BOOST_CHECK_EQUAL (cellSize, 0.16);
+}
+
+BOOST_AUTO_TEST_CASE (tracking_fitter_subsampling_origin)
+{
+  // Points straddling the origin share a cell.
+  polyhedron_t points;
+  points.push_back (point_t (-0.001, -0.001, -0.001));
+  points.push_back (point_t (0.001, 0.001, 0.001));
+
+  polyhedron_t subsampled;
+  value_type cellSize = subsamplePoints (subsampled, points, 0.01, 0);
+  BOOST_CHECK_EQUAL (subsampled.size (), 1u);
+  BOOST_CHECK_EQUAL (cellSize, 0.01);
+
+  // Doubling stops once a cell covers the bounding box, even if
+  // maxPoints cannot be reached.
+  points.clear ();
+  for (int i = 0; i < 8; ++i)
+    points.push_back (point_t (i & 1 ? 1. : -1.,
+			       i & 2 ? 1. : -1.,
+			       i & 4 ? 1. : -1.));
+  cellSize = subsamplePoints (subsampled, points, 0.01, 4);
+  BOOST_CHECK_EQUAL (subsampled.size (), 1u);
+  BOOST_CHECK (cellSize > 2. && cellSize <= 4.);
+
+  subsamplePoints (subsampled, polyhedron_t (), 0.01, 4);
+  BOOST_CHECK (subsampled.empty ());
+}
+
+BOOST_AUTO_TEST_CASE (tracking_fitter_options)
+{
+  TrackingFitter fitter;
+
+  // The latency of a frame is bounded.
+  BOOST_CHECK_EQUAL (fitter.fitter ().maxIterations (), 50u);
+  BOOST_CHECK_EQUAL (fitter.fitter ().fallbacks ().size (), 1u);
+  BOOST_CHECK_EQUAL (fitter.fitter ().fallbacks ()[0], Fitter::HEURISTIC);
+  BOOST_CHECK (!fitter.fitter ().verbose ());
+
+  BOOST_CHECK_EQUAL (fitter.frameCount (), 0u);
+  BOOST_CHECK_EQUAL (fitter.capsule ().size (), 0);
+}
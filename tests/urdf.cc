@@ -0,0 +1,178 @@
+// Copyright (C) 2016 by the roboptim-capsule contributors, see AUTHORS.
+//
+// This file is part of the roboptim-capsule.
+//
+// roboptim-capsule is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// roboptim-capsule is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with roboptim-capsule.  If not, see <http://www.gnu.org/licenses/>.
+
+#define BOOST_TEST_MODULE urdf
+
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/foreach.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "roboptim/capsule/urdf.hh"
+#include "roboptim/capsule/util.hh"
+
+using namespace roboptim::capsule;
+
+namespace
+{
+  const char* robot =
+    "<?xml version=\"1.0\"?>\n"
+    "<robot name=\"test\">\n"
+    "  <link name=\"base\">\n"
+    "    <collision>\n"
+    "      <origin xyz=\"1 0 0\" rpy=\"0 0 1.5707963267948966\"/>\n"
+    "      <geometry><box size=\"2 0.5 0.5\"/></geometry>\n"
+    "    </collision>\n"
+    "  </link>\n"
+    "  <link name=\"arm\">\n"
+    "    <visual>\n"
+    "      <geometry><cylinder radius=\"0.1\" length=\"1\"/></geometry>\n"
+    "    </visual>\n"
+    "  </link>\n"
+    "  <link name=\"ball\">\n"
+    "    <collision>\n"
+    "      <geometry><sphere radius=\"0.1\"/></geometry>\n"
+    "    </collision>\n"
+    "  </link>\n"
+    "  <link name=\"world\"/>\n"
+    "  <joint name=\"j\" type=\"fixed\">\n"
+    "    <parent link=\"base\"/><child link=\"arm\"/>\n"
+    "  </joint>\n"
+    "</robot>\n";
+}
+
+BOOST_AUTO_TEST_CASE (urdf_path)
+{
+  packages_t packages;
+  packages["robot"] = "/opt/robot";
+
+  BOOST_CHECK_EQUAL (resolveUrdfPath ("package://robot/meshes/a.stl",
+				      "/tmp", packages),
+		     "/opt/robot/meshes/a.stl");
+  BOOST_CHECK_EQUAL (resolveUrdfPath ("file:///meshes/a.stl", "/tmp",
+				      packages),
+		     "/meshes/a.stl");
+  BOOST_CHECK_EQUAL (resolveUrdfPath ("meshes/a.stl", "/tmp", packages),
+		     "/tmp/meshes/a.stl");
+  BOOST_CHECK_THROW (resolveUrdfPath ("package://unknown_robot_package/a.stl",
+				      "/tmp", packages),
+		     std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE (urdf_links)
+{
+  std::istringstream ss (robot);
+  UrdfModel model (ss, "");
+
+  BOOST_CHECK_EQUAL (model.name (), "test");
+
+  // The sphere is not supported, and the world has no geometry.
+  BOOST_REQUIRE_EQUAL (model.links ().size (), 2u);
+  BOOST_CHECK_EQUAL (model.links ()[0].name, "base");
+  BOOST_CHECK_EQUAL (model.links ()[1].name, "arm");
+
+  // Box corners, in the link frame.
+  polyhedron_t points;
+  readLinkPoints (model.links ()[0], points);
+  BOOST_REQUIRE_EQUAL (points.size (), 8u);
+  BOOST_FOREACH (const point_t& p, points)
+    {
+      BOOST_CHECK_CLOSE (std::abs (p[0] - 1.), 0.25, 1e-8);
+      BOOST_CHECK_CLOSE (std::abs (p[1]), 1., 1e-8);
+      BOOST_CHECK_CLOSE (std::abs (p[2]), 0.25, 1e-8);
+    }
+
+  // The cylinder is inside the circumscribed prism.
+  points.clear ();
+  readLinkPoints (model.links ()[1], points);
+  BOOST_CHECK_EQUAL (points.size (), 32u);
+  BOOST_FOREACH (const point_t& p, points)
+    {
+      BOOST_CHECK_GE (p.head<2> ().norm (), 0.1);
+      BOOST_CHECK_CLOSE (std::abs (p[2]), 0.5, 1e-8);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (urdf_write)
+{
+  typedef boost::property_tree::ptree ptree;
+
+  std::istringstream ss (robot);
+  UrdfModel model (ss, "");
+
+  // Capsule along the y axis of the base.
+  argument_t capsule (7);
+  capsule << 1., -0.75, 0., 1., 0.75, 0., 0.4;
+  model.setCapsule (0, capsule);
+
+  std::stringstream output;
+  model.write (output, UrdfModel::CYLINDER_SPHERES);
+
+  ptree tree;
+  boost::property_tree::read_xml (output, tree);
+
+  size_t nbLinks = 0;
+  BOOST_FOREACH (const ptree::value_type& link, tree.get_child ("robot"))
+    {
+      if (link.first != "link")
+	continue;
+      ++nbLinks;
+
+      std::string name = link.second.get<std::string> ("<xmlattr>.name");
+      size_t nbCollisions = link.second.count ("collision");
+
+      if (name == "base")
+	{
+	  BOOST_CHECK_EQUAL (nbCollisions, 3u);
+	  const ptree& cylinder = link.second.get_child ("collision");
+	  BOOST_CHECK_CLOSE (cylinder.get<double>
+			     ("geometry.cylinder.<xmlattr>.length"), 1.5, 1e-8);
+	  BOOST_CHECK_CLOSE (cylinder.get<double>
+			     ("geometry.cylinder.<xmlattr>.radius"), 0.4, 1e-8);
+
+	  // The cylinder z axis is the capsule axis.
+	  std::istringstream rpy (cylinder.get<std::string>
+				  ("origin.<xmlattr>.rpy"));
+	  double roll, pitch, yaw;
+	  rpy >> roll >> pitch >> yaw;
+	  vector3_t z = (Eigen::AngleAxisd (yaw, vector3_t::UnitZ ())
+			 * Eigen::AngleAxisd (pitch, vector3_t::UnitY ())
+			 * Eigen::AngleAxisd (roll, vector3_t::UnitX ()))
+	    * vector3_t::UnitZ ();
+	  BOOST_CHECK_SMALL ((z - vector3_t::UnitY ()).norm (), 1e-8);
+	}
+      else if (name == "ball")
+	{
+	  // Links without capsule are unchanged.
+	  BOOST_CHECK_EQUAL (nbCollisions, 1u);
+	  BOOST_CHECK (link.second.get_child_optional
+		       ("collision.geometry.sphere"));
+	}
+      else
+	BOOST_CHECK_EQUAL (nbCollisions, 0u);
+    }
+  BOOST_CHECK_EQUAL (nbLinks, 4u);
+
+  // Capsule extension.
+  std::stringstream capsuleOutput;
+  model.write (capsuleOutput, UrdfModel::CAPSULE);
+  BOOST_CHECK (capsuleOutput.str ().find ("<capsule radius=\"0.4\" "
+					  "length=\"1.5\"/>")
+	       != std::string::npos);
+}
@@ -17,6 +17,7 @@
 
 #define BOOST_TEST_MODULE util
 
+#include <boost/foreach.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/output_test_stream.hpp>
 
@@ -70,3 +71,283 @@ BOOST_AUTO_TEST_CASE (util)
   BOOST_CHECK_SMALL_OR_CLOSE ((p2 - projectionOnSegment (p3, a, b)).norm (), 0., epsilon);
   BOOST_CHECK_SMALL_OR_CLOSE (((a + 0.25 * dir_x) - projectionOnSegment (p4, a, b)).norm (), 0., epsilon);
 }
+
+BOOST_AUTO_TEST_CASE (util_containment)
+{
+  using namespace roboptim::capsule;
+
+  polyhedrons_t polyhedrons (2);
+  polyhedrons[0].push_back (point_t (-1., 0., 0.));
+  polyhedrons[0].push_back (point_t (0.5, 0.3, 0.));
+  polyhedrons[1].push_back (point_t (2., 0., 0.4));
+  polyhedrons[1].push_back (point_t (0., 0., -0.1));
+
+  point_t a (0., 0., 0.);
+  point_t b (1., 0., 0.);
+  BOOST_CHECK_CLOSE (maxDistanceToSegment (polyhedrons, a, b),
+		     std::sqrt (1.16), 1e-12);
+
+  // Zero-length segment.
+  BOOST_CHECK_CLOSE (maxDistanceToSegment (polyhedrons, a, a),
+		     std::sqrt (4.16), 1e-12);
+
+  // The radius is only increased if a point is outside.
+  argument_t param (7);
+  convertCapsuleToSolverParam (param, a, b, 1.5);
+  BOOST_CHECK_EQUAL (inflateToContain (param, polyhedrons), 0.);
+  BOOST_CHECK_EQUAL (param[6], 1.5);
+
+  param[6] = 1.;
+  value_type inflation = inflateToContain (param, polyhedrons);
+  BOOST_CHECK_CLOSE (inflation, std::sqrt (1.16) - 1., 1e-9);
+  BOOST_CHECK_GE (param[6], std::sqrt (1.16));
+
+  BOOST_FOREACH (const polyhedron_t& polyhedron, polyhedrons)
+    BOOST_FOREACH (const point_t& p, polyhedron)
+      BOOST_CHECK_LE (distancePointToSegment (p, a, b), param[6]);
+}
+
+BOOST_AUTO_TEST_CASE (util_capsule_along_axis)
+{
+  using namespace roboptim::capsule;
+
+  polyhedrons_t polyhedrons (1);
+  polyhedrons[0].push_back (point_t (-1., 0.5, 0.));
+  polyhedrons[0].push_back (point_t (2., 0., 0.));
+  polyhedrons[0].push_back (point_t (0.5, -0.5, 0.));
+  polyhedrons[0].push_back (point_t (0., 0., 0.3));
+
+  argument_t param (7);
+  fitCapsuleAlongAxis (param, polyhedrons, point_t (0., 0., 0.),
+		       vector3_t (2., 0., 0.));
+
+  // Radius from the farthest point, end points as close as possible.
+  BOOST_CHECK_CLOSE (param[6], 0.5, 1e-12);
+  BOOST_CHECK_SMALL ((param.segment<3> (0) - point_t (-1., 0., 0.)).norm (),
+		     1e-12);
+  BOOST_CHECK_SMALL ((param.segment<3> (3) - point_t (1.5, 0., 0.)).norm (),
+		     1e-12);
+
+  point_t a = param.segment<3> (0);
+  point_t b = param.segment<3> (3);
+  BOOST_FOREACH (const point_t& p, polyhedrons[0])
+    BOOST_CHECK_LE (distancePointToSegment (p, a, b), param[6] + 1e-12);
+
+  // Points close to the line: a single sphere.
+  polyhedrons[0].clear ();
+  polyhedrons[0].push_back (point_t (-0.1, 0., 0.));
+  polyhedrons[0].push_back (point_t (0.1, 0., 0.));
+  polyhedrons[0].push_back (point_t (0., 1., 0.));
+  fitCapsuleAlongAxis (param, polyhedrons, point_t (0., 0., 0.),
+		       vector3_t (1., 0., 0.));
+  BOOST_CHECK_CLOSE (param[6], 1., 1e-12);
+  BOOST_CHECK_SMALL ((param.segment<3> (0) - param.segment<3> (3)).norm (),
+		     1e-12);
+}
+
+BOOST_AUTO_TEST_CASE (util_point_id)
+{
+  using namespace roboptim::capsule;
+
+  polyhedrons_t polyhedrons (3);
+  polyhedrons[0].resize (2, point_t::Zero ());
+  polyhedrons[2].resize (3, point_t::Zero ());
+
+  // Empty polyhedrons are skipped.
+  PointId id = pointIdFromIndex (polyhedrons, 2);
+  BOOST_CHECK_EQUAL (id.polyhedron, 2u);
+  BOOST_CHECK_EQUAL (id.point, 0u);
+
+  for (size_t i = 0; i < countPoints (polyhedrons); ++i)
+    BOOST_CHECK_EQUAL (indexFromPointId (polyhedrons,
+					 pointIdFromIndex (polyhedrons, i)), i);
+
+  // Names are unique across polyhedrons.
+  id = pointIdFromIndex (polyhedrons, 4);
+  BOOST_CHECK_EQUAL (constraintName (id), "distance to point 2 of polyhedron 2");
+
+  // Points are found by their coordinates, first occurrence first.
+  polyhedrons[0][1] = point_t (1., 2., 3.);
+  polyhedrons[2][1] = point_t (1., 2., 3.);
+  polyhedrons[2][2] = point_t (-1., 0., 0.);
+
+  polyhedron_t points;
+  points.push_back (point_t (-1., 0., 0.));
+  points.push_back (point_t (1., 2., 3.));
+  points.push_back (point_t (5., 0., 0.));
+
+  std::vector<PointId> ids;
+  matchPoints (ids, points, polyhedrons);
+  BOOST_CHECK_EQUAL (ids.size (), 3u);
+  BOOST_CHECK_EQUAL (ids[0].polyhedron, 2u);
+  BOOST_CHECK_EQUAL (ids[0].point, 2u);
+  BOOST_CHECK_EQUAL (ids[1].polyhedron, 0u);
+  BOOST_CHECK_EQUAL (ids[1].point, 1u);
+  BOOST_CHECK_EQUAL (ids[2].polyhedron, polyhedrons.size ());
+}
+
+BOOST_AUTO_TEST_CASE (util_parallel_reductions)
+{
+  using namespace roboptim::capsule;
+
+  // Elongated cloud with coordinates of various magnitudes, so that
+  // the summation order matters.
+  polyhedron_t points;
+  unsigned seed = 12345;
+  for (int i = 0; i < 10000; ++i)
+    {
+      point_t p;
+      for (int j = 0; j < 3; ++j)
+	{
+	  seed = seed * 1103515245u + 12345u;
+	  p[j] = static_cast<value_type> (seed % 100000) * 1e-5 - 0.5;
+	}
+      p[0] = 100. * p[0] + 1e3;
+      points.push_back (p);
+    }
+
+  Eigen::Matrix3d covariance = covarianceMatrix (points);
+  int imin = -1;
+  int imax = -1;
+  extremePointsAlongDirection (vector3_t (1., 0.2, 0.), points, imin, imax);
+  Capsule capsule = capsuleFromPoints (points);
+
+  // Results are bitwise identical for any number of threads.
+  for (size_t jobs = 2; jobs <= 8; jobs *= 2)
+    {
+      BOOST_CHECK (covarianceMatrix (points, jobs) == covariance);
+
+      int jmin = -1;
+      int jmax = -1;
+      extremePointsAlongDirection (vector3_t (1., 0.2, 0.), points,
+				   jmin, jmax, jobs);
+      BOOST_CHECK_EQUAL (jmin, imin);
+      BOOST_CHECK_EQUAL (jmax, imax);
+
+      Capsule parallelCapsule = capsuleFromPoints (points, jobs);
+      BOOST_CHECK (parallelCapsule.P0 == capsule.P0);
+      BOOST_CHECK (parallelCapsule.P1 == capsule.P1);
+      BOOST_CHECK_EQUAL (parallelCapsule.radius, capsule.radius);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (util_capsule_from_points_caps)
+{
+  using namespace roboptim::capsule;
+
+  // Box elongated along x, with points on the axis beyond the faces.
+  polyhedron_t points;
+  for (int i = 0; i < 8; ++i)
+    points.push_back (point_t (i & 1 ? 1. : -1., i & 2 ? 0.2 : -0.2,
+			       i & 4 ? 0.1 : -0.1));
+  points.push_back (point_t (1.3, 0., 0.));
+  points.push_back (point_t (-1.05, 0., 0.));
+
+  Capsule capsule = capsuleFromPoints (points);
+
+  // All the points are contained, and the caps touch a point.
+  value_type maxDistance = 0.;
+  BOOST_FOREACH (const point_t& p, points)
+    {
+      value_type d = distancePointToSegment (p, capsule.P0, capsule.P1);
+      BOOST_CHECK_LE (d, capsule.radius + 1e-12);
+      maxDistance = std::max (maxDistance, d);
+    }
+  BOOST_CHECK_CLOSE (maxDistance, capsule.radius, 1e-9);
+  BOOST_CHECK_CLOSE (capsule.radius, std::sqrt (0.05), 1e-9);
+  // The corners are on the cylinder and bound the first end point, the
+  // farthest point on the axis bounds the second one.
+  BOOST_CHECK_CLOSE ((capsule.P1 - capsule.P0).norm (),
+		     2.3 - std::sqrt (0.05), 1e-9);
+
+  // The caps do not depend on the order of the points.
+  polyhedron_t reversed (points.rbegin (), points.rend ());
+  Capsule reversedCapsule = capsuleFromPoints (reversed);
+  BOOST_CHECK_CLOSE (reversedCapsule.radius, capsule.radius, 1e-9);
+  BOOST_CHECK_CLOSE ((reversedCapsule.P1 - reversedCapsule.P0).norm (),
+		     (capsule.P1 - capsule.P0).norm (), 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE (util_float_geometry)
+{
+  using namespace roboptim::capsule;
+
+  point_t a (0.1, -0.2, 0.3);
+  point_t b (1.2, 0.4, -0.5);
+  polyhedron_t points;
+  points.push_back (point_t (0.5, 0.5, 0.5));
+  points.push_back (point_t (-1., 0.2, 0.));
+  points.push_back (point_t (2., 0.3, -1.));
+  points.push_back (point_t (0.6, 0.1, -0.1));
+
+  // Single-precision queries match the double ones.
+  pointf_t af = a.cast<float> ();
+  pointf_t bf = b.cast<float> ();
+  BOOST_FOREACH (const point_t& p, points)
+    {
+      pointf_t pf = p.cast<float> ();
+      BOOST_CHECK_CLOSE (distancePointToSegment (pf, af, bf),
+			 distancePointToSegment (p, a, b), 1e-4);
+      BOOST_CHECK_CLOSE (projectionParameterOnSegment (pf, af, bf),
+			 projectionParameterOnSegment (p, a, b), 1e-4);
+      BOOST_CHECK_SMALL ((projectionOnSegment (pf, af, bf).cast<double> ()
+			  - projectionOnSegment (p, a, b)).norm (), 1e-6);
+      BOOST_CHECK_CLOSE (distancePointToLine (pf, af, pointf_t (bf - af)),
+			 distancePointToLine (p, a, vector3_t (b - a)), 1e-4);
+    }
+
+  // Capsules are computed in double from float points.
+  polyhedronf_t pointsf;
+  BOOST_FOREACH (const point_t& p, points)
+    pointsf.push_back (p.cast<float> ());
+
+  Capsule capsule = capsuleFromPoints (points);
+  Capsulef capsulef = capsuleFromPoints (pointsf);
+  BOOST_CHECK_CLOSE (capsulef.radius, capsule.radius, 1e-4);
+  BOOST_CHECK_CLOSE (capsuleVolume (capsulef), capsuleVolume (capsule), 1e-3);
+
+  argument_t param (7);
+  convertCapsuleToSolverParam (param, capsule.P0, capsule.P1, capsule.radius);
+  BOOST_CHECK_CLOSE (capsuleVolume (capsule), capsuleVolume (param), 1e-9);
+
+  // Capsule queries: points are inside, up to rounding.
+  Capsulef inflated = capsulef;
+  inflated.radius *= 1.0001f;
+  BOOST_FOREACH (const pointf_t& p, pointsf)
+    {
+      BOOST_CHECK (capsuleContainsPoint (inflated, p));
+      BOOST_CHECK_LE (distancePointToCapsule (capsulef, p), 1e-5f);
+    }
+
+  pointf_t outside = capsulef.P1
+    + (capsulef.P1 - capsulef.P0).normalized () * (capsulef.radius + 0.1f);
+  BOOST_CHECK (!capsuleContainsPoint (capsulef, outside));
+  BOOST_CHECK_CLOSE (distancePointToCapsule (capsulef, outside), 0.1f, 1e-2);
+}
+
+BOOST_AUTO_TEST_CASE (util_inline_geometry)
+{
+  using namespace roboptim::capsule;
+
+  point_t a (0.1, -0.2, 0.3);
+  point_t b (1.2, 0.4, -0.5);
+  point_t p (0.7, 0.9, -0.2);
+
+  // The exported double overloads and the inline core are the same
+  // computation.
+  BOOST_CHECK_EQUAL (distancePointToSegment (p, a, b),
+		     distancePointToSegment<value_type> (p, a, b));
+  BOOST_CHECK_EQUAL (projectionParameterOnSegment (p, a, b),
+		     projectionParameterOnSegment<value_type> (p, a, b));
+  BOOST_CHECK (projectionOnSegment (p, a, b)
+	       == projectionOnSegment<value_type> (p, a, b));
+  BOOST_CHECK_EQUAL (distancePointToLine (p, a, vector3_t (b - a)),
+		     distancePointToLine<value_type> (p, a, b - a));
+
+  // Explicit template arguments accept Eigen expressions.
+  argument_t param (7);
+  convertCapsuleToSolverParam (param, a, b, 0.5);
+  BOOST_CHECK_EQUAL (distancePointToSegment<value_type>
+		     (p, param.segment<3> (0), param.segment<3> (3)),
+		     distancePointToSegment (p, a, b));
+}